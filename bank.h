@@ -0,0 +1,44 @@
+#ifndef BANK_H_
+#define BANK_H_
+
+/*
+ * Proj: 4
+ * File: bank.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the parameters of the bank of the assignment. It is the
+ * default scenario (see scenario.h) of both the threaded (wall-clock)
+ * simulation in qnx-banking.c and the discrete-event (virtual time)
+ * simulation in des.c, and the scenario every build with SCENARIO_FIXED is
+ * compiled for.
+ */
+
+#include "dist.h"
+
+/*
+ * The initializer of a struct scenario for the bank of the assignment.
+ */
+#define BANK_SCENARIO { \
+	/* The second at which the bank opens: 9:00 AM in seconds */ \
+	.sec_open = SIM_MIL_TO_SEC(9, 0), \
+	/* The second at which the bank closes: 4:00 PM in seconds */ \
+	.sec_close = SIM_MIL_TO_SEC(16, 0), \
+	/* The number of tellers in the system */ \
+	.n_tellers = 3, \
+	/* The bounds of the time between customer arrivals */ \
+	.arrive = DIST_UNIFORM_INIT(MIN_TO_SEC(1), MIN_TO_SEC(4)), \
+	/* The bounds of the time between teller breaks */ \
+	.tbreak = SIM_RANGE(MIN_TO_SEC(30), MIN_TO_SEC(60)), \
+	/* The bounds of the length of a teller break */ \
+	.lbreak = SIM_RANGE(MIN_TO_SEC(1), MIN_TO_SEC(4)), \
+	/* The bounds of the length of a transaction */ \
+	.transt = DIST_UNIFORM_INIT(30, MIN_TO_SEC(6)), \
+	/* A single branch, with a single line */ \
+	.n_branches = 1, \
+	.n_queues = 1, \
+	.transfer_sec = MIN_TO_SEC(10) \
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Proj: 4
+ * File: bench/bench_evlog.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Lock hold time benchmark for the SIM> log. N threads take turns on one
+ * mutex, and log an event while they hold it, as cust_gen does when it
+ * pushes onto the locked line. The event is logged by either:
+ *
+ *  - printf: sim_fmt_time() and fprintf(), on the spot
+ *  - evlog:  evlog_put() into the thread's ring, formatted by the drain
+ *  - quiet:  evlog_put() on a log opened with EVLOG_OFF
+ *
+ * Lines are written to /dev/null, so terminal speed doesn't count. Threads
+ * spin for a small gap between events (outside of the mutex), such that the
+ * drain keeps up with them as it does in the simulation; without the gap the
+ * rings fill up and loggers wait on the drain.
+ *
+ * Reported per run: the mean time the mutex is held per event, and events
+ * per second (including the drain's formatting, which runs concurrently).
+ *
+ * Usage: bench_evlog [events_per_thread [gap_ns]]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include "sim.h"
+#include "evlog.h"
+
+#define MODE_PRINTF 0
+#define MODE_EVLOG 1
+#define MODE_QUIET 2
+
+struct bench
+{
+	int mode;
+	long per_thread; /* Events each thread logs */
+	long gap_ns; /* Spin between events */
+	FILE *out; /* /dev/null */
+	struct evlog log;
+	pthread_mutex_t mutex;
+	volatile long held_ns; /* Total time the mutex was held */
+};
+
+struct bench_thread
+{
+	struct bench *b;
+	int id;
+};
+
+static long now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void spin(long ns)
+{
+	long until = now_ns() + ns;
+	while (now_ns() < until)
+		;
+}
+
+static void *logger(void *arg)
+{
+	struct bench_thread *t = arg;
+	struct bench *b = t->b;
+	char buf[40];
+	long held = 0;
+
+	long i;
+	for (i = 0; i < b->per_thread; i++) {
+		int sec = 32400 + (int) (i % 28800);
+		spin(b->gap_ns);
+
+		pthread_mutex_lock(&b->mutex);
+		long t0 = now_ns();
+		if (b->mode == MODE_PRINTF) {
+			sim_fmt_time(buf, sizeof(buf), sec);
+			fprintf(b->out, "%s customer %03d enters the teller "
+				"line.\n", buf, (int) i);
+		} else {
+			evlog_put(&b->log, t->id, EVL_CUST_LINE, sec, -1,
+					(int) i);
+		}
+		held += now_ns() - t0;
+		pthread_mutex_unlock(&b->mutex);
+	}
+
+	__atomic_add_fetch(&b->held_ns, held, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+static void run(int mode, int n_threads, long per_thread, long gap_ns)
+{
+	static const char *names[] = { "printf", "evlog", "quiet" };
+
+	struct bench b;
+	b.mode = mode;
+	b.per_thread = per_thread;
+	b.gap_ns = gap_ns;
+	b.out = fopen("/dev/null", "w");
+	b.held_ns = 0;
+	pthread_mutex_init(&b.mutex, NULL);
+	evlog_open(&b.log, n_threads, mode == MODE_EVLOG ? EVLOG_TEXT
+			: EVLOG_OFF, b.out);
+
+	struct bench_thread *ts = malloc(n_threads * sizeof(*ts));
+	pthread_t *thds = malloc(n_threads * sizeof(pthread_t));
+
+	long t0 = now_ns();
+	int i;
+	for (i = 0; i < n_threads; i++) {
+		ts[i].b = &b;
+		ts[i].id = i;
+		pthread_create(&thds[i], NULL, logger, &ts[i]);
+	}
+	for (i = 0; i < n_threads; i++) {
+		pthread_join(thds[i], NULL);
+	}
+	evlog_close(&b.log);
+	long t1 = now_ns();
+
+	double events = (double) n_threads * per_thread;
+	printf("%-7s %7d %10.0f %8.3f %12.1f %12.0f\n", names[mode],
+			n_threads, events, (t1 - t0) / 1e9, b.held_ns / events,
+			events / ((t1 - t0) / 1e9));
+
+	free(thds);
+	free(ts);
+	pthread_mutex_destroy(&b.mutex);
+	fclose(b.out);
+}
+
+int main(int argc, char *argv[])
+{
+	long per_thread = argc > 1 ? atol(argv[1]) : 100000;
+	long gap_ns = argc > 2 ? atol(argv[2]) : 2000;
+	static const int threads[] = { 4, 16 };
+
+	printf("%-7s %7s %10s %8s %12s %12s\n", "log", "threads", "events",
+			"seconds", "held ns/ev", "events/s");
+
+	unsigned int i;
+	for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+		run(MODE_PRINTF, threads[i], per_thread, gap_ns);
+		run(MODE_EVLOG, threads[i], per_thread, gap_ns);
+		run(MODE_QUIET, threads[i], per_thread, gap_ns);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+/*
+ * Proj: 4
+ * File: bench/bench_metrics.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Throughput benchmark for the telemetry path. N teller threads each ship
+ * a number of measurements to one stat_muncher (the calling thread) over a
+ * channel, through metric buffers with a batch length of either:
+ *
+ *  - 1:  one pulse per measurement (as the tellers used to send them)
+ *  - MET_BATCH_LEN: one pulse per batch of measurements
+ *
+ * Tellers record as fast as they can, which models a very high customer
+ * rate. On QNX every pulse is a kernel call (MsgSendPulse), so pulses per
+ * measurement is the kernel call count. On Linux a pulse only costs a
+ * system call when it has to wake the parked stat_muncher, which shows up
+ * as context switches.
+ *
+ * Reported per run: measurements per second, pulses per measurement and
+ * context switches per measurement.
+ *
+ * Usage: bench_metrics [measurements_per_teller]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "chan.h"
+#include "metbuf.h"
+
+struct bench_teller
+{
+	struct bench *b;
+	int id;
+	struct metbuf mb;
+};
+
+struct bench
+{
+	long per_teller; /* Measurements each teller ships */
+	struct chan chan;
+	struct bench_teller *tellers;
+};
+
+static long now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void *teller(void *arg)
+{
+	struct bench_teller *t = arg;
+	struct bench *b = t->b;
+	int coid = chan_attach(&b->chan);
+
+	long i;
+	for (i = 0; i < b->per_teller; i++) {
+		/* One simulated second per measurement */
+		metbuf_add(&t->mb, &b->chan, coid, t->id, 2, (int) i, (int) i);
+	}
+
+	metbuf_flush(&t->mb, &b->chan, coid, t->id);
+	chan_detach(&b->chan, coid);
+	return NULL;
+}
+
+static void run(int batch, int n_tellers, long per_teller)
+{
+	struct bench b;
+	b.per_teller = per_teller;
+	chan_create(&b.chan, n_tellers);
+	posix_memalign((void **) &b.tellers, METBUF_CACHE_LINE,
+			n_tellers * sizeof(struct bench_teller));
+
+	int i;
+	for (i = 0; i < n_tellers; i++) {
+		b.tellers[i].b = &b;
+		b.tellers[i].id = i;
+		metbuf_init(&b.tellers[i].mb, batch);
+	}
+
+	struct rusage ru0, ru1;
+	getrusage(RUSAGE_SELF, &ru0);
+	long t0 = now_ns();
+
+	pthread_t *thds = malloc(n_tellers * sizeof(pthread_t));
+	for (i = 0; i < n_tellers; i++) {
+		pthread_create(&thds[i], NULL, teller, &b.tellers[i]);
+	}
+
+	/* The stat_muncher loop */
+	long sum = 0, taken = 0;
+	int n_dcon = 0;
+	struct chan_pulse pul;
+	struct met_record rec;
+	while (n_dcon < n_tellers) {
+		chan_receive_pulse(&b.chan, &pul);
+		if (pul.code == CHAN_PULSE_DISCONNECT) {
+			n_dcon++;
+		} else if (pul.code == MET_BATCH) {
+			while (metbuf_take(&b.tellers[pul.value].mb, &rec)) {
+				sum += rec.value;
+				taken++;
+			}
+		}
+	}
+
+	for (i = 0; i < n_tellers; i++) {
+		pthread_join(thds[i], NULL);
+	}
+
+	long t1 = now_ns();
+	getrusage(RUSAGE_SELF, &ru1);
+
+	long pulses = 0;
+	for (i = 0; i < n_tellers; i++) {
+		pulses += b.tellers[i].mb.n_pulses;
+		metbuf_destroy(&b.tellers[i].mb);
+	}
+
+	double secs = (t1 - t0) / 1e9;
+	long csw = (ru1.ru_nvcsw - ru0.ru_nvcsw)
+			+ (ru1.ru_nivcsw - ru0.ru_nivcsw);
+
+	if (taken != n_tellers * per_teller || sum < 0) {
+		fprintf(stderr, "lost measurements: %ld of %ld\n", taken,
+				n_tellers * per_teller);
+	}
+
+	printf("%5d %7d %12ld %8.3f %12.0f %12.4f %12.4f\n", batch,
+			n_tellers, taken, secs, taken / secs,
+			(double) pulses / taken, (double) csw / taken);
+
+	free(thds);
+	free(b.tellers);
+	chan_destroy(&b.chan);
+}
+
+int main(int argc, char *argv[])
+{
+	long per_teller = argc > 1 ? atol(argv[1]) : 200000;
+	static const int tellers[] = { 3, 32 };
+
+	printf("%5s %7s %12s %8s %12s %12s %12s\n", "batch", "tellers",
+			"measurements", "seconds", "meas/s", "pulses/meas",
+			"csw/meas");
+
+	unsigned int i;
+	for (i = 0; i < sizeof(tellers) / sizeof(tellers[0]); i++) {
+		run(1, tellers[i], per_teller);
+		run(MET_BATCH_LEN, tellers[i], per_teller);
+	}
+
+	return EXIT_SUCCESS;
+}
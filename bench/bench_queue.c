@@ -0,0 +1,245 @@
+/*
+ * Proj: 4
+ * File: bench/bench_queue.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Contention benchmark for the line of customers. One generator thread hands
+ * customers to N teller threads through either:
+ *
+ *  - locked:   the customer_q line guarded by a mutex, with every push
+ *              broadcast on a condition variable (the classic teller path)
+ *  - lockfree: the customer_lfq line, with idle tellers parked on an
+ *              eventcount that is notified once per push
+ *
+ * Tellers serve instantly, so the benchmark measures the cost of the handoff
+ * alone. The generator spins for a small gap between arrivals such that
+ * tellers actually run out of work and park. Each round is one "day" of
+ * MAX_CUSTOMERS_PER_DAY customers, after which the line is plugged.
+ *
+ * Reported per run: handoffs per second, futile wakeups per customer (a
+ * teller woke up and found nothing to poll) and context switches per
+ * customer.
+ *
+ * Usage: bench_queue [days [gap_ns]]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "customer.h"
+#include "customer_lfq.h"
+#include "evcount.h"
+
+struct bench
+{
+	int lockfree; /* Which line is benchmarked */
+	int days; /* Number of rounds */
+	long gap_ns; /* Spin between arrivals */
+
+	struct customer_q line;
+	pthread_mutex_t queue_mutex;
+	pthread_cond_t queue_cond;
+
+	struct customer_lfq lfq;
+	struct evcount line_ec;
+
+	pthread_barrier_t start; /* Released when a day's line is ready */
+	pthread_barrier_t end; /* Released when every teller clocked out */
+
+	volatile long futile; /* Wakeups which found nothing to poll */
+	volatile long served; /* Customers polled */
+};
+
+static long now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void spin(long ns)
+{
+	long until = now_ns() + ns;
+	while (now_ns() < until)
+		;
+}
+
+/*
+ * A teller on the locked line: the teller loop from qnx-banking.c, minus
+ * the breaks and the transaction.
+ */
+static void locked_day(struct bench *b, long *futile, long *served)
+{
+	while (1) {
+		pthread_mutex_lock(&b->queue_mutex);
+		int poll_code;
+		while ((poll_code = customer_q_can_poll(&b->line))
+				== ENOCUS) {
+			pthread_cond_wait(&b->queue_cond, &b->queue_mutex);
+			if (customer_q_can_poll(&b->line) == ENOCUS) {
+				(*futile)++;
+			}
+		}
+		if (poll_code == EAVAIL) customer_q_poll(&b->line);
+		pthread_mutex_unlock(&b->queue_mutex);
+
+		if (poll_code == EEMPTY) break;
+		(*served)++;
+	}
+}
+
+/*
+ * A teller on the lock-free line: the teller_wait_lockfree() protocol.
+ */
+static void lockfree_day(struct bench *b, long *futile, long *served)
+{
+	int cid;
+	while (1) {
+		int poll_code = customer_lfq_poll(&b->lfq, &cid);
+		if (poll_code == ENOCUS) {
+			unsigned int key = evcount_prepare(&b->line_ec);
+			poll_code = customer_lfq_poll(&b->lfq, &cid);
+			if (poll_code != ENOCUS) {
+				evcount_cancel(&b->line_ec);
+			} else {
+				evcount_wait(&b->line_ec, key, NULL);
+				poll_code = customer_lfq_poll(&b->lfq, &cid);
+				if (poll_code == ENOCUS) (*futile)++;
+			}
+		}
+
+		if (poll_code == EEMPTY) break;
+		if (poll_code == EAVAIL) (*served)++;
+	}
+}
+
+static void *teller(void *arg)
+{
+	struct bench *b = arg;
+	long futile = 0, served = 0;
+
+	int day;
+	for (day = 0; day < b->days; day++) {
+		pthread_barrier_wait(&b->start);
+		if (b->lockfree) {
+			lockfree_day(b, &futile, &served);
+		} else {
+			locked_day(b, &futile, &served);
+		}
+		pthread_barrier_wait(&b->end);
+	}
+
+	__atomic_add_fetch(&b->futile, futile, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&b->served, served, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+/*
+ * The generator: runs on the calling thread.
+ */
+static void generate(struct bench *b)
+{
+	int day, i;
+	for (day = 0; day < b->days; day++) {
+		customer_q_init(&b->line);
+		customer_lfq_init(&b->lfq, MAX_CUSTOMERS_PER_DAY);
+		pthread_barrier_wait(&b->start);
+
+		for (i = 0; i < MAX_CUSTOMERS_PER_DAY; i++) {
+			spin(b->gap_ns);
+			if (b->lockfree) {
+				customer_lfq_push(&b->lfq, i);
+				evcount_notify_one(&b->line_ec);
+			} else {
+				pthread_mutex_lock(&b->queue_mutex);
+				customer_q_push(&b->line, i);
+				pthread_cond_broadcast(&b->queue_cond);
+				pthread_mutex_unlock(&b->queue_mutex);
+			}
+		}
+
+		if (b->lockfree) {
+			customer_lfq_plug(&b->lfq);
+			evcount_notify_all(&b->line_ec);
+		} else {
+			pthread_mutex_lock(&b->queue_mutex);
+			customer_q_plug(&b->line);
+			pthread_cond_broadcast(&b->queue_cond);
+			pthread_mutex_unlock(&b->queue_mutex);
+		}
+
+		pthread_barrier_wait(&b->end);
+		customer_q_destroy(&b->line);
+		customer_lfq_destroy(&b->lfq);
+	}
+}
+
+static void run(int lockfree, int n_tellers, int days, long gap_ns)
+{
+	struct bench *b = calloc(1, sizeof(struct bench));
+	b->lockfree = lockfree;
+	b->days = days;
+	b->gap_ns = gap_ns;
+	pthread_mutex_init(&b->queue_mutex, NULL);
+	pthread_cond_init(&b->queue_cond, NULL);
+	evcount_init(&b->line_ec);
+	pthread_barrier_init(&b->start, NULL, n_tellers + 1);
+	pthread_barrier_init(&b->end, NULL, n_tellers + 1);
+
+	struct rusage ru0, ru1;
+	getrusage(RUSAGE_SELF, &ru0);
+	long t0 = now_ns();
+
+	pthread_t *thds = malloc(n_tellers * sizeof(pthread_t));
+	int i;
+	for (i = 0; i < n_tellers; i++) {
+		pthread_create(&thds[i], NULL, teller, b);
+	}
+	generate(b);
+	for (i = 0; i < n_tellers; i++) {
+		pthread_join(thds[i], NULL);
+	}
+
+	long t1 = now_ns();
+	getrusage(RUSAGE_SELF, &ru1);
+
+	double secs = (t1 - t0) / 1e9;
+	double custs = (double) days * MAX_CUSTOMERS_PER_DAY;
+	long csw = (ru1.ru_nvcsw - ru0.ru_nvcsw)
+			+ (ru1.ru_nivcsw - ru0.ru_nivcsw);
+
+	printf("%-8s %7d %9.0f %8.3f %12.0f %12.3f %10.3f\n",
+			lockfree ? "lockfree" : "locked", n_tellers, custs,
+			secs, b->served / secs, b->futile / custs, csw / custs);
+
+	pthread_barrier_destroy(&b->start);
+	pthread_barrier_destroy(&b->end);
+	evcount_destroy(&b->line_ec);
+	pthread_cond_destroy(&b->queue_cond);
+	pthread_mutex_destroy(&b->queue_mutex);
+	free(thds);
+	free(b);
+}
+
+int main(int argc, char *argv[])
+{
+	int days = argc > 1 ? atoi(argv[1]) : 50;
+	long gap_ns = argc > 2 ? atol(argv[2]) : 2000;
+	static const int tellers[] = { 3, 32, 256 };
+
+	printf("%-8s %7s %9s %8s %12s %12s %10s\n", "path", "tellers",
+			"customers", "seconds", "handoffs/s", "futile/cust",
+			"csw/cust");
+
+	unsigned int i;
+	for (i = 0; i < sizeof(tellers) / sizeof(tellers[0]); i++) {
+		run(0, tellers[i], days, gap_ns);
+		run(1, tellers[i], days, gap_ns);
+	}
+
+	return EXIT_SUCCESS;
+}
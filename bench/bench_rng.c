@@ -0,0 +1,151 @@
+/*
+ * Proj: 4
+ * File: bench/bench_rng.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Speed and bias benchmark for the draws of the simulation. Draws from the
+ * transaction time range of the bank of the assignment (30 to 360 seconds)
+ * with either:
+ *
+ *  - rand_r:   rand_r(), scaled by (x * (hi - lo)) / RAND_MAX, as
+ *              sim_choose() used to draw
+ *  - draw:     sim_draw(), one draw at a time
+ *  - draw_n:   sim_draw_n(), an array of draws at a time
+ *  - exp, lognormal, empirical:
+ *              dist_fill(), an array of draws at a time from a table based
+ *              distribution of the same mean (lognormal: sd 80 s; empirical:
+ *              the 30, 195 and 360 second bins weighted 1:2:1)
+ *  - day:      scenario_draw_day(), all arrivals and transaction times of
+ *              a day of the bank, as every simulated day does
+ *
+ * Reported per run: nanoseconds per draw, and the mean of the draws. The
+ * mean of an unbiased draw is 195; the overflowing multiplication of the
+ * rand_r scaling drags it far off.
+ *
+ * Usage: bench_rng [draws]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "sim.h"
+#include "scenario.h"
+
+#define LO 30
+#define HI 360
+#define BATCH 1024 /* Draws per sim_draw_n() call */
+
+static long now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void report(const char *name, long draws, long t0, long t1,
+		double sum)
+{
+	printf("%-9s %12ld %10.2f %10.2f\n", name, draws,
+			(double) (t1 - t0) / draws, sum / draws);
+}
+
+static void bench_dist(const char *name, struct dist *d, long draws)
+{
+	if (dist_build(d) != NULL) return;
+
+	struct rng_bulk b;
+	rng_bulk_seed(&b, 1, 0);
+	int *out = malloc(BATCH * sizeof(int));
+	double sum = 0;
+	long i, t = 0;
+	for (i = 0; i < draws; i += BATCH) {
+		long t0 = now_ns();
+		dist_fill(d, &b, out, BATCH, 0);
+		t += now_ns() - t0;
+
+		int j;
+		for (j = 0; j < BATCH; j++) sum += out[j];
+	}
+	report(name, draws, 0, t, sum);
+	free(out);
+}
+
+int main(int argc, char *argv[])
+{
+	long draws = argc > 1 ? atol(argv[1]) : 50000000;
+	draws -= draws % BATCH;
+
+	printf("%-9s %12s %10s %10s\n", "draw", "draws", "ns/draw", "mean");
+
+	/* The old sim_choose() */
+	unsigned int seed = 1;
+	double sum = 0;
+	long i, t0 = now_ns();
+	for (i = 0; i < draws; i++) {
+		unsigned int x = (unsigned int) rand_r(&seed);
+		sum += ((x * (HI - LO)) / RAND_MAX) + LO;
+	}
+	report("rand_r", draws, t0, now_ns(), sum);
+
+	struct sim_range r;
+	sim_range_init(&r, LO, HI);
+
+	struct rng rng;
+	rng_seed(&rng, 1, 0);
+	sum = 0;
+	t0 = now_ns();
+	for (i = 0; i < draws; i++) {
+		sum += sim_draw(&rng, &r);
+	}
+	report("draw", draws, t0, now_ns(), sum);
+
+	struct rng_bulk b;
+	rng_bulk_seed(&b, 1, 0);
+	int *out = malloc(BATCH * sizeof(int));
+	sum = 0;
+	long t = 0;
+	for (i = 0; i < draws; i += BATCH) {
+		t0 = now_ns();
+		sim_draw_n(&b, &r, out, BATCH);
+		t += now_ns() - t0;
+
+		int j;
+		for (j = 0; j < BATCH; j++) sum += out[j];
+	}
+	report("draw_n", draws, 0, t, sum);
+	free(out);
+
+	static struct dist exp = { .kind = DIST_EXP, .mean = 195 };
+	static struct dist lognormal = { .kind = DIST_LOGNORMAL, .mean = 195,
+		.sd = 80 };
+	static struct dist empirical = { .kind = DIST_EMPIRICAL, .n_bins = 3,
+		.bin_value = { 30, 195, 360 }, .bin_weight = { 1, 2, 1 } };
+	bench_dist("exp", &exp, draws);
+	bench_dist("lognormal", &lognormal, draws);
+	bench_dist("empirical", &empirical, draws);
+
+	struct scenario sc;
+	scenario_init(&sc);
+	int n = scenario_max_customers(&sc);
+	int *arrive = malloc(n * sizeof(int));
+	int *transt = malloc(n * sizeof(int));
+	long days = draws / (2 * n);
+	sum = 0;
+	t = 0;
+	for (i = 0; i < days; i++) {
+		t0 = now_ns();
+		scenario_draw_day(&sc, (uint64_t) i, arrive, transt);
+		t += now_ns() - t0;
+
+		int j;
+		for (j = 0; j < n; j++) sum += transt[j];
+	}
+	/* Every draw counts for the time, the transaction times for the mean */
+	report("day", days * 2 * n, 0, t, sum * 2);
+	free(transt);
+	free(arrive);
+
+	return EXIT_SUCCESS;
+}
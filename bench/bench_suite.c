@@ -0,0 +1,292 @@
+/*
+ * Proj: 4
+ * File: bench/bench_suite.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * The regression suite: a set of micro and macro benchmarks, reported as
+ * one JSON document on stdout such that runs of different releases can be
+ * compared by a script. The micro benchmarks time the building blocks of
+ * the simulator:
+ *
+ *  - customer_q:     customer_q_push() and customer_q_poll() of a line
+ *                    kept 16 customers deep, one push and one poll per op
+ *  - sim_choose:     sim_choose() over the transaction time range
+ *  - sim_fmt_time:   sim_fmt_time() of successive seconds of a day
+ *  - customer_store: customer_store_make(), with the store reset once a
+ *                    day's worth of customers has been made
+ *  - store_reduce:   customer_spans_reduce() of the queue times of a store
+ *                    of N_STORE customers, per customer reduced
+ *  - stat_muncher:   the stat_muncher's reduction, a measurement folded
+ *                    into the accumulator its code names
+ *
+ * Each is run REPS times; the fastest and the median run are reported in
+ * nanoseconds per op. The macro benchmarks simulate whole days of the bank
+ * in virtual time (des_run_day(), on one thread) at 1, 3, 8 and 32 tellers,
+ * with arrivals scaled to keep each teller as busy as in the bank of the
+ * assignment, and report simulated days and served customers per second.
+ *
+ * Usage: bench_suite [scale]
+ *
+ * scale multiplies the number of ops of every benchmark (1 by default).
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "sim.h"
+#include "customer.h"
+#include "customer_store.h"
+#include "scenario.h"
+#include "metrics.h"
+#include "des.h"
+#include "metbuf.h"
+
+#define REPS 5 /* Runs of each benchmark */
+#define DEPTH 16 /* Customers in line during the customer_q benchmark */
+#define N_RECORDS 4096 /* Distinct measurements of the stat_muncher */
+#define N_STORE (1 << 22) /* Customers of the store_reduce benchmark */
+
+/* The measurement codes of qnx-banking.c */
+#define MET_CUST_Q_ELAPSED 2
+#define MET_CUST_T_ELAPSED 3
+#define MET_TELL_C_ELAPSED 4
+
+static volatile long sink; /* Keeps the compiler from dropping the work */
+
+static long now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int cmp_long(const void *a, const void *b)
+{
+	long x = *(const long *) a, y = *(const long *) b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * Prints the result of a micro benchmark from the times of its runs.
+ */
+static void report(const char *name, long ops, long *t, int first)
+{
+	qsort(t, REPS, sizeof(long), cmp_long);
+	printf("%s\n    {\"name\": \"%s\", \"kind\": \"micro\", \"ops\": %ld, "
+		"\"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f}",
+			first ? "" : ",", name, ops, (double) t[0] / ops,
+			(double) t[REPS / 2] / ops);
+}
+
+static long bench_customer_q(long ops)
+{
+	struct customer_q q;
+	customer_q_init(&q);
+
+	int i;
+	for (i = 0; i < DEPTH; i++) customer_q_push(&q, i);
+
+	long t0 = now_ns(), n;
+	for (n = 0; n < ops; n++) {
+		int cid = customer_q_poll(&q);
+		customer_q_push(&q, cid);
+	}
+	long t = now_ns() - t0;
+
+	sink += customer_q_max_depth(&q);
+	customer_q_destroy(&q);
+	return t;
+}
+
+static long bench_sim_choose(long ops)
+{
+	struct rng rng;
+	rng_seed(&rng, 1, 0);
+
+	long sum = 0, t0 = now_ns(), n;
+	for (n = 0; n < ops; n++) sum += sim_choose(&rng, 30, MIN_TO_SEC(6));
+	long t = now_ns() - t0;
+
+	sink += sum;
+	return t;
+}
+
+static long bench_sim_fmt_time(long ops)
+{
+	char buf[32];
+	long sum = 0, t0 = now_ns(), n;
+	for (n = 0; n < ops; n++) {
+		int sec = (int) (n % SIM_MIL_TO_SEC(24, 0));
+		sim_fmt_time(buf, sizeof(buf), sec);
+		sum += buf[6];
+	}
+	long t = now_ns() - t0;
+
+	sink += sum;
+	return t;
+}
+
+static long bench_customer_store(long ops)
+{
+	struct customer_store cs;
+	customer_store_init(&cs);
+
+	long t0 = now_ns(), n;
+	for (n = 0; n < ops; n++) {
+		int cid = (int) (n % MAX_CUSTOMERS_PER_DAY);
+		if (cid == 0) customer_store_reset(&cs);
+		sink += customer_store_make(&cs, cid);
+	}
+	long t = now_ns() - t0;
+
+	customer_store_destroy(&cs);
+	return t;
+}
+
+static long bench_store_reduce(long ops)
+{
+	/* A store far larger than the caches, one in ten customers unserved */
+	static struct customer_store cs;
+	if (cs.n_cust == 0) {
+		struct rng rng;
+		rng_seed(&rng, 1, 0);
+		customer_store_reserve(&cs, N_STORE);
+		int cid;
+		for (cid = 0; cid < N_STORE; cid++) {
+			customer_store_make(&cs, cid);
+			cs.enqueue_sec[cid] = sim_choose(&rng, 0,
+					SIM_MIL_TO_SEC(24, 0));
+			if (sim_choose(&rng, 0, 9) == 0) continue;
+			cs.dequeue_sec[cid] = cs.enqueue_sec[cid]
+					+ sim_choose(&rng, 0, MIN_TO_SEC(60));
+		}
+	}
+
+	long t0 = now_ns(), n;
+	for (n = 0; n < ops; n += N_STORE) {
+		struct customer_spans sp;
+		customer_spans_reduce(cs.dequeue_sec, cs.enqueue_sec,
+				cs.dequeue_sec, N_STORE, &sp);
+		sink += sp.sum + sp.max;
+	}
+	return now_ns() - t0;
+}
+
+static long bench_stat_muncher(long ops)
+{
+	/* The measurements of a day, as the tellers ship them */
+	static struct met_record recs[N_RECORDS];
+	static const int codes[] = { MET_CUST_Q_ELAPSED, MET_CUST_T_ELAPSED,
+		MET_TELL_C_ELAPSED };
+	struct rng rng;
+	rng_seed(&rng, 1, 0);
+	int i;
+	for (i = 0; i < N_RECORDS; i++) {
+		recs[i].code = codes[i % 3];
+		recs[i].value = sim_choose(&rng, 0, MIN_TO_SEC(60));
+	}
+
+	struct bank_stats st;
+	bank_stats_init(&st);
+
+	long t0 = now_ns(), n;
+	for (n = 0; n < ops; n++) {
+		const struct met_record *r = &recs[n & (N_RECORDS - 1)];
+		switch (r->code)
+		{
+		case MET_CUST_Q_ELAPSED:
+			stats_add(&st.q, r->value);
+			break;
+		case MET_CUST_T_ELAPSED:
+			stats_add(&st.t, r->value);
+			break;
+		case MET_TELL_C_ELAPSED:
+			stats_add(&st.c, r->value);
+			break;
+		}
+	}
+	long t = now_ns() - t0;
+
+	sink += st.q.n + st.t.n + st.c.n;
+	return t;
+}
+
+/*
+ * Simulates days of the bank with n_tellers tellers, and prints the rate.
+ */
+static void bench_days(int n_tellers, long days)
+{
+	/* The bank has 3 tellers and a customer every 1 to 4 minutes */
+	char spec[64];
+	int lo = MIN_TO_SEC(1) * 3 / n_tellers;
+	int hi = MIN_TO_SEC(4) * 3 / n_tellers;
+	snprintf(spec, sizeof(spec), "tellers=%d,arrive_lo=%d,arrive_hi=%d",
+			n_tellers, lo > 1 ? lo : 1, hi > 2 ? hi : 2);
+
+	struct scenario sc;
+	scenario_init(&sc);
+	if (scenario_load(&sc, spec) == -1) {
+		fprintf(stderr, "bench_suite: bad scenario %s\n", spec);
+		exit(EXIT_FAILURE);
+	}
+
+	struct customer_store store;
+	customer_store_init(&store);
+	struct bank_stats pool;
+	bank_stats_init(&pool);
+
+	long served = 0, t0 = now_ns(), i;
+	for (i = 0; i < days; i++) {
+		struct bank_metrics met;
+		des_run_day(&sc, (uint64_t) i, 0, &store, &met, &pool, NULL);
+		served += met.served;
+	}
+	double sec = (now_ns() - t0) / 1e9;
+
+	customer_store_destroy(&store);
+	printf(",\n    {\"name\": \"des_day\", \"kind\": \"macro\", "
+		"\"tellers\": %d, \"days\": %ld, \"customers\": %ld, "
+		"\"days_per_sec\": %.1f, \"customers_per_sec\": %.0f}",
+			n_tellers, days, served, days / sec, served / sec);
+}
+
+int main(int argc, char *argv[])
+{
+	long scale = argc > 1 ? atol(argv[1]) : 1;
+	if (scale < 1) scale = 1;
+
+	static const struct {
+		const char *name;
+		long (*run)(long ops);
+		long ops;
+	} micro[] = {
+		{ "customer_q", bench_customer_q, 20000000 },
+		{ "sim_choose", bench_sim_choose, 20000000 },
+		{ "sim_fmt_time", bench_sim_fmt_time, 5000000 },
+		{ "customer_store", bench_customer_store, 20000000 },
+		{ "store_reduce", bench_store_reduce, 20L * N_STORE },
+		{ "stat_muncher", bench_stat_muncher, 20000000 }
+	};
+	static const int tellers[] = { 1, 3, 8, 32 };
+
+	printf("{\n  \"suite\": \"qnx-banking\",\n  \"scale\": %ld,\n"
+		"  \"reps\": %d,\n  \"results\": [", scale, REPS);
+
+	int i, r;
+	for (i = 0; i < (int) (sizeof(micro) / sizeof(micro[0])); i++) {
+		long ops = micro[i].ops * scale;
+		long t[REPS];
+		micro[i].run(ops / 10); /* Warm up */
+		for (r = 0; r < REPS; r++) t[r] = micro[i].run(ops);
+		report(micro[i].name, ops, t, i == 0);
+	}
+
+	for (i = 0; i < (int) (sizeof(tellers) / sizeof(tellers[0])); i++) {
+		bench_days(tellers[i], 2000 * scale);
+	}
+
+	printf("\n  ]\n}\n");
+	return EXIT_SUCCESS;
+}
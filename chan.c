@@ -0,0 +1,275 @@
+/*
+ * Proj: 4
+ * File: chan.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in chan.h.
+ *
+ * On QNX every call maps onto the matching kernel call. Detaching sends the
+ * disconnect pulse itself, since _NTO_CHF_DISCONNECT only notifies once the
+ * last connection of a whole process is gone.
+ *
+ * Elsewhere, a connection's ring is only pushed by its sender and only
+ * polled by the receiver, so a release store of the tail (or head) publishes
+ * a pulse (or a free slot) without any read-modify-write. The receiver polls
+ * the rings round-robin, and parks on the eventcount once all are empty.
+ */
+
+#include <errno.h>
+#include "chan.h"
+
+#ifdef __QNXNTO__
+
+#include <sys/neutrino.h>
+
+/**
+ * Creates a channel without any connections.
+ *
+ * Params: ch      - the channel to create
+ *         n_conns - the most connections that will attach to the channel
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_create(struct chan *ch, int n_conns)
+{
+	(void) n_conns;
+	ch->chid = ChannelCreate(0);
+	return ch->chid == -1 ? -1 : 0;
+}
+
+/**
+ * Destroys a channel. Every connection must have detached.
+ *
+ * Params: ch - the channel to destroy
+ * Return: void
+ */
+void chan_destroy(struct chan *ch)
+{
+	ChannelDestroy(ch->chid);
+}
+
+/**
+ * Attaches a new connection to the channel, for the calling thread to send
+ * pulses over.
+ *
+ * Params: ch - the channel to attach to
+ * Return: the connection id, or -1 on failure (errno is set)
+ */
+int chan_attach(struct chan *ch)
+{
+	return ConnectAttach(0, (pid_t) 0, ch->chid, 0 | _NTO_SIDE_CHANNEL, 0);
+}
+
+/**
+ * Detaches a connection. The receiver gets a CHAN_PULSE_DISCONNECT pulse
+ * after every pulse sent over the connection.
+ *
+ * Params: ch   - the channel attached to
+ *         coid - the connection to detach
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_detach(struct chan *ch, int coid)
+{
+	(void) ch;
+	if (MsgSendPulse(coid, -1, CHAN_PULSE_DISCONNECT, coid) == -1) {
+		return -1;
+	}
+	return ConnectDetach(coid) == -1 ? -1 : 0;
+}
+
+/**
+ * Sends a pulse over a connection, without waiting for the receiver.
+ *
+ * Params: ch    - the channel attached to
+ *         coid  - the connection to send over
+ *         code  - the pulse code, below CHAN_PULSE_DISCONNECT
+ *         value - the pulse's value
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_send_pulse(struct chan *ch, int coid, int code, int value)
+{
+	(void) ch;
+	return MsgSendPulse(coid, -1, code, value) == -1 ? -1 : 0;
+}
+
+/**
+ * Waits until a pulse arrives on the channel, and receives it.
+ *
+ * Params: ch  - the channel to receive from
+ *         pul - storage for the received pulse
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_receive_pulse(struct chan *ch, struct chan_pulse *pul)
+{
+	struct _pulse p;
+	if (MsgReceivePulse(ch->chid, &p, sizeof(struct _pulse), NULL) == -1) {
+		return -1;
+	}
+
+	pul->code = p.code;
+	pul->value = p.value.sival_int;
+	return 0;
+}
+
+#else
+
+#include <stdlib.h>
+#include <sched.h>
+
+/**
+ * Creates a channel without any connections.
+ *
+ * Params: ch      - the channel to create
+ *         n_conns - the most connections that will attach to the channel
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_create(struct chan *ch, int n_conns)
+{
+	if (n_conns < 1) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if ((errno = posix_memalign((void **) &ch->conns, CHAN_CACHE_LINE,
+			n_conns * sizeof(struct chan_conn)))) {
+		return -1;
+	}
+
+	int i;
+	for (i = 0; i < n_conns; i++) {
+		ch->conns[i].tail = 0;
+		ch->conns[i].head = 0;
+	}
+
+	ch->n_conns = n_conns;
+	ch->n_attached = 0;
+	ch->next_poll = 0;
+	evcount_init(&ch->ec);
+
+	return 0;
+}
+
+/**
+ * Destroys a channel. Every connection must have detached.
+ *
+ * Params: ch - the channel to destroy
+ * Return: void
+ */
+void chan_destroy(struct chan *ch)
+{
+	evcount_destroy(&ch->ec);
+	free(ch->conns);
+}
+
+/**
+ * Attaches a new connection to the channel, for the calling thread to send
+ * pulses over.
+ *
+ * Params: ch - the channel to attach to
+ * Return: the connection id, or -1 on failure (errno is set)
+ */
+int chan_attach(struct chan *ch)
+{
+	int coid = __atomic_fetch_add(&ch->n_attached, 1, __ATOMIC_RELAXED);
+	if (coid >= ch->n_conns) {
+		errno = EAGAIN;
+		return -1;
+	}
+	return coid;
+}
+
+/**
+ * Detaches a connection. The receiver gets a CHAN_PULSE_DISCONNECT pulse
+ * after every pulse sent over the connection.
+ *
+ * Params: ch   - the channel attached to
+ *         coid - the connection to detach
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_detach(struct chan *ch, int coid)
+{
+	return chan_send_pulse(ch, coid, CHAN_PULSE_DISCONNECT, coid);
+}
+
+/**
+ * Sends a pulse over a connection, without waiting for the receiver. Only
+ * when the connection already holds CHAN_RING_LEN pulses, the sender yields
+ * until the receiver makes room.
+ *
+ * Params: ch    - the channel attached to
+ *         coid  - the connection to send over
+ *         code  - the pulse code, below CHAN_PULSE_DISCONNECT
+ *         value - the pulse's value
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_send_pulse(struct chan *ch, int coid, int code, int value)
+{
+	if (coid < 0 || coid >= ch->n_conns) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	struct chan_conn *conn = &ch->conns[coid];
+	unsigned long tail = conn->tail; /* Only this sender moves the tail */
+
+	while (tail - __atomic_load_n(&conn->head, __ATOMIC_ACQUIRE)
+			== CHAN_RING_LEN) {
+		sched_yield(); /* Ring is full, the receiver drains it */
+	}
+
+	conn->ring[tail & (CHAN_RING_LEN - 1)].code = code;
+	conn->ring[tail & (CHAN_RING_LEN - 1)].value = value;
+	__atomic_store_n(&conn->tail, tail + 1, __ATOMIC_RELEASE);
+
+	evcount_notify_one(&ch->ec);
+	return 0;
+}
+
+/*
+ * Receives the next pulse of the first non-empty connection, starting at
+ * next_poll. Returns 1 if a pulse was received, or 0 if all are empty.
+ */
+static int chan_poll(struct chan *ch, struct chan_pulse *pul)
+{
+	int i;
+	for (i = 0; i < ch->n_conns; i++) {
+		int coid = (ch->next_poll + i) % ch->n_conns;
+		struct chan_conn *conn = &ch->conns[coid];
+
+		unsigned long head = conn->head; /* Only we move the head */
+		if (head == __atomic_load_n(&conn->tail, __ATOMIC_ACQUIRE)) {
+			continue;
+		}
+
+		*pul = conn->ring[head & (CHAN_RING_LEN - 1)];
+		__atomic_store_n(&conn->head, head + 1, __ATOMIC_RELEASE);
+
+		ch->next_poll = (coid + 1) % ch->n_conns;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * Waits until a pulse arrives on the channel, and receives it.
+ *
+ * Params: ch  - the channel to receive from
+ *         pul - storage for the received pulse
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int chan_receive_pulse(struct chan *ch, struct chan_pulse *pul)
+{
+	while (!chan_poll(ch, pul)) {
+		/* Register as a waiter, then make sure every ring is empty */
+		unsigned int key = evcount_prepare(&ch->ec);
+		if (chan_poll(ch, pul)) {
+			evcount_cancel(&ch->ec);
+			break;
+		}
+		evcount_wait(&ch->ec, key, NULL);
+	}
+	return 0;
+}
+
+#endif
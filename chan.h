@@ -0,0 +1,79 @@
+#ifndef CHAN_H_
+#define CHAN_H_
+
+/*
+ * Proj: 4
+ * File: chan.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the message channel module. A
+ * channel carries pulses (a small code and an int value) from any number of
+ * senders to one receiver, with the semantics of QNX's ChannelCreate(),
+ * ConnectAttach(), MsgSendPulse() and MsgReceivePulse():
+ *
+ *  - pulses from one connection arrive in the order they were sent,
+ *  - a sender never waits for the receiver,
+ *  - when a connection detaches, the receiver gets one last pulse from it
+ *    with the code CHAN_PULSE_DISCONNECT and the connection id as value.
+ *
+ * On QNX the channel is a Neutrino channel. Elsewhere (Linux), every
+ * connection owns a single-producer single-consumer ring of pulses, and the
+ * receiver parks on an eventcount (a futex), so sending a pulse costs no
+ * system call while the receiver is busy.
+ */
+
+/* Pulse codes 0 to CHAN_PULSE_DISCONNECT - 1 are free for the application */
+#define CHAN_PULSE_DISCONNECT 127 /* _PULSE_CODE_MAXAVAIL on QNX */
+
+struct chan_pulse
+{
+	int code; /* What the pulse means */
+	int value; /* The pulse's payload */
+};
+
+#ifdef __QNXNTO__
+
+struct chan
+{
+	int chid; /* The Neutrino channel */
+};
+
+#else
+
+#include "evcount.h"
+
+#define CHAN_CACHE_LINE 64 /* Size of a cache line in bytes */
+#define CHAN_RING_LEN 1024 /* Pulses a connection can queue (power of two) */
+
+struct chan_conn
+{
+	struct chan_pulse ring[CHAN_RING_LEN]; /* The queued pulses */
+
+	/* The sender's and receiver's positions never share a cache line */
+	volatile unsigned long tail __attribute__((aligned(CHAN_CACHE_LINE)));
+	volatile unsigned long head __attribute__((aligned(CHAN_CACHE_LINE)));
+} __attribute__((aligned(CHAN_CACHE_LINE)));
+
+struct chan
+{
+	struct chan_conn *conns; /* One ring per connection */
+	int n_conns; /* The most connections the channel accepts */
+	volatile int n_attached; /* Connections handed out so far */
+	int next_poll; /* The connection the receiver looks at first */
+	struct evcount ec; /* Where the receiver parks */
+};
+
+#endif
+
+int chan_create(struct chan *ch, int n_conns);
+void chan_destroy(struct chan *ch);
+
+int chan_attach(struct chan *ch);
+int chan_detach(struct chan *ch, int coid);
+
+int chan_send_pulse(struct chan *ch, int coid, int code, int value);
+int chan_receive_pulse(struct chan *ch, struct chan_pulse *pul);
+
+#endif
@@ -16,6 +16,8 @@ QNX_INTERNAL=$(PROJECT_ROOT)/.qnx_internal.mk
 endif
 include $(QNX_INTERNAL)
 
+LIBS+=m socket
+
 include $(MKFILES_ROOT)/qtargets.mk
 
 OPTIMIZE_TYPE_g=none
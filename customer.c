@@ -7,74 +7,75 @@
  * Description:
  *
  * Implements the public interface contained in customer.h. This module
- * contains: code to both instantiate and free customer structs, code to
- * manipulate the customer queue, and code to determine the queue's maximum
- * length over time.
+ * contains: code to manipulate the customer queue, and code to determine the
+ * queue's maximum length over time.
  *
- * The queue backing this module is implemented in a naive way. It is simply
- * an array of the worst-case size. This is fine, as this lab is not about
- * queuing theory.
+ * The queue backing this module is a circular buffer which doubles in size
+ * whenever it fills up. Its memory follows the deepest the line ever gets,
+ * rather than the number of customers who pass through it.
  */
 
 #include <stdlib.h> /* For malloc */
 #include "customer.h"
 
 /**
- * This function allocates memory for and initializes the fields of a new
- * customer struct.
+ * Initializes an empty, unplugged line. The line's queue array is an array of
+ * customer ids, starting out with CUSTOMER_Q_INIT_CAP slots.
  *
- * Params: cid - the customer id
- * Return: the malloc'ed and initialized customer struct
+ * The counters poll_slot and push_slot, masked by the number of slots,
+ * indicate at any given time which slot in the queue array is to be set or
+ * returned.
+ *
+ * Params: q - the line to initialize
+ * Return: 0 on success, -1 if the slots could not be allocated
  */
-struct customer *customer_make(int cid)
+int customer_q_init(struct customer_q *q)
 {
-	struct customer *cust = malloc(sizeof(struct customer));
-
-	cust->cid = cid;
-	cust->enqueue_sec = 0;
-	cust->dequeue_sec = 0;
-	cust->time_with_teller = 0;
-
-	return cust;
+	q->queue = malloc(CUSTOMER_Q_INIT_CAP * sizeof(int));
+	if (q->queue == NULL) return -1;
+	q->mask = CUSTOMER_Q_INIT_CAP - 1;
+	q->poll_slot = 0;
+	q->push_slot = 0;
+	q->q_plugged = 0;
+	q->max_depth = 0;
+	return 0;
 }
 
 /**
- * This function frees the memory associated with an existing customer struct.
+ * Frees the line. The line never owns the customers standing in it, those
+ * are released by whoever made them (the day's customer store).
  *
- * Params: cust - the customer struct to free
+ * Params: q - the line to free
  * Return: void
  */
-void customer_free(struct customer* cust)
+void customer_q_destroy(struct customer_q *q)
 {
-	free(cust);
+	free(q->queue);
+	q->queue = NULL;
 }
 
-/**
- * The queue array is an array of (struct customer *). The queue can hold up
- * to MAX_CUSTOMERS_PER_DAY, which is the worst case the queue might encounter.
- *
- * The indices below, poll_slot and push_slot, indicate at any given time
- * which slot in the queue array is to be set or returned.
- *
- * Note: External code must guarantee mutually exclusive access to the data
- * structures below.
- */
-static struct customer *queue[MAX_CUSTOMERS_PER_DAY];
-static volatile int poll_slot = 0;
-static volatile int push_slot = 0;
-
-/**
- * Frees all the customers allocated throughout the simulation
- *
- * Params: void
- * Return: void
+/*
+ * Doubles the number of slots of a full line. The customers are copied over
+ * in line order, starting at slot poll_slot of the new array, such that the
+ * counters stay valid. Returns 0, or -1 (with the line unchanged) if the
+ * slots could not be allocated.
  */
-void customer_free_all(void)
+static int customer_q_grow(struct customer_q *q)
 {
-	int i;
-	for(i = 0; i < push_slot; i++) {
-		customer_free(queue[i]);
+	unsigned int cap = (q->mask + 1) * 2;
+	if (cap == 0) return -1;
+	int *queue = malloc(cap * sizeof(int));
+	if (queue == NULL) return -1;
+
+	unsigned int i;
+	for (i = q->poll_slot; i != q->push_slot; i++) {
+		queue[i & (cap - 1)] = q->queue[i & q->mask];
 	}
+
+	free(q->queue);
+	q->queue = queue;
+	q->mask = cap - 1;
+	return 0;
 }
 
 /**
@@ -83,16 +84,12 @@ void customer_free_all(void)
  * know when to stop blocking (they stop blocking when there are no more
  * customers in line, and there cannot be any more customers added to the line.
  *
- * Note: External code must guarantee mutually exclusive access to the data
- * structures below.
- *
- * Params: void
+ * Params: q - the line to plug
  * Return: void
  */
-static volatile int q_plugged = 0;
-void customer_q_plug()
+void customer_q_plug(struct customer_q *q)
 {
-	q_plugged = 1;
+	q->q_plugged = 1;
 }
 
 /*
@@ -101,41 +98,58 @@ void customer_q_plug()
  * module, max_depth will always represent the maximum depth the queue has ever
  * been.
  *
- * Params: void
+ * Params: q - the line to inspect
  * return: The maximum depth the queue has ever been, up to this point in time
  */
-static volatile int max_depth = 0;
-int customer_q_max_depth()
+int customer_q_max_depth(struct customer_q *q)
+{
+	return q->max_depth;
+}
+
+/**
+ * The number of customers in line right now.
+ *
+ * Params: q - the line to inspect
+ * Return: The depth of the line
+ */
+int customer_q_depth(struct customer_q *q)
 {
-	return max_depth;
+	return (int) (q->push_slot - q->poll_slot);
 }
 
 /**
  * Add a customer to the end of the line.
  *
- * Params: cust - the customer structure to add to the end of the line
- * Return: void
+ * Params: q   - the line to add to
+ *         cid - the id of the customer to add to the end of the line
+ * Return: 0 on success, -1 if the line is full and could not grow
  */
-void customer_q_push(struct customer *cust)
+int customer_q_push(struct customer_q *q, int cid)
 {
-	queue[push_slot++] = cust;
+	if (q->push_slot - q->poll_slot > q->mask
+			&& customer_q_grow(q) == -1) {
+		return -1;
+	}
+
+	q->queue[q->push_slot++ & q->mask] = cid;
 
-	int depth = push_slot - poll_slot;
-	if (depth > max_depth) max_depth = depth;
+	int depth = q->push_slot - q->poll_slot;
+	if (depth > q->max_depth) q->max_depth = depth;
+	return 0;
 }
 
 /**
  * Removes and returns a customer from the front of the line
  *
- * Params: void
- * Return: The customer removed from the front of the line
+ * Params: q - the line to remove from
+ * Return: The id of the customer removed from the front of the line
  */
-struct customer *customer_q_poll()
+int customer_q_poll(struct customer_q *q)
 {
-	int depth = push_slot - poll_slot;
-	if (depth > max_depth) max_depth = depth;
+	int depth = q->push_slot - q->poll_slot;
+	if (depth > q->max_depth) q->max_depth = depth;
 
-	return queue[poll_slot++];
+	return q->queue[q->poll_slot++ & q->mask];
 }
 
 /**
@@ -149,16 +163,16 @@ struct customer *customer_q_poll()
  * If the bank is not yet plugged, and there are no customers to poll, ENOCUS
  * is returned.
  *
- * Params: void
+ * Params: q - the line to inspect
  * Return: EAVAIL - customers are available to poll
  *         EEMPTY - the line is empty and no more customers will be added
  *         ENOCUS - the line currently empty, but more will be added soon
  */
-int customer_q_can_poll()
+int customer_q_can_poll(struct customer_q *q)
 {
-	if (push_slot > poll_slot) {
+	if (q->push_slot != q->poll_slot) {
 		return EAVAIL;
-	} else if (q_plugged) {
+	} else if (q->q_plugged) {
 		return EEMPTY;
 	} else {
 		return ENOCUS;
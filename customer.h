@@ -9,46 +9,59 @@
  *
  * Description:
  *
- * This file contains the public interface to the customer module. A customer
- * structure is provided to hold metrics associated with the customer's time
- * at the bank.
- *
- * Finally, this module allows for the manipulation of a customer queue.
+ * This file contains the public interface to the customer module: a line of
+ * customers. A customer is known by its id alone; what is known about it is
+ * kept in the day's customer store (see customer_store.h).
  */
 
-struct customer
-{
-	int cid; /* Customer ID */
-	int enqueue_sec; /* The second that the customer entered the queue */
-	int dequeue_sec; /* The second that the customer left the queue */
-	int time_with_teller; /* The elapsed seconds spent in transaction */
-};
+/*
+ * The number of customers the default bank sees in a day. The actual worst
+ * case is 420: the bank is open for 420 minutes, and a customer could arrive
+ * every single minute. Bounded lines (see customer_lfq.h) are sized with it.
+ *
+ * The line below is not bounded by it - it grows with the deepest the line
+ * ever gets, not with the number of customers in a day.
+ */
+#define MAX_CUSTOMERS_PER_DAY 500
 
-struct customer *customer_make(int cid);
-void customer_free(struct customer* cust);
+/*
+ * The number of slots a line starts out with. Must be a power of two.
+ */
+#define CUSTOMER_Q_INIT_CAP 16
 
 /*
- * The maximum size of the queue of customers. This project doesn't deal with
- * queuing theory. We simply create an array to hold each possible customer that
- * will arrive throughout the day.
+ * A line of customers. Each simulated day owns its own line, such that many
+ * days can be simulated within one process.
+ *
+ * The line is a circular buffer with a power of two number of slots. The
+ * poll_slot and push_slot counters only ever increase, and are masked into
+ * the slot array, so slots are reused as customers leave the line.
  *
- * The actual worst case maximum is 420. The bank is open for 420 minutes, and
- * a customer could arrive every single minute (in the worst case). The actual
- * maximum is 500 so we can detect lapses in timing logic.
+ * Note: External code must guarantee mutually exclusive access to a line.
  */
-#define MAX_CUSTOMERS_PER_DAY 500
+struct customer_q
+{
+	int *queue; /* Slots of the line, holding customer ids */
+	unsigned int mask; /* Number of slots - 1 */
+	volatile unsigned int poll_slot; /* The next slot to poll */
+	volatile unsigned int push_slot; /* The next slot to push */
+	volatile int q_plugged; /* Set when no more customers will arrive */
+	volatile int max_depth; /* The deepest the line has ever been */
+};
 
-int customer_q_max_depth(void);
-void customer_q_push(struct customer *cust);
-struct customer *customer_q_poll();
+int customer_q_init(struct customer_q *q);
+void customer_q_destroy(struct customer_q *q);
 
-void customer_free_all(void);
+int customer_q_max_depth(struct customer_q *q);
+int customer_q_depth(struct customer_q *q);
+int customer_q_push(struct customer_q *q, int cid);
+int customer_q_poll(struct customer_q *q);
 
-void customer_q_plug();
+void customer_q_plug(struct customer_q *q);
 
 #define EAVAIL 0
 #define EEMPTY 1
 #define ENOCUS 2
-int customer_q_can_poll();
+int customer_q_can_poll(struct customer_q *q);
 
 #endif
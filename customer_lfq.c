@@ -0,0 +1,216 @@
+/*
+ * Proj: 4
+ * File: customer_lfq.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in customer_lfq.h.
+ *
+ * Every cell of the ring carries a sequence number. A cell at ring position
+ * pos is free for a producer when its sequence equals pos, and holds a
+ * customer for a consumer when its sequence equals pos + 1. Producers and
+ * consumers claim a position with one compare-and-swap on push_pos or
+ * poll_pos respectively, and then publish the cell by advancing its sequence
+ * by one lap. No thread ever waits on another thread holding a lock.
+ */
+
+#include <stdlib.h>
+#include "customer_lfq.h"
+
+/**
+ * Initializes an empty, unplugged line.
+ *
+ * Params: q        - the line to initialize
+ *         capacity - the most customers the line can hold at once (rounded
+ *                    up to a power of two)
+ * Return: 0 on success, -1 if the cells could not be allocated
+ */
+int customer_lfq_init(struct customer_lfq *q, unsigned long capacity)
+{
+	unsigned long cap = 2;
+	while (cap < capacity) cap *= 2;
+
+	if (posix_memalign((void **) &q->cells, LFQ_CACHE_LINE,
+			cap * sizeof(struct customer_lfq_cell))) {
+		return -1;
+	}
+
+	unsigned long i;
+	for (i = 0; i < cap; i++) {
+		q->cells[i].seq = i;
+		q->cells[i].cid = -1;
+	}
+
+	q->mask = cap - 1;
+	q->push_pos = 0;
+	q->poll_pos = 0;
+	q->q_plugged = 0;
+	q->max_depth = 0;
+
+	return 0;
+}
+
+/**
+ * Frees the line. No other thread may be using the line. As with customer_q,
+ * the line doesn't own the customers standing in it.
+ *
+ * Params: q - the line to destroy
+ * Return: void
+ */
+void customer_lfq_destroy(struct customer_lfq *q)
+{
+	free(q->cells);
+	q->cells = NULL;
+}
+
+/*
+ * Raises max_depth to at least depth.
+ */
+static void customer_lfq_track_depth(struct customer_lfq *q, int depth)
+{
+	int max = __atomic_load_n(&q->max_depth, __ATOMIC_RELAXED);
+	while (depth > max) {
+		if (__atomic_compare_exchange_n(&q->max_depth, &max, depth, 1,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+}
+
+/**
+ * Add a customer to the end of the line.
+ *
+ * Params: q   - the line to add to
+ *         cid - the id of the customer to add to the end of the line
+ * Return: 0 on success, -1 if the line is full
+ */
+int customer_lfq_push(struct customer_lfq *q, int cid)
+{
+	struct customer_lfq_cell *cell;
+	unsigned long pos = __atomic_load_n(&q->push_pos, __ATOMIC_RELAXED);
+
+	while (1) {
+		cell = &q->cells[pos & q->mask];
+		unsigned long seq = __atomic_load_n(&cell->seq,
+				__ATOMIC_ACQUIRE);
+		long dif = (long) seq - (long) pos;
+
+		if (dif == 0) {
+			/* The cell is free, try to claim the position */
+			if (__atomic_compare_exchange_n(&q->push_pos, &pos,
+					pos + 1, 1, __ATOMIC_RELAXED,
+					__ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (dif < 0) {
+			return -1; /* The cell is a lap behind: full */
+		} else {
+			pos = __atomic_load_n(&q->push_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	cell->cid = cid;
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+	unsigned long polled = __atomic_load_n(&q->poll_pos, __ATOMIC_RELAXED);
+	customer_lfq_track_depth(q, (int) (pos + 1 - polled));
+
+	return 0;
+}
+
+/*
+ * Removes and returns the id of the customer at the front of the line, or -1
+ * if the line is empty.
+ */
+static int customer_lfq_take(struct customer_lfq *q)
+{
+	struct customer_lfq_cell *cell;
+	unsigned long pos = __atomic_load_n(&q->poll_pos, __ATOMIC_RELAXED);
+
+	while (1) {
+		cell = &q->cells[pos & q->mask];
+		unsigned long seq = __atomic_load_n(&cell->seq,
+				__ATOMIC_ACQUIRE);
+		long dif = (long) seq - (long) (pos + 1);
+
+		if (dif == 0) {
+			/* The cell is full, try to claim the position */
+			if (__atomic_compare_exchange_n(&q->poll_pos, &pos,
+					pos + 1, 1, __ATOMIC_RELAXED,
+					__ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (dif < 0) {
+			return -1; /* Nothing pushed here yet: empty */
+		} else {
+			pos = __atomic_load_n(&q->poll_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	int cid = cell->cid;
+	__atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+
+	return cid;
+}
+
+/**
+ * Tries to remove a customer from the front of the line. Checking for and
+ * removing a customer happen in one step, since another teller may poll
+ * the line at the same time.
+ *
+ * Params: q   - the line to remove from
+ *         cid - storage for the id of the customer removed, if any
+ * Return: EAVAIL - a customer was removed into cid
+ *         EEMPTY - the line is empty and no more customers will be added
+ *         ENOCUS - the line currently empty, but more will be added soon
+ */
+int customer_lfq_poll(struct customer_lfq *q, int *cid)
+{
+	if ((*cid = customer_lfq_take(q)) != -1) return EAVAIL;
+
+	if (__atomic_load_n(&q->q_plugged, __ATOMIC_ACQUIRE)) {
+		/* The last customer may have been pushed before the plug */
+		if ((*cid = customer_lfq_take(q)) != -1) return EAVAIL;
+		return EEMPTY;
+	}
+
+	return ENOCUS;
+}
+
+/**
+ * Indicates that no more customers will be pushed to the line. Every push
+ * made before the plug is visible to a poll which sees the plug.
+ *
+ * Params: q - the line to plug
+ * Return: void
+ */
+void customer_lfq_plug(struct customer_lfq *q)
+{
+	__atomic_store_n(&q->q_plugged, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Returns the maximum depth the line has ever been, up to this point in time.
+ *
+ * Params: q - the line to inspect
+ * Return: the maximum depth
+ */
+int customer_lfq_max_depth(struct customer_lfq *q)
+{
+	return __atomic_load_n(&q->max_depth, __ATOMIC_RELAXED);
+}
+
+/**
+ * Returns the number of customers in line right now. As other threads push
+ * and poll, the depth is only a snapshot.
+ *
+ * Params: q - the line to inspect
+ * Return: the depth
+ */
+int customer_lfq_depth(struct customer_lfq *q)
+{
+	unsigned long poll = __atomic_load_n(&q->poll_pos, __ATOMIC_RELAXED);
+	unsigned long push = __atomic_load_n(&q->push_pos, __ATOMIC_RELAXED);
+	return push > poll ? (int) (push - poll) : 0;
+}
@@ -0,0 +1,56 @@
+#ifndef CUSTOMER_LFQ_H_
+#define CUSTOMER_LFQ_H_
+
+/*
+ * Proj: 4
+ * File: customer_lfq.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the lock-free line of customers.
+ * Unlike the line in customer.h, this line may be pushed and polled by any
+ * number of threads at once, without external mutual exclusion. It is a
+ * bounded ring of slots which each carry a sequence number (after Dmitry
+ * Vyukov's bounded MPMC queue).
+ *
+ * The line reports the same EAVAIL, EEMPTY and ENOCUS codes as
+ * customer_q_can_poll().
+ */
+
+#include "customer.h"
+
+#define LFQ_CACHE_LINE 64 /* Size of a cache line in bytes */
+
+struct customer_lfq_cell
+{
+	volatile unsigned long seq; /* Which lap of the ring the cell is on */
+	int cid; /* The id of the customer held in the cell */
+};
+
+struct customer_lfq
+{
+	struct customer_lfq_cell *cells; /* The ring of cells */
+	unsigned long mask; /* Number of cells - 1 (a power of two) */
+
+	/* The producer and consumer positions never share a cache line */
+	volatile unsigned long push_pos
+			__attribute__((aligned(LFQ_CACHE_LINE)));
+	volatile unsigned long poll_pos
+			__attribute__((aligned(LFQ_CACHE_LINE)));
+
+	volatile int q_plugged __attribute__((aligned(LFQ_CACHE_LINE)));
+	volatile int max_depth; /* The deepest the line has ever been */
+};
+
+int customer_lfq_init(struct customer_lfq *q, unsigned long capacity);
+void customer_lfq_destroy(struct customer_lfq *q);
+
+int customer_lfq_push(struct customer_lfq *q, int cid);
+int customer_lfq_poll(struct customer_lfq *q, int *cid);
+
+void customer_lfq_plug(struct customer_lfq *q);
+int customer_lfq_max_depth(struct customer_lfq *q);
+int customer_lfq_depth(struct customer_lfq *q);
+
+#endif
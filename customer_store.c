@@ -0,0 +1,305 @@
+/*
+ * Proj: 4
+ * File: customer_store.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in customer_store.h.
+ *
+ * The columns share one allocation, each padded out to whole cache lines.
+ * Growing the store moves every column, so a store shared by threads must be
+ * reserved for the whole day before they start.
+ *
+ * The reductions sum a block of customers in 32-bit lanes, and only fold the
+ * lanes into 64 bits between blocks. Lanes of customers not served are
+ * masked out with the lanes' compare results (all ones, or all zeros), as C
+ * has no vector conditional. Only the compares which SSE2 has (equal and
+ * greater than) and arithmetic shifts are used, or GCC falls back to a
+ * lane at a time.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "customer_store.h"
+
+typedef int cs_lanes __attribute__((vector_size(4 * CUSTOMER_STORE_LANES)));
+
+/*
+ * Steps a reduction takes before folding its lanes: a lane sums up to this
+ * many spans of a day (of 86400 seconds at most), without overflowing.
+ */
+#define CS_BLOCK_STEPS 1024
+
+/* Ints per cache line: columns are rounded up to whole lines of them */
+#define CS_LINE_INTS (CUSTOMER_STORE_LINE / (int) sizeof(int))
+
+/**
+ * Initializes an empty store. No memory is reserved until the first
+ * customer is made.
+ *
+ * Params: cs - the store to initialize
+ * Return: void
+ */
+void customer_store_init(struct customer_store *cs)
+{
+	cs->enqueue_sec = NULL;
+	cs->dequeue_sec = NULL;
+	cs->time_with_teller = NULL;
+	cs->n_cust = 0;
+	cs->cap = 0;
+	cs->allocs = 0;
+	cs->bytes_reserved = 0;
+}
+
+/**
+ * Makes room for the customers with ids below n_cust. The columns move, so
+ * no other thread may be using the store.
+ *
+ * Params: cs     - the store
+ *         n_cust - the customers to make room for
+ * Return: 0 on success, -1 if the columns could not be allocated
+ */
+int customer_store_reserve(struct customer_store *cs, int n_cust)
+{
+	if (n_cust <= cs->cap) return 0;
+
+	int cap = (n_cust + CS_LINE_INTS - 1) & ~(CS_LINE_INTS - 1);
+	int *cols;
+	if (posix_memalign((void **) &cols, CUSTOMER_STORE_LINE,
+			3 * (size_t) cap * sizeof(int))) {
+		return -1;
+	}
+
+	if (cs->n_cust > 0) {
+		size_t bytes = cs->n_cust * sizeof(int);
+		memcpy(cols, cs->enqueue_sec, bytes);
+		memcpy(cols + cap, cs->dequeue_sec, bytes);
+		memcpy(cols + 2 * cap, cs->time_with_teller, bytes);
+	}
+	free(cs->enqueue_sec);
+
+	cs->enqueue_sec = cols;
+	cs->dequeue_sec = cols + cap;
+	cs->time_with_teller = cols + 2 * cap;
+	cs->cap = cap;
+	cs->bytes_reserved = 3 * (size_t) cap * sizeof(int);
+	return 0;
+}
+
+/**
+ * Releases every customer of the store at once. The store keeps its columns
+ * for the customers made after the reset. The allocation counter is
+ * cleared, so read it before resetting.
+ *
+ * Params: cs - the store to reset
+ * Return: void
+ */
+void customer_store_reset(struct customer_store *cs)
+{
+	cs->n_cust = 0;
+	cs->allocs = 0;
+}
+
+/**
+ * Releases every customer of the store, and frees its columns.
+ *
+ * Params: cs - the store to destroy
+ * Return: void
+ */
+void customer_store_destroy(struct customer_store *cs)
+{
+	free(cs->enqueue_sec);
+	customer_store_init(cs);
+}
+
+/**
+ * Makes the customer of an id, neither lined up nor served, with no
+ * transaction. Ids skipped over are made too, as customers who never came.
+ * The columns double whenever they fill up; reserve them beforehand when
+ * threads share the store.
+ *
+ * Params: cs  - the store to make the customer in
+ *         cid - the customer id, not made since the last reset
+ * Return: the customer id, or -1 if the columns could not grow
+ */
+int customer_store_make(struct customer_store *cs, int cid)
+{
+	if (cid >= cs->cap) {
+		int cap = cs->cap ? 2 * cs->cap : 256;
+		if (cap <= cid) cap = cid + 1;
+		if (customer_store_reserve(cs, cap) == -1) return -1;
+	}
+
+	int i;
+	for (i = cs->n_cust; i <= cid; i++) {
+		cs->enqueue_sec[i] = -1;
+		cs->dequeue_sec[i] = CUSTOMER_WAITING;
+		cs->time_with_teller[i] = 0;
+	}
+	if (cid >= cs->n_cust) cs->n_cust = cid + 1;
+
+	cs->allocs++;
+	return cid;
+}
+
+/*
+ * Loads the spans of the CUSTOMER_STORE_LANES customers from i on, and a
+ * mask of those served.
+ */
+static void spans_load(const int *hi, const int *lo, const int *served,
+		long i, cs_lanes *span, cs_lanes *mask)
+{
+	cs_lanes l, s;
+
+	memcpy(span, hi + i, sizeof(*span));
+	memcpy(&s, served + i, sizeof(s));
+	*mask = ~(s >> 31); /* All ones where s is not negative */
+	if (lo == NULL) return;
+
+	memcpy(&l, lo + i, sizeof(l));
+	*span -= l;
+}
+
+/**
+ * Reduces the spans hi[i] - lo[i] of the customers served (whose served[i]
+ * is not negative, as a dequeue_sec column is) to their count, sum, minimum
+ * and maximum. For the queue waits of a store, pass its dequeue_sec and
+ * enqueue_sec columns; for the transactions, time_with_teller, NULL, and
+ * dequeue_sec.
+ *
+ * Params: hi     - the column the spans end at
+ *         lo     - the column the spans start at, or NULL for spans of hi
+ *         served - the column masking the customers served
+ *         n      - the customers to reduce
+ *         sp     - storage for the reduction (min and max are 0 if no
+ *                  customer was served)
+ * Return: void
+ */
+void customer_spans_reduce(const int *hi, const int *lo, const int *served,
+		long n, struct customer_spans *sp)
+{
+	const cs_lanes zero = { 0 };
+	cs_lanes vmin = zero + INT_MAX, vmax = zero + INT_MIN;
+
+	sp->n = 0;
+	sp->sum = 0;
+
+	long i = 0;
+	while (i + CUSTOMER_STORE_LANES <= n) {
+		cs_lanes vsum = { 0 }, vcnt = { 0 };
+		long end = i + CS_BLOCK_STEPS * CUSTOMER_STORE_LANES;
+		if (end > n) end = n;
+
+		for (; i + CUSTOMER_STORE_LANES <= end;
+				i += CUSTOMER_STORE_LANES) {
+			cs_lanes s, m;
+			spans_load(hi, lo, served, i, &s, &m);
+			vsum += s & m;
+			vcnt -= m;
+
+			cs_lanes lt = (vmin > s) & m;
+			cs_lanes gt = (s > vmax) & m;
+			vmin = (s & lt) | (vmin & ~lt);
+			vmax = (s & gt) | (vmax & ~gt);
+		}
+
+		int l;
+		for (l = 0; l < CUSTOMER_STORE_LANES; l++) {
+			sp->sum += vsum[l];
+			sp->n += vcnt[l];
+		}
+	}
+
+	int min = INT_MAX, max = INT_MIN, l;
+	for (l = 0; l < CUSTOMER_STORE_LANES; l++) {
+		if (vmin[l] < min) min = vmin[l];
+		if (vmax[l] > max) max = vmax[l];
+	}
+
+	/* The customers which don't fill a vector */
+	for (; i < n; i++) {
+		if (served[i] < 0) continue;
+
+		int s = lo ? hi[i] - lo[i] : hi[i];
+		sp->n++;
+		sp->sum += s;
+		if (s < min) min = s;
+		if (s > max) max = s;
+	}
+
+	sp->min = sp->n ? min : 0;
+	sp->max = sp->n ? max : 0;
+}
+
+/*
+ * Counts the served customers whose span is at most x.
+ */
+static long spans_count_le(const int *hi, const int *lo, const int *served,
+		long n, int x)
+{
+	const cs_lanes zero = { 0 };
+	cs_lanes vx = zero + x;
+	long count = 0;
+
+	long i = 0;
+	while (i + CUSTOMER_STORE_LANES <= n) {
+		cs_lanes vcnt = zero;
+		long end = i + CS_BLOCK_STEPS * CUSTOMER_STORE_LANES;
+		if (end > n) end = n;
+
+		for (; i + CUSTOMER_STORE_LANES <= end;
+				i += CUSTOMER_STORE_LANES) {
+			cs_lanes s, m;
+			spans_load(hi, lo, served, i, &s, &m);
+			vcnt -= ~(s > vx) & m;
+		}
+
+		int l;
+		for (l = 0; l < CUSTOMER_STORE_LANES; l++) count += vcnt[l];
+	}
+
+	for (; i < n; i++) {
+		if (served[i] < 0) continue;
+		if ((lo ? hi[i] - lo[i] : hi[i]) <= x) count++;
+	}
+	return count;
+}
+
+/**
+ * Returns the exact quantile q of the spans of the served customers, the
+ * span of nearest rank (as stats_quantile() ranks them). The quantile is
+ * searched for between the minimum and the maximum, counting the spans at
+ * or below a guess once per halving: some thirty passes over the columns.
+ *
+ * Params: hi     - see customer_spans_reduce()
+ *         lo     - see customer_spans_reduce()
+ *         served - see customer_spans_reduce()
+ *         n      - see customer_spans_reduce()
+ *         sp     - the reduction of the same spans
+ *         q      - the quantile, between 0 and 1
+ * Return: the quantile, or 0 if no customer was served
+ */
+int customer_spans_quantile(const int *hi, const int *lo,
+		const int *served, long n, const struct customer_spans *sp,
+		double q)
+{
+	if (sp->n == 0) return 0;
+
+	long rank = (long) (q * sp->n + 0.5);
+	if (rank < 1) rank = 1;
+	if (rank > sp->n) rank = sp->n;
+
+	/* The smallest span with rank spans at or below it */
+	int a = sp->min, b = sp->max;
+	while (a < b) {
+		int mid = a + (int) (((long) b - a) / 2);
+		if (spans_count_le(hi, lo, served, n, mid) >= rank) {
+			b = mid;
+		} else {
+			a = mid + 1;
+		}
+	}
+	return a;
+}
@@ -0,0 +1,77 @@
+#ifndef CUSTOMER_STORE_H_
+#define CUSTOMER_STORE_H_
+
+/*
+ * Proj: 4
+ * File: customer_store.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the customer store. A day's
+ * customers are kept as columns: one contiguous array per field, indexed by
+ * the customer's id (the id is the index, and needs no column of its own).
+ * Lines of customers (customer.h, customer_lfq.h) only carry ids.
+ *
+ * Every column starts on a cache line of its own and is padded out to whole
+ * cache lines, such that the generator (which writes enqueue_sec) and the
+ * tellers (which write dequeue_sec) never write to the same line.
+ *
+ * Reductions over a column (sums, maxima, exact quantiles) take the
+ * customers CUSTOMER_STORE_LANES at a time, in GCC vectors, like the bulk
+ * generator of rng.h: a day of millions of customers is analysed at about
+ * the speed memory can be read.
+ *
+ * The vectors are 16 bytes wide, as wide as a register of SSE2 (or NEON),
+ * which every target has. GCC splits wider vectors a lane at a time where
+ * the target has no compare as wide, which costs more than it gains.
+ */
+
+#include <stddef.h>
+
+#define CUSTOMER_STORE_LINE 64 /* Size of a cache line in bytes */
+#define CUSTOMER_STORE_LANES 4 /* Customers a reduction takes at once */
+
+/*
+ * A customer not yet polled by a teller (or never: one sent on to another
+ * branch, or left in line) has this dequeue_sec.
+ */
+#define CUSTOMER_WAITING (-1)
+
+struct customer_store
+{
+	int *enqueue_sec; /* The second each customer entered the line */
+	int *dequeue_sec; /* The second each left it, or CUSTOMER_WAITING */
+	int *time_with_teller; /* The seconds each one's transaction takes */
+
+	int n_cust; /* Customers made, the highest id + 1 */
+	int cap; /* Room in each column */
+	long allocs; /* Customers made since the last reset */
+	size_t bytes_reserved; /* Bytes of all columns */
+};
+
+void customer_store_init(struct customer_store *cs);
+int customer_store_reserve(struct customer_store *cs, int n_cust);
+void customer_store_reset(struct customer_store *cs);
+void customer_store_destroy(struct customer_store *cs);
+
+int customer_store_make(struct customer_store *cs, int cid);
+
+/*
+ * A reduction over the spans hi[i] - lo[i] of the served customers.
+ */
+struct customer_spans
+{
+	long n; /* Served customers */
+	long sum; /* The sum of their spans */
+	int min; /* The shortest span */
+	int max; /* The longest span */
+};
+
+void customer_spans_reduce(const int *hi, const int *lo, const int *served,
+		long n, struct customer_spans *sp);
+int customer_spans_quantile(const int *hi, const int *lo,
+		const int *served, long n, const struct customer_spans *sp,
+		double q);
+
+#endif
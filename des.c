@@ -0,0 +1,761 @@
+/*
+ * Proj: 4
+ * File: des.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in des.h. The simulation is
+ * driven by an event queue. Every event fires at a simulated second, and the
+ * simulated clock is simply set to that second - nothing ever sleeps.
+ *
+ * The customer generator and the tellers follow the same logic as the
+ * threads in qnx-banking.c, written as state machines:
+ *
+ *  - The generator schedules one arrival at a time. Once an arrival happens
+ *    at or after closing time, the queue is plugged.
+ *  - A teller is either idle (waiting for a customer), busy (in a
+ *    transaction), on break (or at lunch), or clocked out. Idle tellers are
+ *    woken by an arrival, by the queue being plugged, or when the roster
+ *    says so (see roster_due()). A teller whose shift starts after the bank
+ *    opens clocks in with an event of its own.
+ *
+ * Where the threaded model wakes the teller which went idle last, the lowest
+ * numbered idle teller is woken here, as every idle teller is alike in
+ * virtual time. Wakeups which became
+ * irrelevant (a break falling due for a teller which has since found a
+ * customer) are discarded by comparing the teller's epoch against the epoch
+ * stored in the event.
+ *
+ * A branch may have several lines. Teller t belongs to line t % n_queues,
+ * and an arrival picks its line by the scenario's routing policy, drawing
+ * from a stream of its own (n_tellers + 1) - a single line draws nothing,
+ * such that a one line bank sees the same day as ever. If the scenario lets
+ * tellers steal, an idle teller whose line is empty serves the next line
+ * which is not, looking from its own line onwards.
+ *
+ * A day linked into a region hands arrivals which find their line too long
+ * to the next branch, and is injected the customers the branch before it
+ * hands on. Its bank then stays open until closing time, even if its own
+ * customers run out, because transferred customers may still arrive.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <stdarg.h>
+#include "scenario.h"
+#include "sim.h"
+#include "customer.h"
+#include "customer_store.h"
+#include "event.h"
+#include "trace.h"
+#include "roster.h"
+#include "des.h"
+
+#define EV_ARRIVAL 0 /* A customer enters the bank */
+#define EV_TRANS_END 1 /* A teller completes a transaction */
+#define EV_BREAK_END 2 /* A teller comes back from break */
+#define EV_BREAK_DUE 3 /* An idle teller's break, lunch or shift end is due */
+#define EV_TRANSFER 4 /* A customer arrives from another branch */
+#define EV_CLOSE 5 /* Closing time, for a bank whose customers ran out */
+#define EV_SHIFT_IN 6 /* A teller's shift starts */
+
+#define TS_IDLE 0 /* Waiting for a customer */
+#define TS_BUSY 1 /* In a transaction with a customer */
+#define TS_BREAK 2 /* On break */
+#define TS_OUT 3 /* Clocked out */
+
+struct des_teller
+{
+	int state; /* One of the TS_ states above */
+	struct roster_duty duty; /* The teller's shift, lunch and breaks */
+	int lunch; /* Set if the teller's break is its lunch */
+	int twait_t0; /* The second the teller started waiting for a cust */
+	int break_t0; /* The second the teller's current break started */
+	int epoch; /* Bumped on every wakeup, invalidates pending events */
+	int home; /* The line the teller belongs to */
+	struct rng rng; /* Draws the teller's breaks */
+	int cid; /* The customer in transaction if busy, or -1 */
+};
+
+struct des_day
+{
+	const struct scenario *sc; /* The bank being simulated */
+	struct event_q events; /* Pending events */
+	struct customer_q lines[SCENARIO_MAX_QUEUES]; /* The lines */
+	int n_lines; /* The lines in use (the scenario's n_queues) */
+	struct rng route_rng; /* Picks the line of an arrival */
+	struct sim_range pick; /* Any line */
+	struct sim_range pick_other; /* Any line but one, see des_route() */
+	struct customer_store *store; /* Where customers are kept */
+	struct customer_store tmp_store; /* The store, if none was provided */
+	int now; /* The simulated clock */
+	int verbose; /* Print SIM> lines if set */
+	char buf[40]; /* Storage for sim_fmt_time() */
+
+	int *arrive; /* Seconds before each customer arrives, pre-drawn */
+	int *transt; /* Each customer's transaction time, pre-drawn */
+	int cur_cid; /* The id of the next customer to arrive */
+	int max_cust; /* The customers drawn (see scenario_max_customers()) */
+
+	des_transfer_fn xfer; /* Hands customers on, if linked into a region */
+	void *xfer_arg; /* Passed to xfer */
+	int *inj_transt; /* Transaction times of the injected customers */
+	int n_inj; /* Customers injected */
+	int cap_inj; /* Room in inj_transt */
+
+	struct des_teller *tellers; /* One per teller of the scenario */
+	struct roster roster; /* Lets the tellers off the counter */
+
+	/* Accumulated measurements, as sent to the stat_muncher */
+	struct bank_stats stats;
+	struct des_counts counts;
+	struct trace *trace; /* Records the day, if not NULL */
+	int failed; /* Set once an event could not be scheduled */
+};
+
+/*
+ * Schedules an event of the day. If the event queue can't grow, the day
+ * fails: it stops firing events, and is over.
+ */
+static void des_schedule(struct des_day *day, int sec, int type, int tid,
+		int epoch)
+{
+	if (event_q_push(&day->events, sec, type, tid, epoch) == -1
+			&& !day->failed) {
+		perror("CON> Error scheduling an event");
+		day->failed = 1;
+	}
+}
+
+/*
+ * Prints a SIM> line stamped with the current simulated time, if the
+ * simulation is verbose.
+ */
+static void des_log(struct des_day *day, const char *fmt, ...)
+{
+	if (!day->verbose) return;
+
+	sim_fmt_time(day->buf, sizeof(day->buf), day->now);
+	printf("%s ", day->buf);
+
+	va_list ap;
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+}
+
+static void des_teller_ready(struct des_day *day, int tid);
+static void des_teller_break(struct des_day *day, int tid);
+static void des_teller_wait(struct des_day *day, int tid);
+static void des_teller_poll(struct des_day *day, int tid);
+
+/*
+ * Clocks a teller out for the rest of the day.
+ */
+static void des_teller_out(struct des_day *day, int tid)
+{
+	day->tellers[tid].state = TS_OUT;
+	des_log(day, "teller %d clocks out.\n", tid + 1);
+}
+
+/*
+ * Clocks a teller in at the start of its shift.
+ */
+static void des_teller_in(struct des_day *day, int tid)
+{
+	struct des_teller *t = &day->tellers[tid];
+
+	des_log(day, "teller %d clocks in.\n", tid + 1);
+	roster_clock_in(day->sc, &t->duty, &t->rng, day->now);
+	des_teller_ready(day, tid);
+}
+
+/*
+ * The top of the teller loop: clock out at the end of the shift, otherwise
+ * check for a break (or lunch) and go looking for a customer.
+ */
+static void des_teller_ready(struct des_day *day, int tid)
+{
+	struct des_teller *t = &day->tellers[tid];
+	if (t->duty.sec_out - day->now <= 0) {
+		des_teller_out(day, tid);
+		return;
+	}
+
+	if (day->now >= roster_next_off(&t->duty)) {
+		des_teller_break(day, tid);
+	} else {
+		des_teller_wait(day, tid);
+	}
+}
+
+/*
+ * Sends a teller on break, or to lunch. The teller comes back with an
+ * EV_BREAK_END. If the roster keeps the teller at the counter, it goes
+ * looking for a customer instead.
+ */
+static void des_teller_break(struct des_day *day, int tid)
+{
+	struct des_teller *t = &day->tellers[tid];
+
+	int back = roster_leave(&day->roster, &t->duty, &t->rng, tid,
+			day->now, &t->lunch);
+	if (back == -1) {
+		des_teller_wait(day, tid);
+		return;
+	}
+	if (t->lunch) {
+		des_log(day, "teller %d goes to lunch.\n", tid + 1);
+	} else {
+		des_log(day, "teller %d went on break.\n", tid + 1);
+	}
+
+	t->break_t0 = day->now;
+	t->state = TS_BREAK;
+	des_schedule(day, back, EV_BREAK_END, tid, t->epoch);
+}
+
+/*
+ * Starts the teller's wait for a customer.
+ */
+static void des_teller_wait(struct des_day *day, int tid)
+{
+	day->tellers[tid].twait_t0 = day->now;
+	des_teller_poll(day, tid);
+}
+
+/*
+ * Finds the line a teller serves its next customer from: its own line, or
+ * with stealing, the first of the following lines with a customer. Returns
+ * what customer_q_can_poll() would return for all the lines the teller
+ * serves, and stores the line into line if a customer is available.
+ */
+static int des_teller_line(struct des_day *day, int tid, int *line)
+{
+	int home = day->tellers[tid].home;
+	int code = customer_q_can_poll(&day->lines[home]);
+	*line = home;
+	if (code == EAVAIL || !SCENARIO(day->sc)->steal) return code;
+
+	int i;
+	for (i = 1; i < day->n_lines; i++) {
+		int l = (home + i) % day->n_lines;
+		int c = customer_q_can_poll(&day->lines[l]);
+		if (c == EAVAIL) {
+			*line = l;
+			return EAVAIL;
+		}
+		if (c == ENOCUS) code = ENOCUS;
+	}
+	return code;
+}
+
+/*
+ * Lets a waiting teller look at the queue. The teller either starts a
+ * transaction, takes a break which fell due, clocks out because the bank is
+ * empty and closed, or goes (back) to being idle.
+ */
+static void des_teller_poll(struct des_day *day, int tid)
+{
+	struct des_teller *t = &day->tellers[tid];
+	int line;
+	int poll_code = des_teller_line(day, tid, &line);
+
+	if (poll_code != EAVAIL && day->now >= roster_next_off(&t->duty)) {
+		des_teller_break(day, tid);
+		return;
+	}
+
+	if (poll_code == EEMPTY) {
+		des_log(day, "teller %d realizes there are no customers "
+			"left to help.\n", tid + 1);
+		des_teller_out(day, tid);
+		return;
+	}
+
+	if (poll_code == ENOCUS) {
+		/* The shift is over, though customers may still come */
+		int due = roster_due(day->sc, &t->duty);
+		if (day->now >= due) {
+			des_teller_out(day, tid);
+			return;
+		}
+
+		/* Idle until a customer shows up or the roster is due */
+		t->state = TS_IDLE;
+		des_schedule(day, due, EV_BREAK_DUE, tid, t->epoch);
+		return;
+	}
+
+	struct customer_store *cs = day->store;
+	int cid = customer_q_poll(&day->lines[line]);
+	cs->dequeue_sec[cid] = day->now;
+	day->counts.served++;
+	if (line != t->home) day->counts.stolen++;
+
+	/* Time customer spent waiting in the queue */
+	int elaps = cs->dequeue_sec[cid] - cs->enqueue_sec[cid];
+	stats_add(&day->stats.q, elaps);
+
+	/* Time teller spent waiting for a new customer */
+	int twait = day->now - t->twait_t0;
+	stats_add(&day->stats.c, twait);
+
+	des_log(day, "teller %d initiates transaction with customer %03d.\n",
+			tid + 1, cid);
+
+	int transt = cs->time_with_teller[cid];
+	stats_add(&day->stats.t, transt);
+	trace_customer(day->trace, 0, cs, cid, tid, twait);
+
+	t->state = TS_BUSY;
+	t->cid = cid;
+	des_schedule(day, day->now + transt, EV_TRANS_END, tid, t->epoch);
+}
+
+/*
+ * Wakes idle tellers, in order of their id, such that they poll the queue.
+ * At most max_wake tellers are woken: tellers of the given line (or with
+ * stealing, any teller), or of any line if line is -1.
+ */
+static void des_wake_idle(struct des_day *day, int line, int max_wake)
+{
+	const struct scenario *sc = SCENARIO(day->sc);
+	int tid;
+	for (tid = 0; tid < sc->n_tellers && max_wake > 0; tid++) {
+		struct des_teller *t = &day->tellers[tid];
+		if (t->state != TS_IDLE) continue;
+		if (line != -1 && t->home != line && !sc->steal) continue;
+
+		t->epoch++; /* Forget the pending EV_BREAK_DUE */
+		des_teller_poll(day, tid);
+		max_wake--;
+	}
+}
+
+/*
+ * Picks the line of an arriving customer, by the routing policy of the
+ * scenario.
+ */
+static int des_route(struct des_day *day)
+{
+	const struct scenario *sc = SCENARIO(day->sc);
+	if (day->n_lines == 1) return 0;
+
+	int l, best = 0;
+	uint32_t kind;
+	switch (sc->route)
+	{
+	case ROUTE_JSQ:
+		/* The shortest line, the lowest numbered one on a tie */
+		for (l = 1; l < day->n_lines; l++) {
+			if (customer_q_depth(&day->lines[l])
+					< customer_q_depth(&day->lines[best])) {
+				best = l;
+			}
+		}
+		return best;
+	case ROUTE_P2C:
+		/* Two different lines, the first one on a tie */
+		best = sim_draw(&day->route_rng, &day->pick);
+		l = sim_draw(&day->route_rng, &day->pick_other);
+		if (l >= best) l++;
+		if (customer_q_depth(&day->lines[l])
+				< customer_q_depth(&day->lines[best])) {
+			best = l;
+		}
+		return best;
+	default:
+		/* The line of the customer's kind, drawn by the mix */
+		kind = rng_next(&day->route_rng);
+		while (best < day->n_lines - 1 && kind >= sc->mix_cut[best]) {
+			best++;
+		}
+		return best;
+	}
+}
+
+/*
+ * Lets a customer into the bank: into the line the customer picks, or on to
+ * the next branch if that line is too long (unless the customer was
+ * transferred already).
+ */
+static void des_enter(struct des_day *day, int cid, int may_transfer)
+{
+	const struct scenario *sc = SCENARIO(day->sc);
+	int l = des_route(day);
+	struct customer_q *line = &day->lines[l];
+
+	/* Transfers must arrive before the other branch closes */
+	int there = day->now + sc->transfer_sec;
+	if (may_transfer && day->xfer != NULL && sc->transfer_at > 0
+			&& customer_q_depth(line) >= sc->transfer_at
+			&& sc->sec_close - there > 0
+			&& day->xfer(day->xfer_arg, there,
+					day->store->time_with_teller[cid])) {
+		des_log(day, "customer %03d leaves for the next branch.\n",
+				cid);
+		day->counts.xfer_out++;
+		return;
+	}
+
+	day->store->enqueue_sec[cid] = day->now;
+	if (customer_q_push(line, cid) == -1) {
+		/* The customer is turned away, never to be served */
+		perror("CON> Error growing the line");
+		return;
+	}
+	if (day->n_lines == 1) {
+		des_log(day, "customer %03d enters the teller line.\n", cid);
+	} else {
+		des_log(day, "customer %03d enters teller line %d.\n",
+				cid, l + 1);
+	}
+
+	des_wake_idle(day, l, 1);
+}
+
+/*
+ * Closes the bank: plugs the lines such that idle tellers don't wait
+ * forever.
+ */
+static void des_close(struct des_day *day)
+{
+	int l;
+	for (l = 0; l < day->n_lines; l++) customer_q_plug(&day->lines[l]);
+	des_wake_idle(day, -1, SCENARIO(day->sc)->n_tellers);
+	des_log(day, "bank closes.\n");
+}
+
+/*
+ * Handles a customer's arrival: let the customer in, and either schedule the
+ * next arrival or close the bank.
+ */
+static void des_arrival(struct des_day *day)
+{
+	const struct scenario *sc = SCENARIO(day->sc);
+	int next = customer_store_make(day->store, day->cur_cid++);
+	if (next != -1) {
+		day->store->time_with_teller[next] = day->transt[next];
+		des_log(day, "customer %03d enters the bank.\n", next);
+
+		des_enter(day, next, 1);
+	}
+
+	if (sc->sec_close - day->now > 0 && day->cur_cid < day->max_cust) {
+		int arrival = day->arrive[day->cur_cid];
+		des_schedule(day, day->now + arrival, EV_ARRIVAL, -1, 0);
+	} else if (day->xfer != NULL && sc->sec_close - day->now > 0) {
+		/* Transferred customers may still come */
+		des_schedule(day, sc->sec_close, EV_CLOSE, -1, 0);
+	} else {
+		des_close(day);
+	}
+}
+
+/*
+ * Handles the arrival of the customer injected as number inj. Injected
+ * customers are numbered after the day's own ones.
+ */
+static void des_transfer_in(struct des_day *day, int inj)
+{
+	int cid = customer_store_make(day->store, day->max_cust + inj);
+	if (cid == -1) return;
+
+	day->store->time_with_teller[cid] = day->inj_transt[inj];
+	des_log(day, "customer %03d enters the bank from another branch.\n",
+			cid);
+
+	des_enter(day, cid, 0);
+}
+
+/*
+ * Fires an event.
+ */
+static void des_fire(struct des_day *day, const struct event *ev)
+{
+	day->now = ev->sec;
+
+	switch (ev->type)
+	{
+	case EV_ARRIVAL:
+		des_arrival(day);
+		return;
+	case EV_TRANSFER:
+		des_transfer_in(day, ev->tid);
+		return;
+	case EV_CLOSE:
+		des_close(day);
+		return;
+	case EV_SHIFT_IN:
+		des_teller_in(day, ev->tid);
+		return;
+	}
+
+	struct des_teller *t = &day->tellers[ev->tid];
+	if (ev->epoch != t->epoch) return; /* Stale wakeup */
+
+	switch (ev->type)
+	{
+	case EV_TRANS_END:
+		des_log(day, "teller %d completes transaction with customer "
+			"%03d.\n", ev->tid + 1, t->cid);
+		t->cid = -1;
+		des_teller_ready(day, ev->tid);
+		break;
+	case EV_BREAK_END:
+		if (t->lunch) {
+			des_log(day, "teller %d is back from lunch.\n",
+					ev->tid + 1);
+		} else {
+			des_log(day, "teller %d is back at work.\n",
+					ev->tid + 1);
+		}
+		roster_return(&day->roster, ev->tid);
+		trace_break(day->trace, 0, ev->tid, t->break_t0, day->now);
+		des_teller_wait(day, ev->tid);
+		break;
+	case EV_BREAK_DUE:
+		t->epoch++;
+		if (day->now >= roster_next_off(&t->duty)) {
+			des_teller_break(day, ev->tid);
+		} else {
+			des_teller_out(day, ev->tid); /* The shift is over */
+		}
+		break;
+	}
+}
+
+/**
+ * Opens a bank day in virtual time: draws its customers, and clocks its
+ * tellers in. The customers' arrivals and transaction times are drawn from
+ * stream 0 of the provided seed, teller n draws its breaks from stream n,
+ * and arrivals pick their line with stream n_tellers + 1.
+ *
+ * All the state of the day is local to it (or to the provided store), so any
+ * number of days may be simulated concurrently.
+ *
+ * Customers are kept in the provided store, which is reset before the day
+ * starts. Its columns describe the day once it is closed, and stay valid
+ * until the store is reset. If no store is provided, a temporary one is
+ * used.
+ *
+ * Params: sc      - the bank to simulate
+ *         seed    - the seed for the day's random choices
+ *         verbose - print the SIM> line for every event if set
+ *         store   - the store to keep customers in, or NULL
+ *         trace   - if not NULL, the day is recorded into it (as its
+ *                   recording thread 0)
+ * Return: the day, or NULL if it could not be allocated
+ */
+struct des_day *des_day_open(const struct scenario *sc, uint64_t seed,
+		int verbose, struct customer_store *store, struct trace *trace)
+{
+	sc = SCENARIO(sc);
+
+	struct des_day *day = calloc(1, sizeof(struct des_day));
+	if (day == NULL) return NULL;
+
+	if (store == NULL) {
+		customer_store_init(&day->tmp_store);
+		store = &day->tmp_store;
+	}
+	customer_store_reset(store);
+
+	day->tellers = calloc(sc->n_tellers, sizeof(struct des_teller));
+	day->max_cust = scenario_max_customers(sc);
+	day->arrive = malloc(2 * day->max_cust * sizeof(int));
+	if (day->tellers == NULL || day->arrive == NULL
+			|| customer_store_reserve(store, day->max_cust) == -1
+			|| roster_init(&day->roster, sc) == -1) {
+		goto fail;
+	}
+	day->transt = day->arrive + day->max_cust;
+	scenario_draw_day(sc, seed, day->arrive, day->transt);
+
+	day->sc = sc;
+	if (event_q_init(&day->events) == -1) goto fail_events;
+	bank_stats_init(&day->stats);
+	day->n_lines = sc->n_queues;
+	int l;
+	for (l = 0; l < day->n_lines; l++) {
+		if (customer_q_init(&day->lines[l]) == -1) goto fail_lines;
+	}
+	rng_seed(&day->route_rng, seed, sc->n_tellers + 1);
+	if (day->n_lines > 1) {
+		sim_range_init(&day->pick, 0, day->n_lines - 1);
+		sim_range_init(&day->pick_other, 0, day->n_lines - 2);
+	}
+	day->store = store;
+	day->now = sc->sec_open;
+	day->verbose = verbose;
+	day->trace = trace;
+
+	des_log(day, "bank opens.\n");
+	if (sc->sec_close - day->now > 0) {
+		int arrival = day->arrive[0];
+		des_schedule(day, day->now + arrival, EV_ARRIVAL, -1, 0);
+	}
+
+	int tid;
+	for (tid = 0; tid < sc->n_tellers; tid++) {
+		struct des_teller *t = &day->tellers[tid];
+		t->home = tid % day->n_lines;
+		rng_seed(&t->rng, seed, tid + 1);
+
+		roster_duty_init(sc, tid, &t->duty);
+		if (t->duty.sec_in - day->now > 0) {
+			t->state = TS_OUT;
+			des_schedule(day, t->duty.sec_in, EV_SHIFT_IN, tid, 0);
+		} else {
+			des_teller_in(day, tid);
+		}
+	}
+	if (day->failed) goto fail_lines;
+
+	return day;
+
+	/* Undo what was set up, latest first */
+fail_lines:
+	while (l-- > 0) customer_q_destroy(&day->lines[l]);
+	event_q_free(&day->events);
+fail_events:
+	roster_destroy(&day->roster);
+fail:
+	customer_store_destroy(&day->tmp_store);
+	free(day->tellers);
+	free(day->arrive);
+	free(day);
+	return NULL;
+}
+
+/**
+ * Links a day into a region: arrivals which find their line transfer_at
+ * customers long are handed to fn, and the day is injected the customers of
+ * another branch with des_day_inject(). Link a day before advancing it.
+ *
+ * Params: day - the day to link
+ *         fn  - hands customers on to the next branch
+ *         arg - passed to fn
+ * Return: void
+ */
+void des_day_transfer(struct des_day *day, des_transfer_fn fn, void *arg)
+{
+	day->xfer = fn;
+	day->xfer_arg = arg;
+}
+
+/**
+ * Fires the events of a day which happen before second until.
+ *
+ * Params: day   - the day to advance
+ *         until - the first second not to simulate
+ * Return: 1 if events are left to fire, 0 if the day is over (or failed,
+ *         see des_schedule())
+ */
+int des_day_advance(struct des_day *day, int until)
+{
+	struct event ev;
+	while (!day->failed && event_q_peek(&day->events, &ev)
+			&& ev.sec < until) {
+		event_q_pop(&day->events, &ev);
+		des_fire(day, &ev);
+	}
+	return !day->failed && day->events.len > 0;
+}
+
+/**
+ * Injects a customer from another branch, who arrives at second sec. The day
+ * must not have been advanced past sec.
+ *
+ * Params: day    - the day to inject into
+ *         sec    - the second the customer arrives
+ *         transt - the length of the customer's transaction
+ * Return: 0 on success, -1 if the customer could not be stored
+ */
+int des_day_inject(struct des_day *day, int sec, int transt)
+{
+	if (day->n_inj == day->cap_inj) {
+		int cap = day->cap_inj ? 2 * day->cap_inj : 64;
+		int *grown = realloc(day->inj_transt, cap * sizeof(int));
+		if (grown == NULL) return -1;
+		day->inj_transt = grown;
+		day->cap_inj = cap;
+	}
+
+	day->inj_transt[day->n_inj] = transt;
+	if (event_q_push(&day->events, sec, EV_TRANSFER, day->n_inj,
+			0) == -1) {
+		return -1;
+	}
+	day->n_inj++;
+	day->counts.xfer_in++;
+	return 0;
+}
+
+/**
+ * Closes a day, computes its business metrics, and frees it.
+ *
+ * Params: day    - the day to close
+ *         met    - storage for the day's business metrics
+ *         pool   - if not NULL, the day's measurements are merged into it
+ *         counts - if not NULL, storage for what happened to the customers
+ * Return: void
+ */
+void des_day_close(struct des_day *day, struct bank_metrics *met,
+		struct bank_stats *pool, struct des_counts *counts)
+{
+	int l, max_depth = 0;
+	for (l = 0; l < day->n_lines; l++) {
+		int depth = customer_q_max_depth(&day->lines[l]);
+		if (depth > max_depth) max_depth = depth;
+		customer_q_destroy(&day->lines[l]);
+	}
+
+	metrics_from_stats(&day->stats, max_depth, met);
+	if (pool) bank_stats_merge(pool, &day->stats);
+	if (counts) *counts = day->counts;
+
+	if (day->store == &day->tmp_store) {
+		customer_store_destroy(&day->tmp_store);
+	}
+	free(day->inj_transt);
+	free(day->arrive);
+	free(day->tellers);
+	roster_destroy(&day->roster);
+	event_q_free(&day->events);
+	free(day);
+}
+
+/**
+ * Simulates one bank day in virtual time and computes its business metrics,
+ * as des_day_open(), des_day_advance() to the end, and des_day_close() do.
+ *
+ * Params: sc      - the bank to simulate
+ *         seed    - the seed for the day's random choices
+ *         verbose - print the SIM> line for every event if set
+ *         store   - the store to keep customers in, or NULL
+ *         met     - storage for the day's business metrics
+ *         pool    - if not NULL, the day's measurements are merged into it
+ *         trace   - if not NULL, the day is recorded into it (as its
+ *                   recording thread 0)
+ * Return: void
+ */
+void des_run_day(const struct scenario *sc, uint64_t seed, int verbose,
+		struct customer_store *store, struct bank_metrics *met,
+		struct bank_stats *pool, struct trace *trace)
+{
+	struct des_day *day = des_day_open(sc, seed, verbose, store, trace);
+	if (day == NULL) {
+		struct bank_stats none;
+		bank_stats_init(&none);
+		metrics_from_stats(&none, 0, met);
+		return;
+	}
+
+	/* Jump from event to event until nothing is left to happen */
+	des_day_advance(day, INT_MAX);
+	des_day_close(day, met, pool, NULL);
+}
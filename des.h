@@ -0,0 +1,60 @@
+#ifndef DES_H_
+#define DES_H_
+
+/*
+ * Proj: 4
+ * File: des.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the discrete-event simulation
+ * module. Instead of pacing simulated seconds against the wall clock, this
+ * module jumps a single simulated clock straight from one event (arrival,
+ * transaction end, break start or end) to the next. A whole bank day runs in
+ * microseconds, while modelling the same bank as the threaded simulation.
+ *
+ * des_run_day() simulates a day in one go. A day may also be opened, advanced
+ * a window of simulated time at a time, and closed: this is how the branches
+ * of a region (see region.h) run side by side, handing customers to each
+ * other between windows.
+ */
+
+#include "customer_store.h"
+#include "metrics.h"
+#include "scenario.h"
+#include "trace.h"
+
+struct des_day; /* A day being simulated */
+
+/*
+ * What happened to the customers of a day, beyond its metrics.
+ */
+struct des_counts
+{
+	long served; /* Customers who were served */
+	long stolen; /* Of those, served by a teller of another line */
+	long xfer_out; /* Customers sent on to the next branch */
+	long xfer_in; /* Customers received from another branch */
+};
+
+/*
+ * Hands a customer who would enter a too long line to the next branch: the
+ * customer arrives there at second sec, for a transaction of transt seconds.
+ * Returns 1 if the customer was taken, or 0 if the customer has to stay.
+ */
+typedef int (*des_transfer_fn)(void *arg, int sec, int transt);
+
+void des_run_day(const struct scenario *sc, uint64_t seed, int verbose,
+		struct customer_store *store, struct bank_metrics *met,
+		struct bank_stats *pool, struct trace *trace);
+
+struct des_day *des_day_open(const struct scenario *sc, uint64_t seed,
+		int verbose, struct customer_store *store, struct trace *trace);
+void des_day_transfer(struct des_day *day, des_transfer_fn fn, void *arg);
+int des_day_advance(struct des_day *day, int until);
+int des_day_inject(struct des_day *day, int sec, int transt);
+void des_day_close(struct des_day *day, struct bank_metrics *met,
+		struct bank_stats *pool, struct des_counts *counts);
+
+#endif
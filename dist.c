@@ -0,0 +1,382 @@
+/*
+ * Proj: 4
+ * File: dist.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in dist.h. Draws are made in
+ * bulk: the random bits of a chunk of draws are generated at once (see
+ * rng_bulk_fill()), and then mapped through the distribution's table in a
+ * loop with no branch but the loop's own.
+ *
+ * Quantile tables hold the quantiles at the middle of DIST_TABLE_LEN equally
+ * likely slices, so the top DIST_TABLE_BITS bits of a draw pick a slice. The
+ * tail beyond the last slice's middle (for the exponential, beyond 7.6
+ * means) is cut off; at whole seconds, nothing else is lost.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "dist.h"
+
+#define DIST_CHUNK 256 /* Draws dist_fill() generates at once */
+#define DIST_SLICE(X) ((X) >> (32 - DIST_TABLE_BITS)) /* A draw's slice */
+
+static const char *dist_names[] = { "uniform", "exp", "lognormal",
+	"empirical", "piecewise" };
+
+/*
+ * The quantile function of the standard normal distribution, by Acklam's
+ * rational approximation (relative error below 1.15e-9).
+ */
+static double dist_norm_quantile(double p)
+{
+	static const double a[] = { -3.969683028665376e+01,
+		2.209460984245205e+02, -2.759285104469687e+02,
+		1.383577518672690e+02, -3.066479806614716e+01,
+		2.506628277459239e+00 };
+	static const double b[] = { -5.447609879822406e+01,
+		1.615858368580409e+02, -1.556989798598866e+02,
+		6.680131188771972e+01, -1.328068155288572e+01 };
+	static const double c[] = { -7.784894002430293e-03,
+		-3.223964580411365e-01, -2.400758277161838e+00,
+		-2.549732539343734e+00, 4.374664141464968e+00,
+		2.938163982698783e+00 };
+	static const double d[] = { 7.784695709041462e-03,
+		3.224671290700398e-01, 2.445134137142996e+00,
+		3.754408661907416e+00 };
+	double q, r, num, den;
+
+	if (p > 1 - 0.02425) return -dist_norm_quantile(1 - p);
+
+	if (p < 0.02425) {
+		/* The lower tail */
+		q = sqrt(-2 * log(p));
+		num = ((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4])
+				* q + c[5];
+		den = (((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1;
+		return num / den;
+	}
+
+	q = p - 0.5;
+	r = q * q;
+	num = ((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r
+			+ a[5];
+	den = ((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r
+			+ 1;
+	return num * q / den;
+}
+
+/*
+ * The probability in the middle of slice i of the quantile table.
+ */
+static double dist_slice_p(int i)
+{
+	return (i + 0.5) / DIST_TABLE_LEN;
+}
+
+/*
+ * Builds the alias table of a histogram (Vose's method). Every column holds
+ * its own bin's value with probability alias_prob / 2^32, and the value of
+ * another bin otherwise.
+ */
+static const char *dist_build_alias(struct dist *d)
+{
+	double scaled[DIST_MAX_BINS], sum = 0;
+	int small[DIST_MAX_BINS], large[DIST_MAX_BINS];
+	int n = d->n_bins, n_small = 0, n_large = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (!(d->bin_weight[i] > 0)) return "weights must be positive";
+		sum += d->bin_weight[i];
+	}
+
+	for (i = 0; i < n; i++) {
+		scaled[i] = d->bin_weight[i] * n / sum;
+		if (scaled[i] < 1) {
+			small[n_small++] = i;
+		} else {
+			large[n_large++] = i;
+		}
+	}
+
+	while (n_small > 0 && n_large > 0) {
+		int s = small[--n_small];
+		int l = large[--n_large];
+
+		d->alias_prob[s] = (uint32_t) (scaled[s] * 4294967296.0);
+		d->alias[s] = d->bin_value[l];
+
+		/* The large bin gave away what fills up the small column */
+		scaled[l] -= 1 - scaled[s];
+		if (scaled[l] < 1) {
+			small[n_small++] = l;
+		} else {
+			large[n_large++] = l;
+		}
+	}
+
+	/* The rest are full columns (up to rounding) */
+	while (n_large > 0) {
+		int l = large[--n_large];
+		d->alias_prob[l] = UINT32_MAX;
+		d->alias[l] = d->bin_value[l];
+	}
+	while (n_small > 0) {
+		int s = small[--n_small];
+		d->alias_prob[s] = UINT32_MAX;
+		d->alias[s] = d->bin_value[s];
+	}
+
+	return NULL;
+}
+
+/*
+ * Builds the piece lookup of a piecewise rate: the mean gap of every piece,
+ * and the piece every minute of the day falls into. Minutes before the
+ * first piece starts belong to the first piece.
+ */
+static const char *dist_build_pieces(struct dist *d)
+{
+	int i, m;
+
+	for (i = 0; i < d->n_bins; i++) {
+		if (!(d->bin_weight[i] > 0)) return "rates must be positive";
+		if (i > 0 && d->bin_value[i] <= d->bin_value[i - 1]) {
+			return "rates must be given in order of time";
+		}
+		d->piece_mean[i] = (float) (3600 / d->bin_weight[i]);
+	}
+
+	int piece = 0;
+	for (m = 0; m < DIST_MINUTES; m++) {
+		while (piece + 1 < d->n_bins
+				&& d->bin_value[piece + 1] <= m * 60) {
+			piece++;
+		}
+		d->piece_of_min[m] = (unsigned char) piece;
+	}
+
+	return NULL;
+}
+
+/**
+ * Checks a distribution's parameters, and builds its sampling table.
+ *
+ * Params: d - the distribution
+ * Return: NULL on success, or what is wrong with the parameters
+ */
+const char *dist_build(struct dist *d)
+{
+	struct sim_range *r = &d->range;
+	int i;
+
+	switch (d->kind)
+	{
+	case DIST_UNIFORM:
+		if (r->lo + SIM_CHOOSE_HI_EXCLUSIVE > r->hi) {
+			return "a lower bound exceeds its upper bound";
+		}
+		sim_range_init(r, r->lo, r->hi);
+		return NULL;
+	case DIST_EXP:
+		if (!(d->mean > 0)) return "the mean must be positive";
+		for (i = 0; i < DIST_TABLE_LEN; i++) {
+			d->table[i] = (float) (-d->mean
+					* log(1 - dist_slice_p(i)));
+		}
+		return NULL;
+	case DIST_LOGNORMAL:
+		if (!(d->mean > 0) || !(d->sd > 0)) {
+			return "the mean and sd must be positive";
+		} else {
+			double s2 = log(1 + (d->sd * d->sd)
+					/ (d->mean * d->mean));
+			double mu = log(d->mean) - s2 / 2;
+			for (i = 0; i < DIST_TABLE_LEN; i++) {
+				double z = dist_norm_quantile(dist_slice_p(i));
+				d->table[i] = (float) exp(mu + sqrt(s2) * z);
+			}
+		}
+		return NULL;
+	case DIST_EMPIRICAL:
+		if (d->n_bins < 1) return "the histogram has no bins";
+		return dist_build_alias(d);
+	case DIST_PIECEWISE:
+		if (d->n_bins < 1) return "no rates are given";
+		for (i = 0; i < DIST_TABLE_LEN; i++) {
+			d->table[i] = (float) -log(1 - dist_slice_p(i));
+		}
+		return dist_build_pieces(d);
+	}
+
+	return "unknown distribution";
+}
+
+/*
+ * Rounds a table entry to whole seconds, at least one.
+ */
+static inline int dist_round(float f)
+{
+	int v = (int) (f + 0.5f);
+	return v < 1 ? 1 : v;
+}
+
+/**
+ * Fills an array with draws from a distribution. For DIST_PIECEWISE, the
+ * draws are consecutive arrival gaps, the first one starting at second t0;
+ * all other distributions ignore t0.
+ *
+ * Params: d   - the (built) distribution
+ *         b   - the bulk generator to draw with
+ *         out - storage for n draws
+ *         n   - the number of draws
+ *         t0  - the second the first gap starts (DIST_PIECEWISE)
+ * Return: void
+ */
+void dist_fill(const struct dist *d, struct rng_bulk *b, int *out, size_t n,
+		int t0)
+{
+	if (d->kind == DIST_UNIFORM) {
+		sim_draw_n(b, &d->range, out, n);
+		return;
+	}
+
+	uint32_t x[DIST_CHUNK];
+	int t = t0;
+	size_t i;
+	for (i = 0; i < n; i += DIST_CHUNK) {
+		size_t len = min(n - i, (size_t) DIST_CHUNK);
+		int *o = out + i;
+		size_t j;
+
+		rng_bulk_fill(b, x, len);
+
+		switch (d->kind)
+		{
+		case DIST_EXP:
+		case DIST_LOGNORMAL:
+			for (j = 0; j < len; j++) {
+				o[j] = dist_round(d->table[DIST_SLICE(x[j])]);
+			}
+			break;
+		case DIST_EMPIRICAL:
+			/* The high bits pick a column, the low bits a value */
+			for (j = 0; j < len; j++) {
+				uint64_t m = (uint64_t) x[j] * d->n_bins;
+				int col = (int) (m >> 32);
+				int own = (uint32_t) m < d->alias_prob[col];
+				o[j] = own ? d->bin_value[col] : d->alias[col];
+			}
+			break;
+		case DIST_PIECEWISE:
+			/* Each gap is scaled to the rate when it starts */
+			for (j = 0; j < len; j++) {
+				int min = min(t / 60, DIST_MINUTES - 1);
+				float q = d->table[DIST_SLICE(x[j])];
+				q *= d->piece_mean[d->piece_of_min[min]];
+				o[j] = dist_round(q);
+				t += o[j];
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * The number of consecutive draws which surely cover the seconds from t0 to
+ * t1, when the draws are arrival gaps. Draws which never fall under a
+ * second need at most one per second. Unbounded distributions are covered
+ * by twice the expected number of arrivals, plus 64: more than that happen
+ * with a probability far below anything a simulation will ever see.
+ *
+ * Params: d  - the (built) distribution
+ *         t0 - the first second
+ *         t1 - the last second
+ * Return: the number of draws
+ */
+int dist_max_count(const struct dist *d, int t0, int t1)
+{
+	int lo = d->kind == DIST_UNIFORM ? (int) d->range.lo : 1;
+	int hard = (t1 - t0) / (lo > 0 ? lo : 1) + 1;
+	if (d->kind == DIST_UNIFORM) return hard;
+
+	double expected = 0;
+	int i;
+	switch (d->kind)
+	{
+	case DIST_EXP:
+	case DIST_LOGNORMAL:
+		expected = (t1 - t0) / d->mean;
+		break;
+	case DIST_EMPIRICAL:
+		{
+			double sum = 0, weights = 0;
+			for (i = 0; i < d->n_bins; i++) {
+				sum += d->bin_value[i] * d->bin_weight[i];
+				weights += d->bin_weight[i];
+			}
+			if (sum > 0) expected = (t1 - t0) / (sum / weights);
+		}
+		break;
+	case DIST_PIECEWISE:
+		for (i = t0 / 60; i <= t1 / 60 && i < DIST_MINUTES; i++) {
+			expected += 60 / d->piece_mean[d->piece_of_min[i]];
+		}
+		break;
+	}
+
+	double soft = 2 * expected + 64;
+	return soft < hard ? (int) soft : hard;
+}
+
+/**
+ * Describes a distribution in a few words, e.g. "exp, mean 150 s".
+ *
+ * Params: d     - the distribution
+ *         buf   - storage for the description
+ *         count - num chars in buf
+ * Return: void
+ */
+void dist_describe(const struct dist *d, char *buf, size_t count)
+{
+	switch (d->kind)
+	{
+	case DIST_UNIFORM:
+		snprintf(buf, count, "%u-%u s", d->range.lo, d->range.hi);
+		break;
+	case DIST_EXP:
+		snprintf(buf, count, "exp, mean %.0f s", d->mean);
+		break;
+	case DIST_LOGNORMAL:
+		snprintf(buf, count, "lognormal, mean %.0f s, sd %.0f s",
+				d->mean, d->sd);
+		break;
+	case DIST_EMPIRICAL:
+		snprintf(buf, count, "empirical, %d bins", d->n_bins);
+		break;
+	case DIST_PIECEWISE:
+		snprintf(buf, count, "piecewise, %d rates", d->n_bins);
+		break;
+	}
+}
+
+/**
+ * Looks up a distribution kind by name ("uniform", "exp", "lognormal",
+ * "empirical" or "piecewise").
+ *
+ * Params: name - the name
+ * Return: the DIST_ kind, or -1 if there is no such kind
+ */
+int dist_kind(const char *name)
+{
+	int k;
+	for (k = 0; k < (int) (sizeof(dist_names) / sizeof(dist_names[0]));
+			k++) {
+		if (strcmp(dist_names[k], name) == 0) return k;
+	}
+	return -1;
+}
@@ -0,0 +1,82 @@
+#ifndef DIST_H_
+#define DIST_H_
+
+/*
+ * Proj: 4
+ * File: dist.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the distributions customers'
+ * arrival gaps and transaction times are drawn from. A distribution is
+ * configured by a scenario (see scenario.c), and dist_build() turns its
+ * parameters into a sampling table once, such that every draw afterwards is
+ * a table lookup without branches:
+ *
+ *  - DIST_UNIFORM:   every second from lo to hi is equally likely (drawn
+ *                    with Lemire's method, see sim_draw())
+ *  - DIST_EXP:       exponential with the given mean, i.e. Poisson arrivals;
+ *                    an inverse-CDF table of DIST_TABLE_LEN quantiles
+ *  - DIST_LOGNORMAL: lognormal with the given mean and standard deviation;
+ *                    an inverse-CDF table as well
+ *  - DIST_EMPIRICAL: a histogram of values with weights; an alias table
+ *                    (Walker, as built by Vose), one column per bin
+ *  - DIST_PIECEWISE: exponential arrival gaps whose rate changes over the
+ *                    day (e.g. a lunch-hour peak); the unit exponential table
+ *                    scaled by the mean gap of the piece of the day the
+ *                    previous arrival fell into
+ *
+ * Table based draws are rounded to whole seconds, and are at least a second.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sim.h"
+
+#define DIST_UNIFORM 0
+#define DIST_EXP 1
+#define DIST_LOGNORMAL 2
+#define DIST_EMPIRICAL 3
+#define DIST_PIECEWISE 4
+
+#define DIST_TABLE_BITS 10 /* Random bits indexing a quantile table */
+#define DIST_TABLE_LEN (1 << DIST_TABLE_BITS)
+#define DIST_MAX_BINS 64 /* Most bins of a histogram, or pieces of a day */
+#define DIST_MINUTES (24 * 60) /* Minutes of a day */
+
+struct dist
+{
+	int kind; /* One of the DIST_ kinds above */
+
+	/* The parameters, as configured */
+	struct sim_range range; /* DIST_UNIFORM: the bounds */
+	double mean; /* DIST_EXP, DIST_LOGNORMAL: the mean, in seconds */
+	double sd; /* DIST_LOGNORMAL: the standard deviation, in seconds */
+	int n_bins; /* DIST_EMPIRICAL: bins, DIST_PIECEWISE: pieces */
+	int bin_value[DIST_MAX_BINS]; /* A bin's value, or a piece's start */
+	double bin_weight[DIST_MAX_BINS]; /* A bin's weight, or arrivals/hour */
+
+	/* The sampling tables, built by dist_build() */
+	float table[DIST_TABLE_LEN]; /* Quantiles (of mean 1 if piecewise) */
+	uint32_t alias_prob[DIST_MAX_BINS]; /* Below it, a column's own value */
+	int alias[DIST_MAX_BINS]; /* A column's other value */
+	float piece_mean[DIST_MAX_BINS]; /* A piece's mean gap, in seconds */
+	unsigned char piece_of_min[DIST_MINUTES]; /* A minute's piece */
+};
+
+/*
+ * The initializer of a uniform distribution from LO to HI seconds.
+ */
+#define DIST_UNIFORM_INIT(LO, HI) { .kind = DIST_UNIFORM, \
+		.range = SIM_RANGE(LO, HI) }
+
+const char *dist_build(struct dist *d);
+void dist_fill(const struct dist *d, struct rng_bulk *b, int *out, size_t n,
+		int t0);
+
+int dist_max_count(const struct dist *d, int t0, int t1);
+void dist_describe(const struct dist *d, char *buf, size_t count);
+int dist_kind(const char *name);
+
+#endif
@@ -0,0 +1,189 @@
+/*
+ * Proj: 4
+ * File: evcount.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in evcount.h.
+ *
+ * A waiter registers itself (waiters++) before it re-checks the structure,
+ * and a notifier changes the structure before it looks for waiters. Both
+ * sides use sequentially consistent operations, so either the waiter sees the
+ * change, or the notifier sees the waiter and bumps seq. A waiter only
+ * sleeps while seq still equals its key, so the bump can't be missed.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include "evcount.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/*
+ * Sleeps while *addr == val, until woken or until the absolute
+ * (CLOCK_REALTIME) time abstime.
+ */
+static int futex_wait(volatile unsigned int *addr, unsigned int val,
+		const struct timespec *abstime)
+{
+	int op = FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG | FUTEX_CLOCK_REALTIME;
+	if (syscall(SYS_futex, addr, op, val, abstime, NULL,
+			FUTEX_BITSET_MATCH_ANY) == -1) {
+		return errno;
+	}
+	return 0;
+}
+
+/*
+ * Wakes up to n threads sleeping on addr.
+ */
+static void futex_wake(volatile unsigned int *addr, int n)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, n, NULL,
+			NULL, 0);
+}
+#endif
+
+/**
+ * Initializes an eventcount with no waiters.
+ *
+ * Params: ec - the eventcount to initialize
+ * Return: void
+ */
+void evcount_init(struct evcount *ec)
+{
+	ec->seq = 0;
+	ec->waiters = 0;
+#ifndef __linux__
+	pthread_mutex_init(&ec->mutex, NULL);
+	pthread_cond_init(&ec->cond, NULL);
+#endif
+}
+
+/**
+ * Frees the resources of an eventcount. Nobody may be waiting on it.
+ *
+ * Params: ec - the eventcount to destroy
+ * Return: void
+ */
+void evcount_destroy(struct evcount *ec)
+{
+#ifndef __linux__
+	pthread_cond_destroy(&ec->cond);
+	pthread_mutex_destroy(&ec->mutex);
+#else
+	(void) ec;
+#endif
+}
+
+/**
+ * Registers the calling thread as a waiter. Must be followed by exactly one
+ * of evcount_wait() or evcount_cancel().
+ *
+ * Params: ec - the eventcount to wait on
+ * Return: the key to pass to evcount_wait()
+ */
+unsigned int evcount_prepare(struct evcount *ec)
+{
+	__atomic_add_fetch(&ec->waiters, 1, __ATOMIC_SEQ_CST);
+	return __atomic_load_n(&ec->seq, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Unregisters the calling thread as a waiter, without waiting.
+ *
+ * Params: ec - the eventcount prepared on
+ * Return: void
+ */
+void evcount_cancel(struct evcount *ec)
+{
+	__atomic_sub_fetch(&ec->waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Parks the calling thread until a notification was made after the key was
+ * taken, or until the absolute (CLOCK_REALTIME) time abstime passes. The
+ * thread is unregistered as a waiter on return.
+ *
+ * Params: ec      - the eventcount prepared on
+ *         key     - the key returned by evcount_prepare()
+ *         abstime - when to give up waiting, or NULL to wait indefinitely
+ * Return: 0 if notified (or woken spuriously), ETIMEDOUT on timeout
+ */
+int evcount_wait(struct evcount *ec, unsigned int key,
+		const struct timespec *abstime)
+{
+	int rc = 0;
+
+#ifdef __linux__
+	if (__atomic_load_n(&ec->seq, __ATOMIC_SEQ_CST) == key) {
+		rc = futex_wait(&ec->seq, key, abstime);
+		if (rc != ETIMEDOUT) rc = 0;
+	}
+#else
+	pthread_mutex_lock(&ec->mutex);
+	while (__atomic_load_n(&ec->seq, __ATOMIC_SEQ_CST) == key
+			&& rc != ETIMEDOUT) {
+		if (abstime) {
+			rc = pthread_cond_timedwait(&ec->cond, &ec->mutex,
+					abstime);
+		} else {
+			rc = pthread_cond_wait(&ec->cond, &ec->mutex);
+		}
+	}
+	pthread_mutex_unlock(&ec->mutex);
+#endif
+
+	evcount_cancel(ec);
+	return rc == ETIMEDOUT ? ETIMEDOUT : 0;
+}
+
+/*
+ * Bumps the sequence and wakes up to n sleeping waiters, if there are any
+ * registered waiters at all.
+ */
+static void evcount_notify(struct evcount *ec, int n)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ec->waiters, __ATOMIC_SEQ_CST) == 0) return;
+
+#ifdef __linux__
+	__atomic_add_fetch(&ec->seq, 1, __ATOMIC_SEQ_CST);
+	futex_wake(&ec->seq, n);
+#else
+	pthread_mutex_lock(&ec->mutex);
+	__atomic_add_fetch(&ec->seq, 1, __ATOMIC_SEQ_CST);
+	if (n == 1) {
+		pthread_cond_signal(&ec->cond);
+	} else {
+		pthread_cond_broadcast(&ec->cond);
+	}
+	pthread_mutex_unlock(&ec->mutex);
+#endif
+}
+
+/**
+ * Wakes one waiter. Call after making the change the waiters wait for.
+ *
+ * Params: ec - the eventcount to notify
+ * Return: void
+ */
+void evcount_notify_one(struct evcount *ec)
+{
+	evcount_notify(ec, 1);
+}
+
+/**
+ * Wakes every waiter. Call after making the change the waiters wait for.
+ *
+ * Params: ec - the eventcount to notify
+ * Return: void
+ */
+void evcount_notify_all(struct evcount *ec)
+{
+	evcount_notify(ec, INT_MAX);
+}
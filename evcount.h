@@ -0,0 +1,52 @@
+#ifndef EVCOUNT_H_
+#define EVCOUNT_H_
+
+/*
+ * Proj: 4
+ * File: evcount.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the eventcount module. An
+ * eventcount lets threads park until a lock-free structure changes, without
+ * putting a lock around the structure itself. A waiter:
+ *
+ *  1. takes a key with evcount_prepare(),
+ *  2. re-checks the structure (e.g. polls the line once more),
+ *  3. parks with evcount_wait() - or calls evcount_cancel() if step 2
+ *     found something to do.
+ *
+ * A notifier changes the structure first, then calls evcount_notify_one()
+ * or evcount_notify_all(). A notification made after a waiter prepared is
+ * never lost, and notifying costs no system call while nobody waits.
+ *
+ * On Linux the waiters park on a futex. Elsewhere they park on a condition
+ * variable, which is still only signalled (never broadcast) per push.
+ */
+
+#include <time.h>
+#include <pthread.h>
+
+struct evcount
+{
+	volatile unsigned int seq; /* Bumped by every notification */
+	volatile int waiters; /* The number of prepared waiters */
+#ifndef __linux__
+	pthread_mutex_t mutex; /* Protects sleeping on cond */
+	pthread_cond_t cond; /* Where waiters sleep */
+#endif
+};
+
+void evcount_init(struct evcount *ec);
+void evcount_destroy(struct evcount *ec);
+
+unsigned int evcount_prepare(struct evcount *ec);
+void evcount_cancel(struct evcount *ec);
+int evcount_wait(struct evcount *ec, unsigned int key,
+		const struct timespec *abstime);
+
+void evcount_notify_one(struct evcount *ec);
+void evcount_notify_all(struct evcount *ec);
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Proj: 4
+ * File: event.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in event.h. The queue is a binary
+ * min-heap keyed on (sec, seq). Keying on the insertion sequence number as
+ * well as the second makes events scheduled for the same second fire in the
+ * order they were scheduled.
+ *
+ * The heap array starts small and doubles whenever it fills up. A simulated
+ * day only ever has a handful of events pending at once (one per teller plus
+ * the next arrival), so it rarely grows at all.
+ */
+
+#include <stdlib.h> /* For realloc */
+#include "event.h"
+
+#define EVENT_Q_INIT_CAP 16 /* Initial number of heap slots */
+
+/**
+ * Initializes an empty event queue.
+ *
+ * Params: eq - the event queue to initialize
+ * Return: 0 on success, -1 if the heap could not be allocated
+ */
+int event_q_init(struct event_q *eq)
+{
+	eq->heap = malloc(EVENT_Q_INIT_CAP * sizeof(struct event));
+	if (eq->heap == NULL) return -1;
+	eq->len = 0;
+	eq->cap = EVENT_Q_INIT_CAP;
+	eq->seq = 0;
+	return 0;
+}
+
+/**
+ * Frees the memory associated with an event queue. Pending events are
+ * discarded.
+ *
+ * Params: eq - the event queue to free
+ * Return: void
+ */
+void event_q_free(struct event_q *eq)
+{
+	free(eq->heap);
+	eq->heap = NULL;
+	eq->len = 0;
+	eq->cap = 0;
+}
+
+/*
+ * Determines if event a must fire before event b.
+ */
+static int event_before(const struct event *a, const struct event *b)
+{
+	if (a->sec != b->sec) return a->sec < b->sec;
+	return a->seq < b->seq;
+}
+
+/**
+ * Schedules an event. The event fires once every event ordered before it has
+ * been popped.
+ *
+ * Params: eq    - the event queue to schedule on
+ *         sec   - the simulated second at which the event fires
+ *         type  - the type of the event
+ *         tid   - the teller the event belongs to, if any
+ *         epoch - the teller's epoch at the time of scheduling
+ * Return: 0 on success, -1 if the heap is full and could not grow (the
+ *         queue is left unchanged)
+ */
+int event_q_push(struct event_q *eq, int sec, int type, int tid, int epoch)
+{
+	if (eq->len == eq->cap) {
+		struct event *heap = realloc(eq->heap,
+				2 * eq->cap * sizeof(struct event));
+		if (heap == NULL) return -1;
+		eq->heap = heap;
+		eq->cap *= 2;
+	}
+
+	struct event ev;
+	ev.sec = sec;
+	ev.seq = eq->seq++;
+	ev.type = type;
+	ev.tid = tid;
+	ev.epoch = epoch;
+
+	/* Sift the new event up from the bottom of the heap */
+	int i = eq->len++;
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (!event_before(&ev, &eq->heap[parent])) break;
+
+		eq->heap[i] = eq->heap[parent];
+		i = parent;
+	}
+	eq->heap[i] = ev;
+	return 0;
+}
+
+/**
+ * Removes the event which fires first from the queue.
+ *
+ * Params: eq - the event queue to pop from
+ *         ev - storage for the popped event
+ * Return: 1 - if an event was popped into ev
+ *         0 - if the queue is empty
+ */
+int event_q_pop(struct event_q *eq, struct event *ev)
+{
+	if (eq->len == 0) return 0;
+
+	*ev = eq->heap[0];
+
+	/* Sift the last event down from the top of the heap */
+	struct event last = eq->heap[--eq->len];
+	int i = 0;
+	while (1) {
+		int child = 2 * i + 1;
+		if (child >= eq->len) break;
+		if (child + 1 < eq->len
+				&& event_before(&eq->heap[child + 1],
+						&eq->heap[child])) {
+			child++;
+		}
+		if (!event_before(&eq->heap[child], &last)) break;
+
+		eq->heap[i] = eq->heap[child];
+		i = child;
+	}
+	eq->heap[i] = last;
+
+	return 1;
+}
+
+/**
+ * Looks at the event which fires first, without removing it.
+ *
+ * Params: eq - the event queue to look at
+ *         ev - storage for the event
+ * Return: 1 - if the queue holds an event, copied into ev
+ *         0 - if the queue is empty
+ */
+int event_q_peek(const struct event_q *eq, struct event *ev)
+{
+	if (eq->len == 0) return 0;
+
+	*ev = eq->heap[0];
+	return 1;
+}
@@ -0,0 +1,41 @@
+#ifndef EVENT_H_
+#define EVENT_H_
+
+/*
+ * Proj: 4
+ * File: event.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the event module. The module
+ * provides a priority queue of timed events (a binary min-heap ordered by the
+ * simulated second at which each event fires). It is the scheduler behind the
+ * discrete-event simulation.
+ */
+
+struct event
+{
+	int sec; /* The simulated second at which the event fires */
+	unsigned int seq; /* Insertion order, breaks ties between equal secs */
+	int type; /* Event type, defined by the user of the queue */
+	int tid; /* Index of the teller the event belongs to, if any */
+	int epoch; /* Teller epoch when scheduled, detects stale events */
+};
+
+struct event_q
+{
+	struct event *heap; /* The heap array, heap[0] fires first */
+	int len; /* Number of events currently queued */
+	int cap; /* Number of events the heap array can hold */
+	unsigned int seq; /* Next insertion sequence number */
+};
+
+int event_q_init(struct event_q *eq);
+void event_q_free(struct event_q *eq);
+
+int event_q_push(struct event_q *eq, int sec, int type, int tid, int epoch);
+int event_q_pop(struct event_q *eq, struct event *ev);
+int event_q_peek(const struct event_q *eq, struct event *ev);
+
+#endif
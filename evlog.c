@@ -0,0 +1,242 @@
+/*
+ * Proj: 4
+ * File: evlog.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in evlog.h.
+ *
+ * Each ring is only pushed by its thread and only polled by the drain, as
+ * with the channel rings of chan.c. The drain always takes the pending
+ * record with the earliest simulated second, so the lines come out in about
+ * the order the events happened. It flushes its output before it naps, so
+ * an idle simulation leaves nothing behind in the stdio buffer.
+ *
+ * Waking the drain per record (e.g. with an eventcount) would put a futex
+ * wake on every evlog_put() while the drain sleeps - which it mostly does -
+ * and made logging under a lock slower than printf() itself. Napping for
+ * EVLOG_IDLE_NS instead delays a line by about a simulated second at most.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <sched.h>
+#include "sim.h"
+#include "evlog.h"
+
+/*
+ * Formats a record into the SIM> line the simulation used to print.
+ */
+static void evlog_text(FILE *out, const struct evlog_rec *rec)
+{
+	char buf[40]; /* storage for sim_fmt_time() */
+	sim_fmt_time(buf, sizeof(buf), rec->sec);
+
+	int tid = rec->tid + 1; /* Print out a tid indexed at 1 */
+
+	switch (rec->type)
+	{
+	case EVL_BANK_OPEN:
+		fprintf(out, "%s bank opens.\n", buf);
+		break;
+	case EVL_BANK_CLOSE:
+		fprintf(out, "%s bank closes.\n", buf);
+		break;
+	case EVL_CUST_ENTER:
+		fprintf(out, "%s customer %03d enters the bank.\n", buf,
+				rec->cid);
+		break;
+	case EVL_CUST_LINE:
+		fprintf(out, "%s customer %03d enters the teller line.\n", buf,
+				rec->cid);
+		break;
+	case EVL_TELLER_IN:
+		fprintf(out, "%s teller %d clocks in.\n", buf, tid);
+		break;
+	case EVL_TELLER_OUT:
+		fprintf(out, "%s teller %d clocks out.\n", buf, tid);
+		break;
+	case EVL_BREAK_START:
+		fprintf(out, "%s teller %d went on break.\n", buf, tid);
+		break;
+	case EVL_BREAK_END:
+		fprintf(out, "%s teller %d is back at work.\n", buf, tid);
+		break;
+	case EVL_TRANS_START:
+		fprintf(out, "%s teller %d initiates transaction with "
+			"customer %03d.\n", buf, tid, rec->cid);
+		break;
+	case EVL_TRANS_END:
+		fprintf(out, "%s teller %d completes transaction with "
+			"customer %03d.\n", buf, tid, rec->cid);
+		break;
+	case EVL_NO_CUSTS:
+		fprintf(out, "%s teller %d realizes there are no customers "
+			"left to help.\n", buf, tid);
+		break;
+	case EVL_LUNCH_START:
+		fprintf(out, "%s teller %d goes to lunch.\n", buf, tid);
+		break;
+	case EVL_LUNCH_END:
+		fprintf(out, "%s teller %d is back from lunch.\n", buf, tid);
+		break;
+	case EVL_CUST_HAND:
+		fprintf(out, "%s customer %03d goes straight to teller %d.\n",
+				buf, rec->cid, tid);
+		break;
+	}
+}
+
+/*
+ * Writes out the pending record with the earliest simulated second. Returns
+ * 1 if a record was written, or 0 if every ring is empty.
+ */
+static int evlog_drain_one(struct evlog *log)
+{
+	struct evlog_ring *first = NULL;
+	const struct evlog_rec *rec = NULL;
+
+	int i;
+	for (i = 0; i < log->n_rings; i++) {
+		struct evlog_ring *r = &log->rings[i];
+		unsigned long head = r->head; /* Only the drain moves heads */
+		if (head == __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) {
+			continue;
+		}
+
+		const struct evlog_rec *cand =
+				&r->ring[head & (EVLOG_RING_LEN - 1)];
+		if (rec == NULL || cand->sec < rec->sec) {
+			first = r;
+			rec = cand;
+		}
+	}
+	if (rec == NULL) return 0;
+
+	if (log->mode == EVLOG_RAW) {
+		fwrite(rec, sizeof(struct evlog_rec), 1, log->out);
+	} else {
+		evlog_text(log->out, rec);
+	}
+
+	__atomic_store_n(&first->head, first->head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/*
+ * The drain thread. Writes out records until the log is closed and every
+ * ring is empty.
+ */
+static void *evlog_drain(void *arg)
+{
+	struct evlog *log = arg;
+	struct timespec nap;
+	nap.tv_sec = 0;
+	nap.tv_nsec = EVLOG_IDLE_NS;
+
+	while (1) {
+		if (evlog_drain_one(log)) continue;
+
+		fflush(log->out);
+
+		/* Nothing is logged after closing, so the rings stay empty */
+		if (__atomic_load_n(&log->closing, __ATOMIC_ACQUIRE)) {
+			if (evlog_drain_one(log)) continue;
+			break;
+		}
+
+		nanosleep(&nap, NULL);
+	}
+
+	return NULL;
+}
+
+/**
+ * Opens an event log for n_threads logging threads, and starts its drain
+ * thread (unless the mode is EVLOG_OFF).
+ *
+ * Params: log       - the log to open
+ *         n_threads - the number of threads that will log, numbered from 0
+ *         mode      - EVLOG_OFF, EVLOG_TEXT or EVLOG_RAW
+ *         out       - where the drain writes the records
+ * Return: 0 on success, -1 on failure
+ */
+int evlog_open(struct evlog *log, int n_threads, int mode, FILE *out)
+{
+	log->mode = mode;
+	log->out = out;
+	log->n_rings = n_threads;
+	log->rings = NULL;
+	log->closing = 0;
+	if (mode == EVLOG_OFF) return 0;
+
+	if (posix_memalign((void **) &log->rings, EVLOG_CACHE_LINE,
+			n_threads * sizeof(struct evlog_ring))) {
+		return -1;
+	}
+
+	int i;
+	for (i = 0; i < n_threads; i++) {
+		log->rings[i].tail = 0;
+		log->rings[i].head = 0;
+	}
+
+	if (pthread_create(&log->drain, NULL, evlog_drain, log)) {
+		free(log->rings);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Writes out every pending record, stops the drain thread and frees the
+ * log. No thread may log anymore.
+ *
+ * Params: log - the log to close
+ * Return: void
+ */
+void evlog_close(struct evlog *log)
+{
+	if (log->mode == EVLOG_OFF) return;
+
+	__atomic_store_n(&log->closing, 1, __ATOMIC_RELEASE);
+	pthread_join(log->drain, NULL);
+
+	free(log->rings);
+	log->rings = NULL;
+}
+
+/**
+ * Logs an event. Never waits for the drain, unless the thread already has
+ * EVLOG_RING_LEN records pending.
+ *
+ * Params: log    - the log to put the record in
+ *         thread - the logging thread's number (each thread has its own)
+ *         type   - the evlog_type of the event
+ *         sec    - the simulated second of the event
+ *         tid    - the teller involved, indexed at 0 (or -1)
+ *         cid    - the customer involved (or -1)
+ * Return: void
+ */
+void evlog_put(struct evlog *log, int thread, int type, int sec, int tid,
+		int cid)
+{
+	if (log->mode == EVLOG_OFF) return;
+
+	struct evlog_ring *r = &log->rings[thread];
+	unsigned long tail = r->tail; /* Only this thread moves the tail */
+
+	while (tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)
+			== EVLOG_RING_LEN) {
+		sched_yield(); /* Ring is full, the drain empties it */
+	}
+
+	struct evlog_rec *rec = &r->ring[tail & (EVLOG_RING_LEN - 1)];
+	rec->sec = sec;
+	rec->type = (short) type;
+	rec->tid = (short) tid;
+	rec->cid = cid;
+	__atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+}
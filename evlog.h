@@ -0,0 +1,86 @@
+#ifndef EVLOG_H_
+#define EVLOG_H_
+
+/*
+ * Proj: 4
+ * File: evlog.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the event log. Instead of
+ * formatting and printing a SIM> line on the spot, a simulation thread puts
+ * a compact record (simulated second, event type, teller id, customer id)
+ * into its own lock-free ring. A drain thread takes the records off the
+ * rings, and either formats them into the usual SIM> lines, or writes them
+ * raw. Logging then costs a thread a few stores, and never stdout's lock
+ * nor a system call: rather than being woken, the drain naps whenever it has
+ * caught up.
+ *
+ * A log opened with EVLOG_OFF (quiet mode) drops every record.
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+
+#define EVLOG_OFF 0 /* Drop every record */
+#define EVLOG_TEXT 1 /* Format records into SIM> lines */
+#define EVLOG_RAW 2 /* Write the records themselves */
+
+#define EVLOG_CACHE_LINE 64 /* Size of a cache line in bytes */
+#define EVLOG_RING_LEN 4096 /* Records a thread can have pending */
+#define EVLOG_IDLE_NS 1000000 /* How long the drain naps once caught up */
+
+enum evlog_type
+{
+	EVL_BANK_OPEN, /* The bank opens */
+	EVL_BANK_CLOSE, /* The bank closes */
+	EVL_CUST_ENTER, /* Customer cid enters the bank */
+	EVL_CUST_LINE, /* Customer cid enters the teller line */
+	EVL_TELLER_IN, /* Teller tid clocks in */
+	EVL_TELLER_OUT, /* Teller tid clocks out */
+	EVL_BREAK_START, /* Teller tid goes on break */
+	EVL_BREAK_END, /* Teller tid is back at work */
+	EVL_TRANS_START, /* Teller tid initiates a transaction with cid */
+	EVL_TRANS_END, /* Teller tid completes the transaction with cid */
+	EVL_NO_CUSTS, /* Teller tid realizes no customers are left */
+	EVL_LUNCH_START, /* Teller tid goes to lunch */
+	EVL_LUNCH_END, /* Teller tid is back from lunch */
+	EVL_CUST_HAND /* Customer cid is handed straight to teller tid */
+};
+
+struct evlog_rec
+{
+	int sec; /* The simulated second of the event */
+	short type; /* An evlog_type */
+	short tid; /* The teller's id, indexed at 0 (or -1) */
+	int cid; /* The customer's id (or -1) */
+};
+
+struct evlog_ring
+{
+	struct evlog_rec ring[EVLOG_RING_LEN]; /* The pending records */
+
+	/* The thread's and the drain's positions never share a cache line */
+	volatile unsigned long tail __attribute__((aligned(EVLOG_CACHE_LINE)));
+	volatile unsigned long head __attribute__((aligned(EVLOG_CACHE_LINE)));
+} __attribute__((aligned(EVLOG_CACHE_LINE)));
+
+struct evlog
+{
+	int mode; /* EVLOG_OFF, EVLOG_TEXT or EVLOG_RAW */
+	FILE *out; /* Where the drain writes */
+	int n_rings; /* One ring per logging thread */
+	struct evlog_ring *rings;
+
+	volatile int closing; /* Set once every logging thread is done */
+	pthread_t drain;
+};
+
+int evlog_open(struct evlog *log, int n_threads, int mode, FILE *out);
+void evlog_close(struct evlog *log);
+
+void evlog_put(struct evlog *log, int thread, int type, int sec, int tid,
+		int cid);
+
+#endif
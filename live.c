@@ -0,0 +1,386 @@
+/*
+ * Proj: 4
+ * File: live.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in live.h. The server answers
+ * one request at a time: it reads the request, copies every histogram, and
+ * writes them out in the Prometheus text exposition format (version 0.0.4).
+ * The cumulative buckets are read from the log-linear histograms, so each
+ * bucket is as precise as the histogram (see stats_count_le()).
+ *
+ * A client which resets its connection makes the server's writes fail with
+ * EPIPE. SIGPIPE is blocked in the server thread, such that the client is
+ * merely dropped rather than the whole simulation killed.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "live.h"
+
+#define LIVE_POLL_MS 200 /* How often the server looks at stop */
+
+/* The buckets of the time histograms, in simulated seconds */
+static const int live_time_le[] = {
+	1, 5, 10, 30, 60, 120, 300, 600, 1200, 1800, 3600, 7200
+};
+
+/* The buckets of the line depth histogram, in customers */
+static const int live_depth_le[] = { 0, 1, 2, 3, 5, 10, 20, 50, 100 };
+
+/*
+ * Starts an update of a slot: its sequence counter turns odd.
+ */
+static void live_slot_begin(struct live_slot *s)
+{
+	__atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/*
+ * Ends an update of a slot: its sequence counter turns even again.
+ */
+static void live_slot_end(struct live_slot *s)
+{
+	__atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Copies a slot's histograms as of some moment between updates.
+ */
+static void live_slot_read(struct live_slot *s, struct bank_stats *copy)
+{
+	unsigned int seq;
+	do {
+		while ((seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)) & 1) {
+			sched_yield(); /* The writer is in the middle of it */
+		}
+		memcpy(copy, &s->st, sizeof(*copy));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq);
+}
+
+/**
+ * Initializes the histograms of a day with n_tellers tellers. Nothing is
+ * served until live_serve() is called.
+ *
+ * Params: lv        - the live metrics to initialize
+ *         n_tellers - the number of tellers
+ * Return: 0 on success, -1 on failure
+ */
+int live_init(struct live *lv, int n_tellers)
+{
+	memset(lv, 0, sizeof(*lv));
+	lv->fd = -1;
+	lv->n_tellers = n_tellers;
+	if (posix_memalign((void **) &lv->tellers, LIVE_CACHE_LINE,
+			n_tellers * sizeof(struct live_slot))) {
+		lv->tellers = NULL;
+		return -1;
+	}
+
+	int tid;
+	for (tid = 0; tid < n_tellers; tid++) {
+		lv->tellers[tid].seq = 0;
+		bank_stats_init(&lv->tellers[tid].st);
+	}
+	bank_stats_init(&lv->line.st);
+	return 0;
+}
+
+/**
+ * Frees the histograms. The server must have been stopped.
+ *
+ * Params: lv - the live metrics to free
+ * Return: void
+ */
+void live_destroy(struct live *lv)
+{
+	free(lv->tellers);
+	lv->tellers = NULL;
+}
+
+/**
+ * Starts updating a teller's histograms. Only the stat_muncher updates them.
+ *
+ * Params: lv  - the live metrics
+ *         tid - the teller
+ * Return: the histograms to update, until live_end()
+ */
+struct bank_stats *live_begin(struct live *lv, int tid)
+{
+	live_slot_begin(&lv->tellers[tid]);
+	return &lv->tellers[tid].st;
+}
+
+/**
+ * Ends the update of a teller's histograms, started with live_begin().
+ *
+ * Params: lv  - the live metrics
+ *         tid - the teller
+ * Return: void
+ */
+void live_end(struct live *lv, int tid)
+{
+	live_slot_end(&lv->tellers[tid]);
+}
+
+/**
+ * Records the depth of the line an arrival found. Only the generator records
+ * arrivals.
+ *
+ * Params: lv      - the live metrics
+ *         sim_sec - the second of the arrival
+ *         depth   - the customers in line before the arrival
+ * Return: void
+ */
+void live_arrival(struct live *lv, int sim_sec, int depth)
+{
+	live_slot_begin(&lv->line);
+	stats_add(&lv->line.st.q, depth);
+	live_slot_end(&lv->line);
+
+	__atomic_store_n(&lv->sim_sec, sim_sec, __ATOMIC_RELAXED);
+	__atomic_store_n(&lv->depth, depth, __ATOMIC_RELAXED);
+}
+
+/**
+ * Merges the histograms of every teller, e.g. for the report of the day.
+ *
+ * Params: lv - the live metrics
+ *         st - the measurements to merge into
+ * Return: void
+ */
+void live_merge(struct live *lv, struct bank_stats *st)
+{
+	struct bank_stats copy;
+	int tid;
+	for (tid = 0; tid < lv->n_tellers; tid++) {
+		live_slot_read(&lv->tellers[tid], &copy);
+		bank_stats_merge(st, &copy);
+	}
+}
+
+/*
+ * Writes one histogram of one teller (tid -1 for none) in the text format.
+ */
+static void live_put_hist(FILE *out, const char *name, int tid,
+		const struct stats_acc *acc, const int *le, int n_le)
+{
+	char label[32] = "";
+	if (tid >= 0) snprintf(label, sizeof(label), "teller=\"%d\",", tid + 1);
+
+	int i;
+	for (i = 0; i < n_le; i++) {
+		fprintf(out, "%s_bucket{%sle=\"%d\"} %ld\n", name, label,
+				le[i], stats_count_le(acc, le[i]));
+	}
+	fprintf(out, "%s_bucket{%sle=\"+Inf\"} %ld\n", name, label, acc->n);
+
+	/* The sum and count take no trailing comma */
+	if (tid >= 0) label[strlen(label) - 1] = '\0';
+	const char *open = tid >= 0 ? "{" : "";
+	const char *close = tid >= 0 ? "}" : "";
+	fprintf(out, "%s_sum%s%s%s %.0f\n", name, open, label, close,
+			acc->mean * acc->n);
+	fprintf(out, "%s_count%s%s%s %ld\n", name, open, label, close,
+			acc->n);
+}
+
+/*
+ * Writes every metric in the text format.
+ */
+static void live_put_all(struct live *lv, FILE *out)
+{
+	static const char *names[] = {
+		"bank_queue_wait_seconds",
+		"bank_transaction_seconds",
+		"bank_teller_idle_seconds"
+	};
+	static const char *helps[] = {
+		"Simulated seconds customers waited in line.",
+		"Simulated seconds transactions lasted.",
+		"Simulated seconds tellers waited for a customer."
+	};
+	int n_le = sizeof(live_time_le) / sizeof(live_time_le[0]);
+
+	struct bank_stats *copy = malloc(lv->n_tellers * sizeof(*copy));
+	if (copy == NULL) return;
+	int tid, m;
+	for (tid = 0; tid < lv->n_tellers; tid++) {
+		live_slot_read(&lv->tellers[tid], &copy[tid]);
+	}
+
+	for (m = 0; m < 3; m++) {
+		fprintf(out, "# HELP %s %s\n# TYPE %s histogram\n", names[m],
+				helps[m], names[m]);
+		for (tid = 0; tid < lv->n_tellers; tid++) {
+			const struct stats_acc *acc = m == 0 ? &copy[tid].q
+					: m == 1 ? &copy[tid].t : &copy[tid].c;
+			live_put_hist(out, names[m], tid, acc, live_time_le,
+					n_le);
+		}
+	}
+	free(copy);
+
+	struct bank_stats line;
+	live_slot_read(&lv->line, &line);
+	fprintf(out, "# HELP bank_line_depth Customers in line as each "
+		"customer arrived.\n# TYPE bank_line_depth histogram\n");
+	live_put_hist(out, "bank_line_depth", -1, &line.q, live_depth_le,
+			sizeof(live_depth_le) / sizeof(live_depth_le[0]));
+
+	fprintf(out, "# HELP bank_line_depth_last Customers in line as the "
+		"latest customer arrived.\n# TYPE bank_line_depth_last gauge\n"
+		"bank_line_depth_last %d\n",
+			__atomic_load_n(&lv->depth, __ATOMIC_RELAXED));
+	fprintf(out, "# HELP bank_sim_second Simulated second of the latest "
+		"arrival.\n# TYPE bank_sim_second gauge\n"
+		"bank_sim_second %d\n",
+			__atomic_load_n(&lv->sim_sec, __ATOMIC_RELAXED));
+}
+
+/*
+ * Answers a request on connection c, and closes the connection.
+ */
+static void live_answer(struct live *lv, int c)
+{
+	/* Don't let a silent client hold up the server */
+	struct timeval tv = { 1, 0 };
+	setsockopt(c, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	char req[1024];
+	ssize_t len = 0, got;
+	while (len < (ssize_t) sizeof(req) - 1
+			&& (got = read(c, req + len, sizeof(req) - 1 - len))
+					> 0) {
+		len += got;
+		req[len] = '\0';
+		if (strstr(req, "\r\n\r\n") != NULL) break;
+	}
+	req[len] = '\0';
+
+	FILE *out = fdopen(c, "w");
+	if (out == NULL) {
+		close(c);
+		return;
+	}
+
+	int scraped = 0;
+	if (strncmp(req, "GET /metrics", 12) != 0
+			&& strncmp(req, "GET / ", 6) != 0) {
+		fprintf(out, "HTTP/1.0 404 Not Found\r\nContent-Type: "
+			"text/plain\r\n\r\nTry /metrics\n");
+	} else {
+		fprintf(out, "HTTP/1.0 200 OK\r\nContent-Type: text/plain; "
+			"version=0.0.4\r\n\r\n");
+		live_put_all(lv, out);
+		scraped = 1;
+	}
+	int failed = fflush(out) == EOF || ferror(out);
+	int err = errno;
+	fclose(out);
+	if (failed) {
+		/* The client went away: take the pending SIGPIPE, drop it */
+		if (err == EPIPE) {
+			sigset_t pipe;
+			struct timespec now = { 0, 0 };
+			sigemptyset(&pipe);
+			sigaddset(&pipe, SIGPIPE);
+			sigtimedwait(&pipe, NULL, &now);
+		}
+		return;
+	}
+	if (scraped) lv->n_scrapes++;
+}
+
+/*
+ * Backs the server thread.
+ */
+static void *live_main(void *arg)
+{
+	struct live *lv = arg;
+
+	sigset_t pipe;
+	sigemptyset(&pipe);
+	sigaddset(&pipe, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &pipe, NULL);
+
+	while (!__atomic_load_n(&lv->stop, __ATOMIC_ACQUIRE)) {
+		struct pollfd pfd;
+		pfd.fd = lv->fd;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, LIVE_POLL_MS) <= 0) continue;
+
+		int c = accept(lv->fd, NULL, NULL);
+		if (c == -1) continue;
+		live_answer(lv, c);
+	}
+	return NULL;
+}
+
+/**
+ * Starts serving the metrics on 127.0.0.1:port, from a thread of its own.
+ *
+ * Params: lv   - the live metrics
+ *         port - the TCP port to listen on
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int live_serve(struct live *lv, int port)
+{
+	lv->fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (lv->fd == -1) return -1;
+
+	int on = 1;
+	setsockopt(lv->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((unsigned short) port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (bind(lv->fd, (struct sockaddr *) &addr, sizeof(addr)) == -1
+			|| listen(lv->fd, 8) == -1) {
+		int err = errno;
+		close(lv->fd);
+		lv->fd = -1;
+		errno = err;
+		return -1;
+	}
+
+	lv->stop = 0;
+	if ((errno = pthread_create(&lv->thd, NULL, live_main, lv)) != 0) {
+		close(lv->fd);
+		lv->fd = -1;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Stops the server, if it was started.
+ *
+ * Params: lv - the live metrics
+ * Return: void
+ */
+void live_stop(struct live *lv)
+{
+	if (lv->fd == -1) return;
+
+	__atomic_store_n(&lv->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(lv->thd, NULL);
+	close(lv->fd);
+	lv->fd = -1;
+}
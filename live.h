@@ -0,0 +1,63 @@
+#ifndef LIVE_H_
+#define LIVE_H_
+
+/*
+ * Proj: 4
+ * File: live.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the live metrics module. While
+ * a wall-clock day runs, the stat_muncher keeps a histogram (see stats.h) of
+ * the queue, transaction and wait times of every teller, and the generator
+ * one of the depth of the line each arrival finds. A small HTTP server
+ * serves them in the Prometheus text format, on 127.0.0.1, e.g.:
+ *
+ *     curl http://127.0.0.1:9464/metrics
+ *
+ * Each histogram has a single writer, which brackets its updates with a
+ * sequence counter (a seqlock): the writer never waits, and the server
+ * copies a histogram again if it was updated while being copied.
+ */
+
+#include <pthread.h>
+#include "metrics.h"
+
+#define LIVE_CACHE_LINE 64 /* Size of a cache line in bytes */
+
+/*
+ * A histogram set and its sequence counter, odd while being updated.
+ */
+struct live_slot
+{
+	volatile unsigned int seq;
+	struct bank_stats st; /* q, t and c as in bank_stats */
+} __attribute__((aligned(LIVE_CACHE_LINE)));
+
+struct live
+{
+	struct live_slot *tellers; /* One per teller, written by stat_muncher */
+	int n_tellers; /* The number of tellers */
+	struct live_slot line; /* Depths found by arrivals, in st.q */
+	volatile int sim_sec; /* The second of the latest arrival */
+	volatile int depth; /* The depth the latest arrival found */
+
+	int fd; /* The listening socket, or -1 */
+	pthread_t thd; /* The server */
+	volatile int stop; /* Set to stop the server */
+	volatile long n_scrapes; /* Requests answered */
+};
+
+int live_init(struct live *lv, int n_tellers);
+void live_destroy(struct live *lv);
+
+int live_serve(struct live *lv, int port);
+void live_stop(struct live *lv);
+
+struct bank_stats *live_begin(struct live *lv, int tid);
+void live_end(struct live *lv, int tid);
+void live_arrival(struct live *lv, int sim_sec, int depth);
+void live_merge(struct live *lv, struct bank_stats *st);
+
+#endif
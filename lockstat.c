@@ -0,0 +1,155 @@
+/*
+ * Proj: 4
+ * File: lockstat.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in lockstat.h. Times are read
+ * from CLOCK_MONOTONIC. A site which waits releases the mutex first, which
+ * ends its hold, and takes it again afterwards like any other site.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+#include "lockstat.h"
+
+/*
+ * The current time, in nanoseconds.
+ */
+static uint64_t lockstat_now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t) t.tv_sec * 1000000000 + (uint64_t) t.tv_nsec;
+}
+
+/*
+ * Accounts the end of the current hold to the holding site.
+ */
+static void lockstat_release(struct lockstat *ls, uint64_t now)
+{
+	struct lockstat_site *s = &ls->sites[ls->holder];
+	uint64_t hold = now - ls->t_held;
+
+	s->n_hold++;
+	s->hold_ns += hold;
+	if (hold > s->hold_max) s->hold_max = hold;
+}
+
+/**
+ * Initializes the statistics of a mutex, with a name per call site.
+ *
+ * Params: ls      - the statistics to initialize
+ *         names   - the names of the call sites
+ *         n_sites - the number of call sites, up to LOCKSTAT_MAX_SITES
+ * Return: void
+ */
+void lockstat_init(struct lockstat *ls, const char *const *names,
+		int n_sites)
+{
+	memset(ls, 0, sizeof(*ls));
+	if (n_sites > LOCKSTAT_MAX_SITES) n_sites = LOCKSTAT_MAX_SITES;
+
+	int i;
+	for (i = 0; i < n_sites; i++) ls->sites[i].name = names[i];
+	ls->n_sites = n_sites;
+}
+
+/**
+ * Takes the mutex on behalf of a call site.
+ *
+ * Params: ls   - the mutex's statistics
+ *         m    - the mutex
+ *         site - the call site
+ * Return: void
+ */
+void lockstat_lock(struct lockstat *ls, pthread_mutex_t *m, int site)
+{
+	uint64_t t0 = lockstat_now();
+	pthread_mutex_lock(m);
+	uint64_t t1 = lockstat_now();
+
+	struct lockstat_site *s = &ls->sites[site];
+	s->n_acq++;
+	s->wait_ns += t1 - t0;
+	if (t1 - t0 > s->wait_max) s->wait_max = t1 - t0;
+
+	ls->holder = site;
+	ls->t_held = t1;
+}
+
+/**
+ * Releases the mutex taken with lockstat_lock().
+ *
+ * Params: ls - the mutex's statistics
+ *         m  - the mutex
+ * Return: void
+ */
+void lockstat_unlock(struct lockstat *ls, pthread_mutex_t *m)
+{
+	lockstat_release(ls, lockstat_now());
+	pthread_mutex_unlock(m);
+}
+
+/**
+ * Counts a wakeup of the holding site, which slept with the mutex released
+ * and took it again since.
+ *
+ * Params: ls        - the mutex's statistics
+ *         timed_out - set if the wait timed out
+ * Return: void
+ */
+void lockstat_woken(struct lockstat *ls, int timed_out)
+{
+	struct lockstat_site *s = &ls->sites[ls->holder];
+	s->n_cond++;
+	if (timed_out) s->n_timeout++;
+}
+
+/**
+ * Counts a wakeup of the holding site which found nothing to do.
+ *
+ * Params: ls - the mutex's statistics
+ * Return: void
+ */
+void lockstat_futile(struct lockstat *ls)
+{
+	ls->sites[ls->holder].n_futile++;
+}
+
+/**
+ * Prints the statistics of every call site on CON> lines. Waits are also
+ * given in simulated seconds, as the wall-clock simulation folds them into
+ * its simulated clock.
+ *
+ * Params: ls   - the mutex's statistics
+ *         what - the name of the mutex
+ * Return: void
+ */
+void lockstat_print(const struct lockstat *ls, const char *what)
+{
+	printf("CON> Lock statistics of %s:\n", what);
+	printf("CON> %-16s %8s %10s %10s %9s %10s %10s\n", "site", "taken",
+			"wait avg", "wait max", "wait sim", "hold avg",
+			"hold max");
+
+	int i;
+	for (i = 0; i < ls->n_sites; i++) {
+		const struct lockstat_site *s = &ls->sites[i];
+		if (s->n_acq == 0) continue;
+
+		printf("CON> %-16s %8ld %8.2fus %8.2fus %8.1fs %8.2fus "
+			"%8.2fus\n", s->name, s->n_acq,
+				s->wait_ns / 1e3 / s->n_acq, s->wait_max / 1e3,
+				(double) s->wait_ns / NSC_PER_SIM_SEC,
+				s->hold_ns / 1e3 / s->n_hold,
+				s->hold_max / 1e3);
+		if (s->n_cond > 0) {
+			printf("CON> %-16s %ld wakeups, %ld timed out, %ld "
+				"woke to nothing\n", "", s->n_cond,
+					s->n_timeout, s->n_futile);
+		}
+	}
+}
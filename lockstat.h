@@ -0,0 +1,74 @@
+#ifndef LOCKSTAT_H_
+#define LOCKSTAT_H_
+
+/*
+ * Proj: 4
+ * File: lockstat.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the lock statistics module.
+ * It measures one mutex per call site: how often the mutex was taken, how
+ * long the caller waited for it, and how long it was held. A site which
+ * sleeps between holds (e.g. a teller waiting on its bell) counts its
+ * wakeups, those which timed out, and those which found nothing to do
+ * (futile wakeups, e.g. an arrival which another teller took first).
+ *
+ * The statistics are only compiled in with -DLOCKSTAT. Otherwise the
+ * LOCKSTAT_ macros below are the plain pthread calls, and cost nothing.
+ *
+ * Every counter is updated while the measured mutex is held, so the mutex
+ * itself guards the statistics.
+ */
+
+#include <pthread.h>
+#include <time.h>
+#include <stdint.h>
+
+#define LOCKSTAT_MAX_SITES 8 /* The most call sites measured */
+
+struct lockstat_site
+{
+	const char *name; /* What the call site does */
+	long n_acq; /* Times the mutex was taken */
+	uint64_t wait_ns; /* Nanoseconds spent waiting to take it */
+	uint64_t wait_max; /* The longest wait */
+	long n_hold; /* Holds */
+	uint64_t hold_ns; /* Nanoseconds it was held */
+	uint64_t hold_max; /* The longest hold */
+	long n_cond; /* Wakeups from a wait */
+	long n_timeout; /* Wakeups which timed out */
+	long n_futile; /* Wakeups which found nothing to do */
+};
+
+struct lockstat
+{
+	struct lockstat_site sites[LOCKSTAT_MAX_SITES];
+	int n_sites; /* Sites in use */
+	int holder; /* The site holding the mutex */
+	uint64_t t_held; /* When the holder (re)took the mutex */
+};
+
+void lockstat_init(struct lockstat *ls, const char *const *names,
+		int n_sites);
+void lockstat_lock(struct lockstat *ls, pthread_mutex_t *m, int site);
+void lockstat_unlock(struct lockstat *ls, pthread_mutex_t *m);
+void lockstat_woken(struct lockstat *ls, int timed_out);
+void lockstat_futile(struct lockstat *ls);
+void lockstat_print(const struct lockstat *ls, const char *what);
+
+#ifdef LOCKSTAT
+#define LOCKSTAT_LOCK(LS, M, SITE) lockstat_lock(LS, M, SITE)
+#define LOCKSTAT_UNLOCK(LS, M) lockstat_unlock(LS, M)
+#define LOCKSTAT_WOKEN(LS, TIMED_OUT) lockstat_woken(LS, TIMED_OUT)
+#define LOCKSTAT_FUTILE(LS, FOUND_NOTHING) \
+		do { if (FOUND_NOTHING) lockstat_futile(LS); } while (0)
+#else
+#define LOCKSTAT_LOCK(LS, M, SITE) pthread_mutex_lock(M)
+#define LOCKSTAT_UNLOCK(LS, M) pthread_mutex_unlock(M)
+#define LOCKSTAT_WOKEN(LS, TIMED_OUT) ((void) 0)
+#define LOCKSTAT_FUTILE(LS, FOUND_NOTHING) ((void) 0)
+#endif
+
+#endif
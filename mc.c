@@ -0,0 +1,157 @@
+/*
+ * Proj: 4
+ * File: mc.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in mc.h. The replications are
+ * split into MC_BLOCKS blocks of consecutive replications, and each block is
+ * a task of the work-stealing pool. A block aggregates its replications in
+ * order into its own aggregate (and pools the measurements of those days),
+ * and the blocks are merged in order once the pool completes. The workers
+ * therefore share nothing while they run, which lets the driver scale with
+ * the number of cores.
+ *
+ * Merging floating point aggregates is not associative, so the grouping and
+ * order of the merges decides the last bits of the results. As the blocks do
+ * not depend on the number of workers or on which worker runs which block,
+ * a run is bit-for-bit reproducible from its seed, with any -j.
+ */
+
+#include <stdlib.h>
+#include "des.h"
+#include "region.h"
+#include "pool.h"
+#include "mc.h"
+
+#define MC_CACHE_LINE 64 /* Size of a cache line in bytes */
+#define MC_BLOCKS 256 /* The most blocks the replications are split into */
+
+/*
+ * A block's aggregate and pooled measurements, padded such that blocks never
+ * share a cache line.
+ */
+struct mc_block
+{
+	struct metrics_agg agg;
+	struct bank_stats pool;
+} __attribute__((aligned(MC_CACHE_LINE)));
+
+/*
+ * A worker's customer store, padded likewise. The store is reset by every
+ * replication, so a worker stops allocating customers from the heap after its
+ * first day.
+ */
+struct mc_slot
+{
+	struct customer_store store;
+} __attribute__((aligned(MC_CACHE_LINE)));
+
+struct mc_run
+{
+	const struct scenario *sc; /* The bank to simulate */
+	unsigned int seed; /* The seed of the whole run */
+	long reps; /* The number of replications */
+	int n_blocks; /* The number of blocks they are split into */
+	struct mc_block *blocks; /* One aggregate per block */
+	struct mc_slot *slots; /* One store per worker */
+};
+
+/*
+ * Runs replication number rep. Every replication gets a seed of its own: the
+ * seed of the run in the upper 32 bits, and the replication's number in the
+ * lower 32 bits. Replications are therefore independent of each other and of
+ * the worker they happen to run on.
+ */
+static void mc_replicate(struct mc_run *run, long rep, int worker,
+		struct mc_block *blk)
+{
+	struct bank_metrics met;
+
+	uint64_t seed = ((uint64_t) run->seed << 32) | (uint32_t) rep;
+	if (SCENARIO(run->sc)->n_branches > 1) {
+		/* The branches of the region take turns on this worker */
+		region_run_day(run->sc, seed, 1, &met, &blk->pool, NULL);
+	} else {
+		des_run_day(run->sc, seed, 0, &run->slots[worker].store, &met,
+				&blk->pool, NULL);
+	}
+
+	metrics_agg_add(&blk->agg, &met);
+}
+
+/*
+ * Runs the replications of block number b, in order.
+ */
+static void mc_run_block(long b, int worker, void *arg)
+{
+	struct mc_run *run = arg;
+	long first = run->reps * b / run->n_blocks;
+	long last = run->reps * (b + 1) / run->n_blocks;
+
+	long rep;
+	for (rep = first; rep < last; rep++) {
+		mc_replicate(run, rep, worker, &run->blocks[b]);
+	}
+}
+
+/**
+ * Simulates reps bank days in virtual time, and aggregates their metrics.
+ * The measurements of all days are pooled, e.g. for percentiles over every
+ * customer of the run.
+ *
+ * Params: sc        - the bank to simulate
+ *         reps      - the number of days to simulate
+ *         n_workers - the number of threads to simulate on
+ *         seed      - the seed of the run
+ *         agg       - storage for the aggregated metrics
+ *         pool      - storage for the pooled measurements
+ * Return: void
+ */
+void mc_run(const struct scenario *sc, long reps, int n_workers,
+		unsigned int seed, struct metrics_agg *agg,
+		struct bank_stats *pool)
+{
+	if (n_workers < 1) n_workers = 1;
+
+	struct mc_run run;
+	run.sc = sc;
+	run.seed = seed;
+	run.reps = reps;
+	run.n_blocks = reps < MC_BLOCKS ? (int) reps : MC_BLOCKS;
+
+	metrics_agg_init(agg);
+	bank_stats_init(pool);
+	if (posix_memalign((void **) &run.slots, MC_CACHE_LINE,
+			n_workers * sizeof(struct mc_slot))) {
+		return;
+	}
+	if (posix_memalign((void **) &run.blocks, MC_CACHE_LINE,
+			run.n_blocks * sizeof(struct mc_block))) {
+		free(run.slots);
+		return;
+	}
+
+	int i;
+	for (i = 0; i < n_workers; i++) {
+		customer_store_init(&run.slots[i].store);
+	}
+	for (i = 0; i < run.n_blocks; i++) {
+		metrics_agg_init(&run.blocks[i].agg);
+		bank_stats_init(&run.blocks[i].pool);
+	}
+
+	pool_run(run.n_blocks, n_workers, mc_run_block, &run);
+
+	for (i = 0; i < run.n_blocks; i++) {
+		metrics_agg_merge(agg, &run.blocks[i].agg);
+		bank_stats_merge(pool, &run.blocks[i].pool);
+	}
+	for (i = 0; i < n_workers; i++) {
+		customer_store_destroy(&run.slots[i].store);
+	}
+
+	free(run.blocks);
+	free(run.slots);
+}
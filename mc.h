@@ -0,0 +1,24 @@
+#ifndef MC_H_
+#define MC_H_
+
+/*
+ * Proj: 4
+ * File: mc.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the Monte Carlo driver. The
+ * driver simulates many independent bank days (replications) in virtual time,
+ * spread over every core of the machine, and aggregates their business
+ * metrics.
+ */
+
+#include "metrics.h"
+#include "scenario.h"
+
+void mc_run(const struct scenario *sc, long reps, int n_workers,
+		unsigned int seed, struct metrics_agg *agg,
+		struct bank_stats *pool);
+
+#endif
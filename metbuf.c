@@ -0,0 +1,135 @@
+/*
+ * Proj: 4
+ * File: metbuf.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in metbuf.h.
+ *
+ * The ring holds four batches, so the teller can keep recording while the
+ * stat_muncher works through the batches already published. Records are
+ * written past tail first, and published all at once by a release store of
+ * tail; the stat_muncher's acquire load of tail then sees all of them.
+ */
+
+#include <stdlib.h>
+#include <sched.h>
+#include "metbuf.h"
+
+/**
+ * Initializes an empty buffer.
+ *
+ * Params: mb    - the buffer to initialize
+ *         batch - the number of records per batch (1 publishes every record
+ *                 on its own)
+ * Return: 0 on success, -1 if the ring could not be allocated
+ */
+int metbuf_init(struct metbuf *mb, int batch)
+{
+	if (batch < 1) batch = 1;
+
+	unsigned long cap = 4;
+	while (cap < 4 * (unsigned long) batch) cap *= 2;
+
+	if (posix_memalign((void **) &mb->ring, METBUF_CACHE_LINE,
+			cap * sizeof(struct met_record))) {
+		return -1;
+	}
+
+	mb->mask = cap - 1;
+	mb->batch = batch;
+	mb->fill = 0;
+	mb->fill_sec = 0;
+	mb->n_records = 0;
+	mb->n_pulses = 0;
+	mb->tail = 0;
+	mb->head = 0;
+
+	return 0;
+}
+
+/**
+ * Frees the buffer. Neither the teller nor the stat_muncher may be using it.
+ *
+ * Params: mb - the buffer to destroy
+ * Return: void
+ */
+void metbuf_destroy(struct metbuf *mb)
+{
+	free(mb->ring);
+	mb->ring = NULL;
+}
+
+/**
+ * Publishes every record added so far, and tells the stat_muncher with a
+ * MET_BATCH pulse. Does nothing if there is nothing to publish.
+ *
+ * Params: mb   - the teller's buffer
+ *         ch   - the stat_muncher's channel
+ *         coid - the teller's connection to the channel
+ *         id   - identifies the buffer to the stat_muncher
+ * Return: void
+ */
+void metbuf_flush(struct metbuf *mb, struct chan *ch, int coid, int id)
+{
+	if (mb->fill == mb->tail) return;
+
+	__atomic_store_n(&mb->tail, mb->fill, __ATOMIC_RELEASE);
+	chan_send_pulse(ch, coid, MET_BATCH, id);
+	mb->n_pulses++;
+}
+
+/**
+ * Adds a record to the buffer. Ships the batch once it is full, or once its
+ * oldest record was added MET_BATCH_AGE simulated seconds ago.
+ *
+ * Params: mb      - the teller's buffer
+ *         ch      - the stat_muncher's channel
+ *         coid    - the teller's connection to the channel
+ *         id      - identifies the buffer to the stat_muncher
+ *         code    - what was measured
+ *         value   - the measurement
+ *         sim_sec - the teller's current simulated second
+ * Return: void
+ */
+void metbuf_add(struct metbuf *mb, struct chan *ch, int coid, int id,
+		int code, int value, int sim_sec)
+{
+	/* The ring is full: publish, and wait for the stat_muncher */
+	while (mb->fill - __atomic_load_n(&mb->head, __ATOMIC_ACQUIRE)
+			> mb->mask) {
+		metbuf_flush(mb, ch, coid, id);
+		sched_yield();
+	}
+
+	if (mb->fill == mb->tail) mb->fill_sec = sim_sec;
+
+	mb->ring[mb->fill & mb->mask].code = code;
+	mb->ring[mb->fill & mb->mask].value = value;
+	mb->fill++;
+	mb->n_records++;
+
+	if (mb->fill - mb->tail >= (unsigned long) mb->batch
+			|| sim_sec - mb->fill_sec >= MET_BATCH_AGE) {
+		metbuf_flush(mb, ch, coid, id);
+	}
+}
+
+/**
+ * Takes the oldest published record out of the buffer. Only the stat_muncher
+ * may take records.
+ *
+ * Params: mb  - the buffer to take from
+ *         rec - storage for the record
+ * Return: 1 if a record was taken, 0 if no published record is left
+ */
+int metbuf_take(struct metbuf *mb, struct met_record *rec)
+{
+	unsigned long head = mb->head; /* Only we move the head */
+	if (head == __atomic_load_n(&mb->tail, __ATOMIC_ACQUIRE)) return 0;
+
+	*rec = mb->ring[head & mb->mask];
+	__atomic_store_n(&mb->head, head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
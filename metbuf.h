@@ -0,0 +1,66 @@
+#ifndef METBUF_H_
+#define METBUF_H_
+
+/*
+ * Proj: 4
+ * File: metbuf.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the metric buffer module. A
+ * teller records its measurements into its own buffer, and ships them to
+ * the stat_muncher in batches: one MET_BATCH pulse tells the stat_muncher
+ * to take every record published since the last one. A batch is shipped
+ * when it is full, when a record is added MET_BATCH_AGE simulated seconds
+ * after the batch's oldest, or when the teller flushes it: before it waits
+ * for a customer, goes on a break, or disconnects.
+ *
+ * The buffer is a single-producer single-consumer ring: only its teller
+ * adds records, and only the stat_muncher takes them. With a batch length
+ * of 1, every measurement costs one pulse (one kernel call on QNX).
+ */
+
+#include "chan.h"
+
+#define MET_BATCH 1 /* Pulse code: records published, value is the buffer */
+#define MET_BATCH_LEN 32 /* Default number of records per batch */
+#define MET_BATCH_MAX 65536 /* Most records per batch */
+#define MET_BATCH_AGE 1800 /* Most simulated seconds a record is held back */
+
+#define METBUF_CACHE_LINE 64 /* Size of a cache line in bytes */
+
+struct met_record
+{
+	int code; /* What was measured, as a pulse code */
+	int value; /* The measurement */
+};
+
+struct metbuf
+{
+	struct met_record *ring; /* The records */
+	unsigned long mask; /* Number of records - 1 (a power of two) */
+	int batch; /* Records per batch */
+
+	/* Owned by the teller: records from tail to fill are unpublished */
+	unsigned long fill;
+	int fill_sec; /* Simulated second of the oldest unpublished record */
+	long n_records; /* Records added */
+	long n_pulses; /* Pulses sent to publish them */
+
+	/* The published end and the taken end never share a cache line */
+	volatile unsigned long tail
+			__attribute__((aligned(METBUF_CACHE_LINE)));
+	volatile unsigned long head
+			__attribute__((aligned(METBUF_CACHE_LINE)));
+};
+
+int metbuf_init(struct metbuf *mb, int batch);
+void metbuf_destroy(struct metbuf *mb);
+
+void metbuf_add(struct metbuf *mb, struct chan *ch, int coid, int id,
+		int code, int value, int sim_sec);
+void metbuf_flush(struct metbuf *mb, struct chan *ch, int coid, int id);
+int metbuf_take(struct metbuf *mb, struct met_record *rec);
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * Proj: 4
+ * File: metrics.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in metrics.h. This module prints
+ * the business metrics report in the MET> format used by every simulation
+ * mode, and aggregates the metrics of many replications.
+ */
+
+#include <stdio.h>
+#include <math.h> /* For sqrt */
+#include "metrics.h"
+
+/*
+ * The name and unit of each metric, in report order.
+ */
+static const char *met_names[MET_COUNT] = {
+	"Total customers serviced",
+	"Average queue time",
+	"Average transaction time",
+	"Average teller wait time",
+	"Maximum queue time",
+	"Maximum teller wait time",
+	"Maximum transaction time",
+	"Maximum queue depth"
+};
+static const char *met_units[MET_COUNT] = {
+	"   ", "(s)", "(s)", "(s)", "(s)", "(s)", "(s)", "   "
+};
+
+/**
+ * Prints the list of business metrics for a simulated day.
+ *
+ * Params: met - the metrics to print
+ * Return: void
+ */
+void metrics_print(const struct bank_metrics *met)
+{
+	puts("");
+	printf("MET> The list of buisness metrics follow:\n");
+	printf("MET>\t1 | %25s     | %d\n", "Total customers serviced",
+			met->served);
+
+	printf("MET>\t2 | %25s (s) | %d\n", "Average queue time", met->avg_q);
+	printf("MET>\t3 | %25s (s) | %d\n", "Average transaction time",
+			met->avg_t);
+	printf("MET>\t4 | %25s (s) | %d\n", "Average teller wait time",
+			met->avg_c);
+
+	printf("MET>\t5 | %25s (s) | %d\n", "Maximum queue time", met->max_q);
+	printf("MET>\t6 | %25s (s) | %d\n", "Maximum teller wait time",
+			met->max_c);
+	printf("MET>\t7 | %25s (s) | %d\n", "Maximum transaction time",
+			met->max_t);
+
+	printf("MET>\t8 | %25s     | %d\n", "Maximum queue depth",
+			met->max_depth);
+	puts("");
+}
+
+/**
+ * Initializes the accumulators of a day's measurements.
+ *
+ * Params: st - the accumulators to initialize
+ * Return: void
+ */
+void bank_stats_init(struct bank_stats *st)
+{
+	stats_init(&st->q);
+	stats_init(&st->t);
+	stats_init(&st->c);
+}
+
+/**
+ * Pools the measurements of another day into a set of accumulators.
+ *
+ * Params: st    - the accumulators to merge into
+ *         other - the accumulators to merge from
+ * Return: void
+ */
+void bank_stats_merge(struct bank_stats *st, const struct bank_stats *other)
+{
+	stats_merge(&st->q, &other->q);
+	stats_merge(&st->t, &other->t);
+	stats_merge(&st->c, &other->c);
+}
+
+/*
+ * Prints one row of the percentile report.
+ */
+static void bank_stats_print_row(const char *name,
+		const struct stats_acc *acc)
+{
+	printf("MET>\t  | %25s (s) | %6d %6d %6d | %8.1f\n", name,
+			stats_quantile(acc, 0.50), stats_quantile(acc, 0.95),
+			stats_quantile(acc, 0.99), sqrt(stats_variance(acc)));
+}
+
+/**
+ * Prints the percentiles and standard deviation of each measurement.
+ *
+ * Params: st - the measurements to print
+ * Return: void
+ */
+void bank_stats_print(const struct bank_stats *st)
+{
+	printf("MET> The distribution of the measurements follows:\n");
+	printf("MET>\t  | %25s     | %6s %6s %6s | %8s\n", "", "p50", "p95",
+			"p99", "stddev");
+	bank_stats_print_row("Queue time", &st->q);
+	bank_stats_print_row("Transaction time", &st->t);
+	bank_stats_print_row("Teller wait time", &st->c);
+	puts("");
+}
+
+/**
+ * Computes the business metrics of a day from its measurements.
+ *
+ * Params: st        - the day's measurements
+ *         max_depth - the maximum depth of the day's queue
+ *         met       - storage for the business metrics
+ * Return: void
+ */
+void metrics_from_stats(const struct bank_stats *st, int max_depth,
+		struct bank_metrics *met)
+{
+	met->served = (int) st->q.n;
+	met->avg_q = (int) st->q.mean;
+	met->avg_t = (int) st->t.mean;
+	met->avg_c = (int) st->c.mean;
+	met->max_q = st->q.n ? st->q.max : 0;
+	met->max_c = st->c.n ? st->c.max : 0;
+	met->max_t = st->t.n ? st->t.max : 0;
+	met->max_depth = max_depth;
+}
+
+/*
+ * Flattens the metrics into an array, in report order.
+ */
+static void metrics_to_array(const struct bank_metrics *met,
+		double x[MET_COUNT])
+{
+	x[0] = met->served;
+	x[1] = met->avg_q;
+	x[2] = met->avg_t;
+	x[3] = met->avg_c;
+	x[4] = met->max_q;
+	x[5] = met->max_c;
+	x[6] = met->max_t;
+	x[7] = met->max_depth;
+}
+
+/**
+ * Initializes an empty aggregate.
+ *
+ * Params: agg - the aggregate to initialize
+ * Return: void
+ */
+void metrics_agg_init(struct metrics_agg *agg)
+{
+	int i;
+	agg->n = 0;
+	for (i = 0; i < MET_COUNT; i++) {
+		agg->mean[i] = 0;
+		agg->m2[i] = 0;
+	}
+}
+
+/**
+ * Adds the metrics of one replication to an aggregate.
+ *
+ * Params: agg - the aggregate to add to
+ *         met - the metrics of the replication
+ * Return: void
+ */
+void metrics_agg_add(struct metrics_agg *agg, const struct bank_metrics *met)
+{
+	double x[MET_COUNT];
+	metrics_to_array(met, x);
+
+	agg->n++;
+
+	int i;
+	for (i = 0; i < MET_COUNT; i++) {
+		double delta = x[i] - agg->mean[i];
+		agg->mean[i] += delta / agg->n;
+		agg->m2[i] += delta * (x[i] - agg->mean[i]);
+	}
+}
+
+/**
+ * Merges another aggregate into an aggregate (Chan et al.'s parallel
+ * variance formula).
+ *
+ * Params: agg   - the aggregate to merge into
+ *         other - the aggregate to merge from
+ * Return: void
+ */
+void metrics_agg_merge(struct metrics_agg *agg,
+		const struct metrics_agg *other)
+{
+	if (other->n == 0) return;
+
+	long n = agg->n + other->n;
+
+	int i;
+	for (i = 0; i < MET_COUNT; i++) {
+		double delta = other->mean[i] - agg->mean[i];
+		agg->mean[i] += delta * other->n / n;
+		agg->m2[i] += other->m2[i]
+				+ delta * delta * agg->n * other->n / n;
+	}
+
+	agg->n = n;
+}
+
+/**
+ * Prints the mean and the 95% confidence interval half-width of each
+ * business metric in an aggregate.
+ *
+ * Params: agg - the aggregate to print
+ * Return: void
+ */
+void metrics_agg_print(const struct metrics_agg *agg)
+{
+	puts("");
+	printf("MET> The list of buisness metrics over %ld days follow:\n",
+			agg->n);
+
+	int i;
+	for (i = 0; i < MET_COUNT; i++) {
+		double ci = 0;
+		if (agg->n > 1) {
+			ci = 1.96 * sqrt(agg->m2[i] / (agg->n - 1) / agg->n);
+		}
+
+		printf("MET>\t%d | %25s %s | %10.3f +/- %.3f\n", i + 1,
+				met_names[i], met_units[i], agg->mean[i], ci);
+	}
+	puts("");
+}
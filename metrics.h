@@ -0,0 +1,76 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+/*
+ * Proj: 4
+ * File: metrics.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the metrics module. The eight
+ * business metrics reported at the end of a simulated day are collected in
+ * a single structure, such that every simulation mode reports them the same
+ * way.
+ *
+ * The metrics are computed from streaming accumulators of the three kinds of
+ * measurements, which also provide their percentiles.
+ *
+ * Many simulated days (replications) can be aggregated into means and
+ * confidence intervals of each metric.
+ */
+
+#include "stats.h"
+
+struct bank_metrics
+{
+	int served; /* Total customers serviced */
+	int avg_q; /* Average queue time (s) */
+	int avg_t; /* Average transaction time (s) */
+	int avg_c; /* Average teller wait time (s) */
+	int max_q; /* Maximum queue time (s) */
+	int max_c; /* Maximum teller wait time (s) */
+	int max_t; /* Maximum transaction time (s) */
+	int max_depth; /* Maximum queue depth */
+};
+
+void metrics_print(const struct bank_metrics *met);
+
+/*
+ * The measurements taken throughout a day (or pooled over many days).
+ */
+struct bank_stats
+{
+	struct stats_acc q; /* Time customers spent waiting in the queue */
+	struct stats_acc t; /* Time customers spent in transaction */
+	struct stats_acc c; /* Time tellers spent waiting for a customer */
+};
+
+void bank_stats_init(struct bank_stats *st);
+void bank_stats_merge(struct bank_stats *st, const struct bank_stats *other);
+void bank_stats_print(const struct bank_stats *st);
+
+void metrics_from_stats(const struct bank_stats *st, int max_depth,
+		struct bank_metrics *met);
+
+#define MET_COUNT 8 /* The number of business metrics */
+
+/*
+ * Running aggregate of the metrics of many replications. The mean and sum of
+ * squared deviations of each metric are updated with Welford's method, which
+ * allows aggregates built on different threads to be merged.
+ */
+struct metrics_agg
+{
+	long n; /* The number of replications aggregated */
+	double mean[MET_COUNT]; /* The mean of each metric */
+	double m2[MET_COUNT]; /* The sum of squared deviations of each metric */
+};
+
+void metrics_agg_init(struct metrics_agg *agg);
+void metrics_agg_add(struct metrics_agg *agg, const struct bank_metrics *met);
+void metrics_agg_merge(struct metrics_agg *agg,
+		const struct metrics_agg *other);
+void metrics_agg_print(const struct metrics_agg *agg);
+
+#endif
@@ -0,0 +1,639 @@
+/*
+ * Proj: 4
+ * File: opt.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in opt.h. The optimizer is
+ * written as "key = value" assignments separated by commas, as a scenario
+ * (see scenario.c). The keys are:
+ *
+ *   p50, p95, p99, avg, max - the service level: the most seconds (or
+ *                             minutes, e.g. "5m") a day's median, 95th or
+ *                             99th percentile, average or longest queue
+ *                             time may average. Exactly one is required.
+ *   cost                    - the cost of a teller-hour (1 by default)
+ *   tellers                 - the teller counts searched, as "lo-hi" (from
+ *                             1, or the scenario's lines, to 4 times the
+ *                             scenario's tellers by default)
+ *   breaks                  - the break policies searched, separated by
+ *                             spaces, each as "tbreak_lo-tbreak_hi/
+ *                             lbreak_lo-lbreak_hi" (e.g. "30m-60m/1m-4m";
+ *                             the scenario's own policy by default)
+ *   rosters                 - the rosters searched, separated by '|', each
+ *                             as the shifts of a scenario (e.g.
+ *                             "09:00-16:00|09:00-13:00 12:00-16:00"; the
+ *                             scenario's own roster by default)
+ *   level                   - the confidence of a verdict (0.95 default)
+ *   batch                   - days per candidate and round (16 default)
+ *   days                    - the most days per candidate (1000 default)
+ *
+ * A candidate's verdict comes from the mean of its days' metric and the
+ * normal approximation of its standard error, as the confidence intervals
+ * of the Monte Carlo driver: it meets the level once the level is above
+ * the mean with the confidence asked for, and fails once it is below it
+ * with that confidence. The days of a round are tasks of the pool, and are
+ * reduced in order once the round completes, so the outcome does not depend
+ * on the number of workers.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "des.h"
+#include "region.h"
+#include "pool.h"
+#include "roster.h"
+#include "opt.h"
+
+#define OPT_CACHE_LINE 64 /* Size of a cache line in bytes */
+
+#define OPT_RUNNING 0 /* Not decided yet */
+#define OPT_MEETS 1 /* Meets the level */
+#define OPT_FAILS 2 /* Fails the level */
+#define OPT_UNSURE 3 /* Undecided after the most days */
+#define OPT_SKIPPED 4 /* Costs more than a candidate which meets it */
+
+static const char *opt_metric_names[] = { "p50", "p95", "p99", "avg",
+	"max" };
+static const char *opt_verdicts[] = { "running", "meets", "fails",
+	"unsure", "skipped" };
+
+/*
+ * A candidate staffing and what its days have shown so far.
+ */
+struct opt_cand
+{
+	int n_tellers; /* The candidate's tellers */
+	int brk; /* The candidate's break policy */
+	int ros; /* The candidate's roster, or -1 for the scenario's own */
+	struct sim_range tbreak; /* Its time between breaks */
+	struct sim_range lbreak; /* Its length of a break */
+	double cost; /* The cost of a day */
+	long n; /* Days simulated */
+	double mean; /* The mean of the days' metric (Welford) */
+	double m2; /* The sum of squared deviations of it (Welford) */
+	double conf; /* The confidence that the mean meets the level */
+	int verdict; /* One of the OPT_ verdicts above */
+};
+
+/*
+ * A worker's customer store, and room for the scenario and measurements of
+ * its day, padded such that workers never share a cache line.
+ */
+struct opt_slot
+{
+	struct customer_store store;
+	struct scenario sc;
+	struct bank_stats st;
+} __attribute__((aligned(OPT_CACHE_LINE)));
+
+struct opt_run
+{
+	const struct scenario *sc; /* The bank to staff */
+	const struct opt_spec *os;
+	unsigned int seed; /* The seed of the whole search */
+	struct opt_cand *cands; /* Every candidate, cheapest first */
+	int *alive; /* The candidates still running */
+	int n_alive;
+	long rep0; /* The first day of the round */
+	double *vals; /* The metric of each day of the round */
+	struct opt_slot *slots; /* One store per worker */
+};
+
+/*
+ * Parses "lo-hi" seconds (or a single number, for both). Returns 0, or -1
+ * if the range is malformed.
+ */
+static int opt_parse_range(const char *str, int *lo, int *hi)
+{
+	char buf[64];
+	if (strlen(str) >= sizeof(buf)) return -1;
+	strcpy(buf, str);
+
+	char *dash = strchr(buf, '-');
+	if (dash != NULL) *dash = '\0';
+	if (scenario_parse_secs(buf, lo) == -1) return -1;
+	if (dash == NULL) {
+		*hi = *lo;
+		return 0;
+	}
+	if (scenario_parse_secs(dash + 1, hi) == -1) return -1;
+	return *lo <= *hi ? 0 : -1;
+}
+
+/*
+ * Parses the break policies, e.g. "30m-60m/1m-4m 60m-90m/5m-15m". Returns
+ * 0, or -1 if a policy is malformed.
+ */
+static int opt_parse_breaks(struct opt_spec *os, char *str)
+{
+	int n = 0;
+	char *save;
+	char *policy = strtok_r(str, " \t", &save);
+	while (policy != NULL) {
+		char *slash = strchr(policy, '/');
+		int tlo, thi, llo, lhi;
+		if (slash == NULL || n == OPT_MAX_BREAKS) return -1;
+		*slash = '\0';
+		if (opt_parse_range(policy, &tlo, &thi) == -1
+				|| opt_parse_range(slash + 1, &llo, &lhi) == -1
+				|| tlo < 1 || llo < 1) {
+			return -1;
+		}
+		sim_range_init(&os->tbreak[n], tlo, thi);
+		sim_range_init(&os->lbreak[n], llo, lhi);
+		n++;
+
+		policy = strtok_r(NULL, " \t", &save);
+	}
+	if (n == 0) return -1;
+
+	os->n_breaks = n;
+	return 0;
+}
+
+/*
+ * Parses the rosters, e.g. "09:00-16:00|09:00-13:00 12:00-16:00". Returns
+ * 0, or -1 if a roster is malformed.
+ */
+static int opt_parse_rosters(struct opt_spec *os, char *str)
+{
+	struct scenario shifts;
+	int n = 0;
+	char *save;
+	char *roster = strtok_r(str, "|", &save);
+	while (roster != NULL) {
+		if (n == OPT_MAX_ROSTERS || scenario_parse_shifts(roster,
+				&shifts) == -1) {
+			return -1;
+		}
+		os->rosters[n].n_shifts = shifts.n_shifts;
+		memcpy(os->rosters[n].shifts, shifts.shifts,
+				sizeof(os->rosters[n].shifts));
+		n++;
+
+		roster = strtok_r(NULL, "|", &save);
+	}
+	if (n == 0) return -1;
+
+	os->n_rosters = n;
+	return 0;
+}
+
+/*
+ * Applies one "key = value" assignment to the optimizer. Returns 0, -1 if
+ * the value is malformed, or -2 if there is no such key.
+ */
+static int opt_assign(struct opt_spec *os, char *key, char *value)
+{
+	char *end;
+	int m;
+	for (m = 0; m <= OPT_MAX; m++) {
+		if (strcmp(key, opt_metric_names[m]) == 0) {
+			os->metric = m;
+			return scenario_parse_secs(value, &os->limit);
+		}
+	}
+
+	if (strcmp(key, "cost") == 0) {
+		os->cost = strtod(value, &end);
+		return end == value || *end != '\0' || os->cost <= 0 ? -1 : 0;
+	}
+	if (strcmp(key, "level") == 0) {
+		os->level = strtod(value, &end);
+		return end == value || *end != '\0' || os->level <= 0.5
+				|| os->level >= 1 ? -1 : 0;
+	}
+	if (strcmp(key, "tellers") == 0) {
+		if (opt_parse_range(value, &os->t_lo, &os->t_hi) == -1) {
+			return -1;
+		}
+		return os->t_lo < 1 || os->t_hi > SCENARIO_MAX_TELLERS ? -1 : 0;
+	}
+	if (strcmp(key, "breaks") == 0) return opt_parse_breaks(os, value);
+	if (strcmp(key, "rosters") == 0) return opt_parse_rosters(os, value);
+	if (strcmp(key, "batch") == 0) {
+		os->batch = (int) strtol(value, &end, 10);
+		return end == value || *end != '\0' || os->batch < 2 ? -1 : 0;
+	}
+	if (strcmp(key, "days") == 0) {
+		os->max_days = strtol(value, &end, 10);
+		return end == value || *end != '\0' || os->max_days < 2 ? -1
+				: 0;
+	}
+
+	return -2;
+}
+
+/**
+ * Parses the service level and search of the optimizer, as a comma
+ * separated list of assignments (e.g. "p95=5m,cost=25,tellers=2-8").
+ * Errors are printed to stderr.
+ *
+ * Params: os   - storage for the optimizer's parameters
+ *         spec - the assignments
+ * Return: 0 on success, -1 if the assignments could not be parsed
+ */
+int opt_parse(struct opt_spec *os, const char *spec)
+{
+	memset(os, 0, sizeof(*os));
+	os->metric = -1;
+	os->cost = 1;
+	os->level = 0.95;
+	os->batch = 16;
+	os->max_days = 1000;
+
+	char *copy = strdup(spec);
+	if (copy == NULL) {
+		perror(spec);
+		return -1;
+	}
+
+	int rc = 0;
+	char *save;
+	char *item = strtok_r(copy, ",", &save);
+	while (rc == 0 && item != NULL) {
+		char *eq = strchr(item, '=');
+		if (eq == NULL) {
+			fprintf(stderr, "%s: expected key = value\n", spec);
+			rc = -1;
+			break;
+		}
+		*eq = '\0';
+
+		char *key = item, *value = eq + 1;
+		while (*key == ' ') key++;
+		while (*value == ' ') value++;
+		char *kend = eq;
+		while (kend > key && kend[-1] == ' ') *--kend = '\0';
+
+		rc = opt_assign(os, key, value);
+		if (rc == -2) {
+			fprintf(stderr, "%s: unknown key '%s'\n", spec, key);
+			rc = -1;
+		} else if (rc == -1) {
+			fprintf(stderr, "%s: bad value '%s' for %s\n", spec,
+					value, key);
+		}
+		item = strtok_r(NULL, ",", &save);
+	}
+	free(copy);
+
+	if (rc == 0 && os->metric == -1) {
+		fprintf(stderr, "%s: no service level (e.g. p95=5m)\n", spec);
+		rc = -1;
+	}
+	if (rc == 0 && os->max_days < os->batch) os->max_days = os->batch;
+	return rc;
+}
+
+/*
+ * The metric of a day, from its measurements.
+ */
+static double opt_metric(int metric, const struct bank_stats *st)
+{
+	switch (metric)
+	{
+	case OPT_P50:
+		return stats_quantile(&st->q, 0.50);
+	case OPT_P95:
+		return stats_quantile(&st->q, 0.95);
+	case OPT_P99:
+		return stats_quantile(&st->q, 0.99);
+	case OPT_AVG:
+		return st->q.n > 0 ? st->q.mean : 0;
+	default:
+		return st->q.n > 0 ? st->q.max : 0;
+	}
+}
+
+/*
+ * Puts a roster's shifts into a scenario.
+ */
+static void opt_staff(struct scenario *sc, const struct opt_roster *r)
+{
+	sc->n_shifts = r->n_shifts;
+	memcpy(sc->shifts, r->shifts, sizeof(r->shifts));
+}
+
+/*
+ * Writes the shifts of a candidate's roster into buf, as "HH:MM-HH:MM"
+ * windows separated by spaces.
+ */
+static void opt_describe_roster(const struct opt_roster *r, char *buf,
+		size_t size)
+{
+	size_t len = 0;
+	int s;
+	buf[0] = '\0';
+	for (s = 0; s < r->n_shifts && len < size; s++) {
+		const struct scenario_shift *w = &r->shifts[s];
+		len += snprintf(buf + len, size - len, "%s%02d:%02d-%02d:%02d",
+				s > 0 ? " " : "", w->sec_in / 3600,
+				w->sec_in / 60 % 60, w->sec_out / 3600,
+				w->sec_out / 60 % 60);
+	}
+}
+
+/*
+ * Simulates day number task % batch of the round, of the round's alive
+ * candidate number task / batch. Day n has the same seed for every
+ * candidate, as in mc.c.
+ */
+static void opt_day(long task, int worker, void *arg)
+{
+	struct opt_run *run = arg;
+	const struct opt_spec *os = run->os;
+	const struct opt_cand *c = &run->cands[run->alive[task / os->batch]];
+	struct opt_slot *slot = &run->slots[worker];
+	long rep = run->rep0 + task % os->batch;
+
+	slot->sc = *run->sc;
+	slot->sc.n_tellers = c->n_tellers;
+	slot->sc.tbreak = c->tbreak;
+	slot->sc.lbreak = c->lbreak;
+	if (c->ros != -1) opt_staff(&slot->sc, &os->rosters[c->ros]);
+	bank_stats_init(&slot->st);
+
+	struct bank_metrics met;
+	uint64_t seed = ((uint64_t) run->seed << 32) | (uint32_t) rep;
+	if (slot->sc.n_branches > 1) {
+		region_run_day(&slot->sc, seed, 1, &met, &slot->st, NULL);
+	} else {
+		des_run_day(&slot->sc, seed, 0, &slot->store, &met,
+				&slot->st, NULL);
+	}
+	run->vals[task] = opt_metric(os->metric, &slot->st);
+}
+
+/*
+ * Decides a candidate, if its days so far are conclusive.
+ */
+static void opt_decide(const struct opt_spec *os, struct opt_cand *c)
+{
+	double se = sqrt(c->m2 / (c->n - 1) / c->n);
+	if (se > 0) {
+		c->conf = 0.5 * erfc((c->mean - os->limit) / se / sqrt(2));
+	} else {
+		c->conf = c->mean <= os->limit ? 1 : 0;
+	}
+
+	if (c->conf >= os->level) {
+		c->verdict = OPT_MEETS;
+	} else if (c->conf <= 1 - os->level) {
+		c->verdict = OPT_FAILS;
+	} else if (c->n >= os->max_days) {
+		c->verdict = OPT_UNSURE;
+	}
+}
+
+/*
+ * Orders candidates by cost, then by teller count, roster and break policy.
+ */
+static int opt_cmp(const void *a, const void *b)
+{
+	const struct opt_cand *x = a, *y = b;
+	if (x->cost != y->cost) return x->cost < y->cost ? -1 : 1;
+	if (x->n_tellers != y->n_tellers) return x->n_tellers - y->n_tellers;
+	if (x->ros != y->ros) return x->ros - y->ros;
+	return x->brk - y->brk;
+}
+
+/*
+ * Prints every candidate which was simulated, with its verdict.
+ */
+static void opt_print_table(const struct opt_spec *os,
+		const struct opt_cand *cands, int n_cands)
+{
+	char metric[32];
+	snprintf(metric, sizeof(metric), "%s queue (s)",
+			opt_metric_names[os->metric]);
+	printf("OPT>\ttellers | roster |             breaks (s) |   cost/day "
+		"|  days | %17s | confidence | verdict\n", metric);
+
+	int i;
+	for (i = 0; i < n_cands; i++) {
+		const struct opt_cand *c = &cands[i];
+		if (c->n == 0) continue;
+
+		char brk[32];
+		snprintf(brk, sizeof(brk), "%u-%u for %u-%u", c->tbreak.lo,
+				c->tbreak.hi, c->lbreak.lo, c->lbreak.hi);
+		char ros[12] = "own";
+		if (c->ros != -1) snprintf(ros, sizeof(ros), "%d", c->ros + 1);
+		double ci = c->n > 1 ? 1.96 * sqrt(c->m2 / (c->n - 1) / c->n)
+				: 0;
+		printf("OPT>\t%7d | %6s | %22s | %10.2f | %5ld | %7.1f +/- "
+			"%5.1f | %9.1f%% | %s\n", c->n_tellers, ros, brk,
+				c->cost, c->n, c->mean, ci, 100 * c->conf,
+				opt_verdicts[c->verdict]);
+	}
+}
+
+/**
+ * Searches the teller counts, rosters and break policies of a scenario for
+ * the cheapest staffing which meets the service level, and prints it.
+ *
+ * Params: sc        - the bank to staff
+ *         os        - the service level and search
+ *         n_workers - the number of threads to simulate on
+ *         seed      - the seed of the search
+ * Return: void
+ */
+void opt_run(const struct scenario *sc, const struct opt_spec *os,
+		int n_workers, unsigned int seed)
+{
+	if (n_workers < 1) n_workers = 1;
+
+	int t_lo = os->t_lo > 0 ? os->t_lo : 1;
+	int t_hi = os->t_lo > 0 ? os->t_hi : 4 * sc->n_tellers;
+	if (t_lo < sc->n_queues) t_lo = sc->n_queues;
+	if (t_hi > SCENARIO_MAX_TELLERS) t_hi = SCENARIO_MAX_TELLERS;
+	int n_breaks = os->n_breaks > 0 ? os->n_breaks : 1;
+	int n_rosters = os->n_rosters > 0 ? os->n_rosters : 1;
+	int n_cands = t_hi >= t_lo ? (t_hi - t_lo + 1) * n_rosters * n_breaks
+			: 0;
+	if (n_cands == 0) {
+		printf("CON> No teller count to search.\n");
+		return;
+	}
+
+	/* Tellers only work while the bank is open */
+	int i, s;
+	for (i = 0; i < os->n_rosters; i++) {
+		const struct opt_roster *r = &os->rosters[i];
+		for (s = 0; s < r->n_shifts; s++) {
+			if (r->shifts[s].sec_in < sc->sec_open
+					|| r->shifts[s].sec_out
+							> sc->sec_close) {
+				printf("CON> Roster %d has a shift outside "
+					"opening hours.\n", i + 1);
+				return;
+			}
+		}
+	}
+
+	struct opt_run run;
+	run.sc = sc;
+	run.os = os;
+	run.seed = seed;
+	run.cands = malloc(n_cands * sizeof(struct opt_cand));
+	run.alive = malloc(n_cands * sizeof(int));
+	run.vals = malloc((size_t) n_cands * os->batch * sizeof(double));
+	if (posix_memalign((void **) &run.slots, OPT_CACHE_LINE,
+			n_workers * sizeof(struct opt_slot))) {
+		run.slots = NULL;
+	}
+	if (run.cands == NULL || run.alive == NULL || run.vals == NULL
+			|| run.slots == NULL) {
+		perror("CON> Error allocating candidates");
+		goto out;
+	}
+
+	/* Every teller count, on every roster, with every break policy */
+	struct scenario staffed = *sc;
+	int t, r, b;
+	for (i = 0, t = t_lo; t <= t_hi; t++) {
+		staffed.n_tellers = t;
+		for (r = 0; r < n_rosters; r++) {
+			/* The hours on shift of t tellers, by the roster */
+			int ros = os->n_rosters > 0 ? r : -1;
+			if (ros != -1) opt_staff(&staffed, &os->rosters[ros]);
+			double hours = roster_hours(&staffed);
+
+			for (b = 0; b < n_breaks; b++, i++) {
+				struct opt_cand *c = &run.cands[i];
+				memset(c, 0, sizeof(*c));
+				c->n_tellers = t;
+				c->ros = ros;
+				c->brk = b;
+				c->tbreak = os->n_breaks > 0 ? os->tbreak[b]
+						: sc->tbreak;
+				c->lbreak = os->n_breaks > 0 ? os->lbreak[b]
+						: sc->lbreak;
+
+				/* A teller is at the counter between breaks */
+				double tb = (c->tbreak.lo + c->tbreak.hi)
+						/ 2.0;
+				double lb = (c->lbreak.lo + c->lbreak.hi)
+						/ 2.0;
+				c->cost = os->cost * sc->n_branches * hours
+						* tb / (tb + lb);
+			}
+		}
+	}
+	qsort(run.cands, n_cands, sizeof(struct opt_cand), opt_cmp);
+
+	for (i = 0; i < n_workers; i++) {
+		customer_store_init(&run.slots[i].store);
+	}
+
+	printf("CON> Searching %d to %d tellers, %d roster%s and %d break %s "
+		"for the cheapest %s queue time of at most %d s, at %.2f per "
+		"teller-hour (seed %u).\n", t_lo, t_hi, n_rosters,
+			n_rosters == 1 ? "" : "s", n_breaks,
+			n_breaks == 1 ? "policy" : "policies",
+			opt_metric_names[os->metric], os->limit, os->cost,
+			seed);
+
+	long days = 0;
+	int rounds = 0;
+	run.rep0 = 0;
+	run.n_alive = n_cands;
+	for (i = 0; i < n_cands; i++) run.alive[i] = i;
+
+	while (run.n_alive > 0) {
+		pool_run((long) run.n_alive * os->batch, n_workers, opt_day,
+				&run);
+		days += (long) run.n_alive * os->batch;
+		rounds++;
+		run.rep0 += os->batch;
+
+		/* Fold the round's days in, in order, and decide */
+		int a;
+		for (a = 0; a < run.n_alive; a++) {
+			struct opt_cand *c = &run.cands[run.alive[a]];
+			for (b = 0; b < os->batch; b++) {
+				double x = run.vals[a * os->batch + b];
+				double delta = x - c->mean;
+				c->n++;
+				c->mean += delta / c->n;
+				c->m2 += delta * (x - c->mean);
+			}
+			opt_decide(os, c);
+		}
+
+		/* Run nothing costlier than the cheapest which meets it */
+		int best = n_cands;
+		for (i = 0; i < n_cands; i++) {
+			if (run.cands[i].verdict == OPT_MEETS) {
+				best = i;
+				break;
+			}
+		}
+
+		int n = 0;
+		for (a = 0; a < run.n_alive; a++) {
+			int ci = run.alive[a];
+			if (run.cands[ci].verdict != OPT_RUNNING) continue;
+			if (ci > best) {
+				run.cands[ci].verdict = OPT_SKIPPED;
+			} else {
+				run.alive[n++] = ci;
+			}
+		}
+		run.n_alive = n;
+	}
+
+	/* The cheapest candidate which meets the level */
+	int best = -1, dropped = 0;
+	for (i = 0; i < n_cands; i++) {
+		const struct opt_cand *c = &run.cands[i];
+		if (best == -1 && c->verdict == OPT_MEETS) best = i;
+		if (c->verdict == OPT_FAILS && c->n < os->max_days) dropped++;
+	}
+
+	puts("");
+	opt_print_table(os, run.cands, n_cands);
+	puts("");
+	if (best == -1) {
+		printf("OPT> No staffing searched meets the %s queue time of "
+			"at most %d s with %.0f%% confidence.\n",
+				opt_metric_names[os->metric], os->limit,
+				100 * os->level);
+	} else {
+		const struct opt_cand *c = &run.cands[best];
+		double ci = 1.96 * sqrt(c->m2 / (c->n - 1) / c->n);
+		printf("OPT> Cheapest staffing: %d tellers, breaks every "
+			"%u-%u s for %u-%u s, at %.2f a day.\n",
+				c->n_tellers, c->tbreak.lo, c->tbreak.hi,
+				c->lbreak.lo, c->lbreak.hi, c->cost);
+		if (c->ros != -1) {
+			char shifts[16 * SCENARIO_MAX_SHIFTS];
+			opt_describe_roster(&os->rosters[c->ros], shifts,
+					sizeof(shifts));
+			printf("OPT> Its roster is %d, of the shifts %s.\n",
+					c->ros + 1, shifts);
+		}
+		printf("OPT> Its %s queue time is %.1f +/- %.1f s over %ld "
+			"days: at most %d s with %.1f%% confidence.\n",
+				opt_metric_names[os->metric], c->mean, ci,
+				c->n, os->limit, 100 * c->conf);
+	}
+	printf("OPT> Simulated %ld days in %d round%s, %d of %d candidates "
+		"dropped early.\n", days, rounds, rounds == 1 ? "" : "s",
+			dropped, n_cands);
+
+	for (i = 0; i < n_workers; i++) {
+		customer_store_destroy(&run.slots[i].store);
+	}
+
+out:
+	free(run.slots);
+	free(run.vals);
+	free(run.alive);
+	free(run.cands);
+}
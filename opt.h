@@ -0,0 +1,71 @@
+#ifndef OPT_H_
+#define OPT_H_
+
+/*
+ * Proj: 4
+ * File: opt.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the staffing optimizer. Given
+ * a service level (e.g. "the p95 queue time of a day is at most 5 minutes")
+ * and a cost per teller-hour, it searches the teller counts, rosters and
+ * break policies of a scenario for the cheapest one which meets the level.
+ * A roster is a set of shifts (teller t works shift t % the shifts), so a
+ * teller count and a roster together staff each hour of the day.
+ *
+ * Every candidate staffing is simulated in batches of days in virtual time,
+ * on the work-stealing pool. Day n of every candidate has the same seed, so
+ * every candidate serves the same customers (common random numbers), and the
+ * candidates are compared on equal terms. After each batch a candidate whose
+ * mean is clearly above or below the level, at the confidence asked for, is
+ * decided, and the clearly bad ones are dropped after a few batches. Only the
+ * candidates cheaper than the cheapest one found to meet the level are run
+ * on.
+ *
+ * Breaks are unpaid: a teller-hour is an hour a teller spends at the counter,
+ * so longer or more frequent breaks make a staffing cheaper, and slower.
+ */
+
+#include "scenario.h"
+
+#define OPT_MAX_BREAKS 16 /* The most break policies searched */
+#define OPT_MAX_ROSTERS 16 /* The most rosters searched */
+
+#define OPT_P50 0 /* The median queue time of a day */
+#define OPT_P95 1 /* The 95th percentile queue time of a day */
+#define OPT_P99 2 /* The 99th percentile queue time of a day */
+#define OPT_AVG 3 /* The average queue time of a day */
+#define OPT_MAX 4 /* The longest queue time of a day */
+
+/*
+ * The shifts of a roster searched.
+ */
+struct opt_roster
+{
+	int n_shifts;
+	struct scenario_shift shifts[SCENARIO_MAX_SHIFTS];
+};
+
+struct opt_spec
+{
+	int metric; /* One of the OPT_ metrics above */
+	int limit; /* The most seconds the metric may average */
+	double cost; /* The cost of a teller-hour */
+	double level; /* The confidence of a verdict, e.g. 0.95 */
+	int t_lo, t_hi; /* The teller counts searched, 0 for the default */
+	int n_breaks; /* Break policies searched, 0 for the scenario's own */
+	struct sim_range tbreak[OPT_MAX_BREAKS]; /* Time between breaks */
+	struct sim_range lbreak[OPT_MAX_BREAKS]; /* Length of a break */
+	int n_rosters; /* Rosters searched, 0 for the scenario's own */
+	struct opt_roster rosters[OPT_MAX_ROSTERS];
+	int batch; /* Days simulated per candidate and round */
+	long max_days; /* The most days simulated per candidate */
+};
+
+int opt_parse(struct opt_spec *os, const char *spec);
+void opt_run(const struct scenario *sc, const struct opt_spec *os,
+		int n_workers, unsigned int seed);
+
+#endif
@@ -0,0 +1,188 @@
+/*
+ * Proj: 4
+ * File: pool.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in pool.h.
+ *
+ * Every worker owns a range [next, end) of task numbers. Both halves of the
+ * range are packed into a single 64 bit word, such that a range can be
+ * updated with one compare-and-swap:
+ *
+ *  - The owner takes tasks from the front of its range (next++).
+ *  - A thief takes the back half of a victim's range (end -= half).
+ *
+ * A compare-and-swap only succeeds if the range hasn't changed since it was
+ * read, so a task is handed out exactly once without any locks. Workers sit
+ * on their own cache lines, so owners taking tasks don't disturb each other.
+ *
+ * A worker exits once it finds every range empty. Tasks are never created
+ * while the pool runs, so no task can be left behind.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h> /* For sysconf */
+#include <pthread.h>
+#include "pool.h"
+
+#define POOL_CACHE_LINE 64 /* Size of a cache line in bytes */
+
+#define RANGE_MAKE(NEXT, END) (((uint64_t) (END) << 32) | (uint32_t) (NEXT))
+#define RANGE_NEXT(R) ((long) ((R) & 0xffffffff))
+#define RANGE_END(R) ((long) ((R) >> 32))
+
+struct pool_worker
+{
+	volatile uint64_t range; /* The packed [next, end) range of tasks */
+	int id; /* The number of this worker */
+	struct pool *pool; /* The pool this worker belongs to */
+	pthread_t thd; /* The thread backing this worker */
+} __attribute__((aligned(POOL_CACHE_LINE)));
+
+struct pool
+{
+	struct pool_worker *workers;
+	int n_workers;
+	pool_task_fn fn;
+	void *arg;
+};
+
+/**
+ * Determines the number of workers which makes use of every processor of
+ * the machine.
+ *
+ * Params: void
+ * Return: the number of online processors (at least 1)
+ */
+int pool_default_workers(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (int) n : 1;
+}
+
+/*
+ * Takes the next task from the front of the worker's own range.
+ *
+ * Return: the task number, or -1 if the range is empty
+ */
+static long pool_take(struct pool_worker *w)
+{
+	uint64_t r = __atomic_load_n(&w->range, __ATOMIC_ACQUIRE);
+	while (RANGE_NEXT(r) < RANGE_END(r)) {
+		uint64_t taken = RANGE_MAKE(RANGE_NEXT(r) + 1, RANGE_END(r));
+		if (__atomic_compare_exchange_n(&w->range, &r, taken, 0,
+				__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			return RANGE_NEXT(r);
+		}
+	}
+	return -1;
+}
+
+/*
+ * Steals the back half of another worker's range into the worker's own
+ * (empty) range. Victims are visited round robin, starting at the worker
+ * after the thief.
+ *
+ * Return: 1 if something was stolen, 0 if every range is empty
+ */
+static int pool_steal(struct pool_worker *w)
+{
+	struct pool *pool = w->pool;
+
+	int i;
+	for (i = 1; i < pool->n_workers; i++) {
+		struct pool_worker *v = &pool->workers[(w->id + i)
+				% pool->n_workers];
+
+		uint64_t r = __atomic_load_n(&v->range, __ATOMIC_ACQUIRE);
+		while (RANGE_NEXT(r) < RANGE_END(r)) {
+			long left = RANGE_END(r) - RANGE_NEXT(r);
+			long split = RANGE_END(r) - (left + 1) / 2;
+
+			uint64_t kept = RANGE_MAKE(RANGE_NEXT(r), split);
+			if (__atomic_compare_exchange_n(&v->range, &r, kept, 0,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+				__atomic_store_n(&w->range,
+						RANGE_MAKE(split, RANGE_END(r)),
+						__ATOMIC_RELEASE);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Backs each worker thread: run tasks until there are none left anywhere.
+ */
+static void *pool_worker_main(void *ptr)
+{
+	struct pool_worker *w = ptr;
+
+	do {
+		long task;
+		while ((task = pool_take(w)) != -1) {
+			w->pool->fn(task, w->id, w->pool->arg);
+		}
+	} while (pool_steal(w));
+
+	return NULL;
+}
+
+/**
+ * Runs the tasks numbered 0 to n_tasks - 1 on n_workers threads, and returns
+ * once every task has completed. Tasks may run in any order, and concurrently
+ * with each other. The tasks of a worker whose thread fails to start are run
+ * by the calling thread.
+ *
+ * Params: n_tasks   - the number of tasks to run
+ *         n_workers - the number of worker threads (see pool_default_workers)
+ *         fn        - the function which runs a task
+ *         arg       - passed through to fn
+ * Return: void
+ */
+void pool_run(long n_tasks, int n_workers, pool_task_fn fn, void *arg)
+{
+	if (n_workers < 1) n_workers = 1;
+
+	struct pool pool;
+	pool.n_workers = n_workers;
+	pool.fn = fn;
+	pool.arg = arg;
+	if (posix_memalign((void **) &pool.workers, POOL_CACHE_LINE,
+			n_workers * sizeof(struct pool_worker))) {
+		return;
+	}
+
+	/* Deal out an equal share of the tasks to every worker */
+	int i;
+	for (i = 0; i < n_workers; i++) {
+		struct pool_worker *w = &pool.workers[i];
+		w->range = RANGE_MAKE(n_tasks * i / n_workers,
+				n_tasks * (i + 1) / n_workers);
+		w->id = i;
+		w->pool = &pool;
+	}
+
+	/* The calling thread acts as worker 0 */
+	int n_started;
+	for (n_started = 1; n_started < n_workers; n_started++) {
+		struct pool_worker *w = &pool.workers[n_started];
+		if (pthread_create(&w->thd, NULL, pool_worker_main, w)) break;
+	}
+	pool_worker_main(&pool.workers[0]);
+
+	/* It also acts as the workers which failed to start */
+	for (i = n_started; i < n_workers; i++) {
+		pool_worker_main(&pool.workers[i]);
+	}
+	for (i = 1; i < n_started; i++) {
+		pthread_join(pool.workers[i].thd, NULL);
+	}
+
+	free(pool.workers);
+}
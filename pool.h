@@ -0,0 +1,26 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+/*
+ * Proj: 4
+ * File: pool.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the work-stealing pool. The pool
+ * runs a number of independent, numbered tasks on a set of worker threads.
+ * Each worker starts with an equal share of the tasks, and workers which run
+ * out steal half of the remaining share of another worker.
+ */
+
+/*
+ * The function run for each task. It is passed the task number, the number
+ * of the worker running it, and the argument given to pool_run().
+ */
+typedef void (*pool_task_fn)(long task, int worker, void *arg);
+
+int pool_default_workers(void);
+void pool_run(long n_tasks, int n_workers, pool_task_fn fn, void *arg);
+
+#endif
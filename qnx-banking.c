@@ -13,88 +13,785 @@
  *
  * The architecture involves one thread to generate customers (as passive
  * data structures), three threads acting as the tellers, and one thread
- * which accumulates business statistics.
+ * which accumulates business statistics. With -p, the generator and the
+ * tellers are state machines instead, stepped by a fixed pool of worker
+ * threads (see tsched.h), such that any number of tellers can be simulated
+ * on as many threads as there are processors.
  *
  * This lab applies the following concurrent structures:
  *  - pthreads
  *  - mutexes
- *  - condition variables and broadcasting
- *  - message passing (QNX pulses)
+ *  - per-teller wakeups (an eventcount per teller, see evcount.h)
+ *  - direct hand-off to idle tellers, over a lock-free stack (see -a)
+ *  - a lock-free line with eventcount parking (optional, see -l)
+ *  - message passing (QNX pulses, or per-teller rings on Linux - see chan.h)
+ *
+ * The same bank can also be simulated in virtual time (see des.c), which
+ * completes a whole day without pacing it against the wall clock. Banks of
+ * several lines, and regions of several branches (see region.h), are only
+ * simulated in virtual time.
  */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 #include <time.h>
 #include <pthread.h>
 #include <sched.h>
 #include <errno.h>
-#include <sys/neutrino.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "scenario.h"
 #include "sim.h"
 #include "customer.h"
+#include "customer_lfq.h"
+#include "customer_store.h"
+#include "evcount.h"
+#include "chan.h"
+#include "metbuf.h"
+#include "evlog.h"
+#include "trace.h"
+#include "live.h"
+#include "lockstat.h"
+#include "metrics.h"
+#include "des.h"
+#include "region.h"
+#include "mc.h"
+#include "opt.h"
+#include "pool.h"
+#include "tsched.h"
+#include "roster.h"
 
 /*
- * The second at which the bank opens: 9:00 AM converted to seconds.
- */
-static const int SEC_AT_BANK_OPEN = SIM_MIL_TO_SEC(9, 0);
-/*
- * The second at which the bank closes: 4:00 PM converted to seconds.
+ * The state of one simulated day in the threaded model. Every thread of the
+ * day is handed a pointer to it, such that nothing about a day lives in
+ * process-wide storage.
  */
-static const int SEC_AT_BANK_CLOSE = SIM_MIL_TO_SEC(16, 0);
+struct bank_day
+{
+	const struct scenario *sc; /* The bank being simulated */
 
-static const int ARRIVE_LO = MIN_TO_SEC(1); /* The lower cust arrival bound */
-static const int ARRIVE_HI = MIN_TO_SEC(4); /* The upper cust arrival bound */
+	/*
+	 * The line of customers. The mutex assists the threads in maintaining
+	 * mutually exclusive access to the line, and to the idle tellers. A
+	 * teller which finds nothing to poll registers as idle and sleeps on
+	 * its own bell: an arrival rings the teller which went idle last, and
+	 * nobody else, and the plug rings them all.
+	 */
+	struct customer_q line;
+	pthread_mutex_t queue_mutex;
+	int *idle; /* The idle tellers, the last one idle at the top */
+	int n_idle; /* Idle tellers */
+#ifdef LOCKSTAT
+	struct lockstat queue_stat; /* Measures the mutex, see lockstat.h */
+#endif
 
-static const int TBREAK_LO = MIN_TO_SEC(30); /* The lower teller break bound */
-static const int TBREAK_HI = MIN_TO_SEC(60); /* The upper teller break bound */
+	/*
+	 * The lock-free line, used instead of the line above when lockfree is
+	 * set. Idle tellers park on the eventcount, and every arrival wakes a
+	 * single one of them.
+	 */
+	int lockfree;
+	struct customer_lfq lfq;
+	struct evcount line_ec;
 
-static const int LBREAK_LO = MIN_TO_SEC(1); /* The lower teller break length */
-static const int LBREAK_HI = MIN_TO_SEC(4); /* The upper teller break length */
+	/*
+	 * Direct hand-off, used on the mutex guarded line when assign is set.
+	 * Idle tellers push themselves onto a lock-free stack, and an arrival
+	 * is handed straight to the teller on top of it, without taking the
+	 * mutex. The line only takes the arrivals which find every teller
+	 * busy. The generator is the only thread popping the stack.
+	 */
+	int assign;
+	volatile int idle_top /* The teller on top of the stack, or -1 */
+			__attribute__((aligned(METBUF_CACHE_LINE)));
+	long n_handed; /* Customers handed straight to a teller */
 
-static const int TRANST_LO = 30; /* The lower transaction bound */
-static const int TRANST_HI = MIN_TO_SEC(6); /* The upper transaction bound */
+	/*
+	 * The channel which will be allocated in threaded_run_day(). The
+	 * channel facilitates communication of statistics from domain threads
+	 * to the stats muncher thread.
+	 */
+	struct chan chan;
 
-static const int NUM_TELLERS = 3; /* The number of tellers in the system */
+	/*
+	 * Customers of the day are kept here, made by the generator. The
+	 * store is reserved for every customer of the day before the threads
+	 * start. Tellers only write the dequeue_sec column, which shares no
+	 * cache line with the columns the generator writes.
+	 */
+	struct customer_store store;
 
-/*
- * This mutex assists the threads in maintaining mutually exclusive access
- * to the structures in the customer module. The mutex is allocated and
- * initialized statically - avoiding a call to pthread_mutex_init().
- */
-static pthread_mutex_t queue_mutex =
-PTHREAD_MUTEX_INITIALIZER;
+	/*
+	 * The SIM> event log. The generator and every teller log into their
+	 * own ring, and a drain thread prints the lines.
+	 */
+	struct evlog log;
+	struct trace *trace; /* Records the day, if not NULL */
+	struct live *live; /* Served while the day runs, if not NULL */
+
+	int *arrive; /* Seconds before each customer arrives, pre-drawn */
+	int *transt; /* Each customer's transaction time, pre-drawn */
+	int max_cust; /* The customers drawn (see scenario_max_customers()) */
+	struct teller_ctx *tellers; /* One per teller of the scenario */
+	struct roster roster; /* Lets the tellers off the counter */
+	long n_vcsw; /* Context switches of the generator and the tellers */
+	long n_ivcsw; /* Those of them which were involuntary */
 
-/*
- * This condition variable assists the threads in blocking on the customer
- * module when nothing is available to poll. The condvar is allocated and
- * initialized statically - avoiding a call to pthread_cond_init().
- */
-static pthread_cond_t queue_cond =
-PTHREAD_COND_INITIALIZER;
+	/*
+	 * The scheduler of the pooled simulation (see -p). Its tasks are the
+	 * tellers, numbered by their id, and the generator (TASK_GEN). Every
+	 * worker logs into its own ring of the event log, and records into
+	 * its own buffer of the trace.
+	 */
+	struct tsched ts;
+	int gen_cid; /* The id of the next customer, -1 before opening */
+};
+
+#define LOG_GEN 0 /* The generator's ring of the event log */
+#define LOG_TELLER(TID) ((TID) + 1) /* A teller's ring of the event log */
+#define LOG_THREADS(SC) ((SC)->n_tellers + 1) /* The number of rings */
+
+#define TASK_GEN(SC) ((SC)->n_tellers) /* The generator's pooled task */
+
+/* The call sites taking queue_mutex, as measured with -DLOCKSTAT */
+#define QSITE_GEN_PUSH 0 /* cust_gen() lines a customer up */
+#define QSITE_GEN_PLUG 1 /* cust_gen() plugs the line */
+#define QSITE_TELLER 2 /* teller_wait_locked() waits for a customer */
+#define QSITE_POOL_PUSH 3 /* pooled_gen_step() lines a customer up */
+#define QSITE_POOL_PLUG 4 /* pooled_gen_step() plugs the line */
+#define QSITE_POOL_POLL 5 /* pooled_poll() looks for a customer */
+
+#ifdef LOCKSTAT
+static const char *const qsite_names[] = {
+	"gen push", "gen plug", "teller wait", "pooled push", "pooled plug",
+	"pooled poll"
+};
+#endif
 
 /*
- * The channel id which will be allocated in main(). The represented channel
- * facilitates communication of statistics from domain threads to the stats
- * muncher thread.
+ * The state of one teller thread, or of one teller's state machine.
  */
-static int chid;
+struct teller_ctx
+{
+	struct bank_day *day; /* The day the teller works */
+	int tid; /* The teller's id, indexed at 0 */
+	struct rng rng; /* Draws the teller's breaks */
+	struct metbuf mb; /* Measurements not yet taken by the stat_muncher */
+
+	/* The state machine, kept between steps by the pooled simulation */
+	int state; /* One of the TELLER_ states below */
+	int coid; /* The connection to the stat_muncher's channel */
+	struct roster_duty duty; /* The teller's shift, lunch and breaks */
+	int twait_t0; /* The second the teller started waiting */
+	int twait; /* Seconds the teller waited for its customer */
+	int break_t0; /* The second the break started */
+	int lunch; /* Set if the break is the teller's lunch */
+	int cid; /* The customer being served, or -1 */
+
+	/*
+	 * Waiting on the mutex guarded line, by the teller thread. Rung, and
+	 * with -a handed customers, by the generator, so kept off the cache
+	 * lines above.
+	 */
+	struct evcount bell /* Rung by an arrival for this teller */
+			__attribute__((aligned(METBUF_CACHE_LINE)));
+	int idle_at; /* Where the teller is in the idle tellers, or -1 */
+	volatile int hand; /* One of the HAND_ states below (with -a) */
+	int idle_next; /* The teller below on the idle stack, or -1 */
+	volatile int mailbox; /* The customer handed over, or -1 */
+};
+
+#define TELLER_CLOCK_IN 0 /* Not at work yet */
+#define TELLER_WAITING 1 /* Parked until a customer shows up */
+#define TELLER_SERVING 2 /* In a transaction with customer cid */
+#define TELLER_BREAK 3 /* On a break, or at lunch */
+
+#define HAND_BUSY 0 /* Not on the idle stack */
+#define HAND_IDLE 1 /* On the idle stack, waiting for a customer */
+#define HAND_GONE 2 /* On the idle stack, but no longer waiting */
+
 #define MET_CUST_Q_ELAPSED 2 /* Pulse code indicating a queue wait time */
 #define MET_CUST_T_ELAPSED 3 /* Pulse code indicating a transaction time */
 #define MET_TELL_C_ELAPSED 4 /* Pulse code indicating a teller wait time */
 
-static void cust_gen(void); /* Thread function for the customer generator */
-static void teller(int *tid_ptr); /* Thread function for the tellers */
-static void stat_muncher(void); /* Thread function for the stats manager */
+#define MAX_WORKERS 4096 /* Most worker threads -j may ask for */
+#define MAX_REPS 100000000 /* Most days -r may ask for */
+
+/* Thread function for the customer generator */
+static void cust_gen(struct bank_day *day);
+/* Thread function for the tellers */
+static void teller(struct teller_ctx *tc);
+/* Thread function for the stats manager */
+static void stat_muncher(struct bank_day *day);
+/* Task function of the pooled simulation */
+static int pooled_step(void *arg, int task, int worker, int now, int *park);
+
+static void run_scenario(const struct scenario *sc, int virtual_time,
+		int pooled, long reps, const struct opt_spec *target,
+		int n_workers, unsigned int seed, int lockfree, int assign,
+		int batch, int log_mode, FILE *log_out, struct trace *trace,
+		int live_port);
+static void threaded_run_day(const struct scenario *sc, unsigned int seed,
+		int lockfree, int assign, int batch, int log_mode,
+		FILE *log_out, struct trace *trace, int live_port);
+static void pooled_run_day(const struct scenario *sc, unsigned int seed,
+		int n_workers, int lockfree, int batch, int log_mode,
+		FILE *log_out, struct trace *trace, int live_port);
+static void store_report(const struct customer_store *cs);
+static void region_report(const struct scenario *sc, uint64_t seed,
+		int n_workers);
+
+/*
+ * Parses the number of an option, a whole number from lo to hi, written in
+ * decimal digits only (no sign, blanks or hexadecimal).
+ *
+ * Return: 0 on success, -1 if str is not such a number
+ */
+static int parse_count(const char *str, long lo, long hi, long *count)
+{
+	if (!isdigit((unsigned char) str[0])) return -1;
+
+	char *end;
+	errno = 0;
+	long v = strtol(str, &end, 10);
+	if (*end != '\0' || errno == ERANGE || v < lo
+			|| v > hi) {
+		return -1;
+	}
+	*count = v;
+	return 0;
+}
 
 /**
- * Creates all the threads in the system. This function joins on all spawned
- * pthreads. Furthermore, the statistics pulse channel is allocated here.
+ * Parses the command line and runs the requested simulation.
+ *
+ * Usage: qnx-banking [-d | -l | -a] [-p] [-q | -R file] [-F format]
+ *                    [-T file] [-b batch] [-M port] [-r reps | -O target]
+ *                    [-j workers] [-s seed] [-S scenario ...]
+ *
+ *   -d         - simulate the day in virtual time (discrete-event) instead
+ *                of pacing it against the wall clock (a region's branches
+ *                are simulated on -j worker threads)
+ *   -l         - tellers share a lock-free line, instead of a line guarded
+ *                by a mutex
+ *   -a         - assign: each arrival is handed straight to an idle teller,
+ *                and only lined up if every teller is busy (threaded
+ *                simulation, on the mutex guarded line)
+ *   -p         - pooled: the generator and the tellers are state machines
+ *                stepped by -j worker threads, instead of a thread each
+ *   -q         - quiet: don't log any SIM> lines (also --quiet)
+ *   -R file    - write the event log's records raw to file, instead of
+ *                printing SIM> lines (wall-clock simulation only)
+ *   -F format  - the times of the SIM> lines: ampm (09:05:00 AM, the
+ *                default), iso (09:05:00) or raw (32700 seconds)
+ *   -T file    - record the day's customers and breaks into the binary
+ *                trace file (see trace.h and replay/bank-replay)
+ *   -b batch   - tellers ship their measurements to the stat_muncher in
+ *                batches of this many, up to MET_BATCH_MAX (defaults to
+ *                MET_BATCH_LEN, 1 sends one pulse per measurement)
+ *   -M port    - serve per-teller histograms in the Prometheus text format
+ *                on 127.0.0.1:port while the day runs (wall-clock
+ *                simulation only, see live.h)
+ *   -r reps    - simulate reps days in virtual time, and report the mean
+ *                and 95% confidence interval of each business metric
+ *   -O target  - search the teller counts, rosters and break policies for
+ *                the cheapest which meets a service level, such as
+ *                "p95=5m,cost=25" (see opt.h and opt.c)
+ *   -j workers - number of threads the days (or with -p, the tellers) are
+ *                simulated on (defaults to the number of processors)
+ *   -s seed    - seed for the simulation's random choices. With -d or -r
+ *                the same seed reproduces the same results, bit for bit
+ *   -S scenario - simulate the bank of a scenario file, or of a list of
+ *                assignments such as "tellers=4,arrive_hi=3m" (see
+ *                scenario.c). Given more than once, every scenario is
+ *                simulated in turn, with the same seed.
  */
 int main(int argc, char *argv[])
 {
+	int virtual_time = 0;
+	int pooled = 0;
+	int lockfree = 0;
+	int assign = 0;
+	int batch = MET_BATCH_LEN;
+	int log_mode = EVLOG_TEXT;
+	FILE *log_out = stdout;
+	const char *trace_path = NULL;
+	int time_fmt;
+	int live_port = 0;
+	long reps = 0;
+	struct opt_spec target;
+	int optimize = 0;
+	int n_workers = pool_default_workers();
+	unsigned int seed = (unsigned int) time(NULL);
+	struct scenario *scens = NULL;
+	int n_scens = 0;
+	long count;
+
+	int opt;
+	for (opt = 1; opt < argc; opt++) {
+		if (strcmp(argv[opt], "--quiet") == 0) argv[opt] = "-q";
+	}
+	while ((opt = getopt(argc, argv, "dlapqR:F:T:b:M:r:O:j:s:S:"))
+			!= -1) {
+		switch (opt)
+		{
+		case 'd':
+			virtual_time = 1;
+			break;
+		case 'l':
+			lockfree = 1;
+			break;
+		case 'a':
+			assign = 1;
+			break;
+		case 'p':
+			pooled = 1;
+			break;
+		case 'q':
+			log_mode = EVLOG_OFF;
+			break;
+		case 'R':
+			if ((log_out = fopen(optarg, "wb")) == NULL) {
+				perror(optarg);
+				return EXIT_FAILURE;
+			}
+			log_mode = EVLOG_RAW;
+			break;
+		case 'F':
+			if ((time_fmt = sim_time_fmt(optarg)) == -1) {
+				fprintf(stderr, "%s: bad time format '%s'\n",
+						argv[0], optarg);
+				return EXIT_FAILURE;
+			}
+			sim_set_time_fmt(time_fmt);
+			break;
+		case 'T':
+			trace_path = optarg;
+			break;
+		case 'b':
+			if (parse_count(optarg, 1, MET_BATCH_MAX, &count)
+					== -1) {
+				fprintf(stderr, "%s: bad batch '%s'\n", argv[0],
+						optarg);
+				return EXIT_FAILURE;
+			}
+			batch = (int) count;
+			break;
+		case 'M':
+			if (parse_count(optarg, 1, 65535, &count) == -1) {
+				fprintf(stderr, "%s: bad port '%s'\n", argv[0],
+						optarg);
+				return EXIT_FAILURE;
+			}
+			live_port = (int) count;
+			break;
+		case 'r':
+			if (parse_count(optarg, 1, MAX_REPS, &reps) == -1) {
+				fprintf(stderr, "%s: bad repetitions '%s'\n",
+						argv[0], optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'O':
+#ifdef SCENARIO_FIXED
+			fprintf(stderr, "%s: built with SCENARIO_FIXED, the "
+				"staffing can't be changed\n", argv[0]);
+			return EXIT_FAILURE;
+#endif
+			if (opt_parse(&target, optarg) == -1) {
+				return EXIT_FAILURE;
+			}
+			optimize = 1;
+			break;
+		case 'j':
+			if (parse_count(optarg, 1, MAX_WORKERS, &count) == -1) {
+				fprintf(stderr, "%s: bad worker count '%s'\n",
+						argv[0], optarg);
+				return EXIT_FAILURE;
+			}
+			n_workers = (int) count;
+			break;
+		case 's':
+			seed = (unsigned int) strtoul(optarg, NULL, 0);
+			break;
+		case 'S':
+			scens = realloc(scens, (n_scens + 1)
+					* sizeof(struct scenario));
+			if (scens == NULL) {
+				perror("CON> Error allocating scenarios");
+				return EXIT_FAILURE;
+			}
+			if (scenario_load(&scens[n_scens++], optarg) == -1) {
+				return EXIT_FAILURE;
+			}
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-d | -l | -a] [-p] "
+				"[-q | -R file] [-F format] [-T file] "
+				"[-b batch] [-M port] [-r reps | -O target] "
+				"[-j workers] [-s seed] [-S scenario ...]\n",
+					argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* Without a scenario, simulate the bank of the assignment */
+	if (n_scens == 0) {
+		if ((scens = malloc(sizeof(struct scenario))) == NULL) {
+			perror("CON> Error allocating scenarios");
+			return EXIT_FAILURE;
+		}
+		scenario_init(&scens[n_scens++]);
+	}
+	if (trace_path != NULL && n_scens > 1) {
+		fprintf(stderr, "%s: -T records a single scenario\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (trace_path != NULL && reps > 0) {
+		fprintf(stderr, "%s: -T records a single day, without -r\n",
+				argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (optimize) {
+		if (reps > 0 || trace_path != NULL) {
+			fprintf(stderr, "%s: -O runs days of its own, without "
+				"-r or -T\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		virtual_time = 1;
+	}
+	if (assign && (lockfree || pooled)) {
+		fprintf(stderr, "%s: -a hands customers to teller threads, "
+			"without -l or -p\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (live_port != 0 && (virtual_time || reps > 0)) {
+		fprintf(stderr, "%s: -M serves wall-clock days only\n",
+				argv[0]);
+		return EXIT_FAILURE;
+	}
+	int i;
+	for (i = 0; i < n_scens; i++) {
+		const struct scenario *sc = SCENARIO(&scens[i]);
+		if (sc->n_branches == 1 && sc->n_queues == 1) continue;
+
+		if (!virtual_time && reps == 0) {
+			fprintf(stderr, "%s: branches and queues are only "
+				"simulated in virtual time (-d or -r)\n",
+					argv[0]);
+			return EXIT_FAILURE;
+		}
+		if (trace_path != NULL && sc->n_branches > 1) {
+			fprintf(stderr, "%s: -T records a single branch\n",
+					argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
 	printf("CON> Entered main().\n");
 
+	struct trace trace;
+	struct trace *tr = NULL;
+	if (trace_path != NULL) {
+		int n_tellers = SCENARIO(&scens[0])->n_tellers;
+		int n_bufs = virtual_time ? 1 : pooled ? n_workers : n_tellers;
+		if (trace_open(&trace, trace_path, n_bufs, n_tellers,
+				seed) == -1) {
+			perror(trace_path);
+			return EXIT_FAILURE;
+		}
+		tr = &trace;
+	}
+
+	for (i = 0; i < n_scens; i++) {
+		run_scenario(&scens[i], virtual_time, pooled, reps,
+				optimize ? &target : NULL, n_workers, seed,
+				lockfree, assign, batch, log_mode, log_out,
+				tr, live_port);
+	}
+	free(scens);
+
+	if (log_out != stdout) fclose(log_out);
+	if (tr != NULL && trace_close(tr) == -1) {
+		perror(trace_path);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ * Simulates the bank of one scenario in the mode selected on the command
+ * line (see main()), and reports how long the simulation took.
+ */
+static void run_scenario(const struct scenario *sc, int virtual_time,
+		int pooled, long reps, const struct opt_spec *target,
+		int n_workers, unsigned int seed, int lockfree, int assign,
+		int batch, int log_mode, FILE *log_out, struct trace *trace,
+		int live_port)
+{
+	scenario_print(SCENARIO(sc));
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	if (target != NULL) {
+		opt_run(SCENARIO(sc), target, n_workers, seed);
+	} else if (reps > 0) {
+		struct metrics_agg agg;
+		struct bank_stats pool;
+
+		printf("CON> Simulating %ld days on %d workers (seed %u).\n",
+				reps, n_workers, seed);
+		mc_run(sc, reps, n_workers, seed, &agg, &pool);
+		metrics_agg_print(&agg);
+		bank_stats_print(&pool);
+	} else if (virtual_time && SCENARIO(sc)->n_branches > 1) {
+		region_report(sc, seed, n_workers);
+	} else if (virtual_time) {
+		struct bank_metrics met;
+		struct bank_stats st;
+		struct customer_store store;
+
+		printf("CON> Simulating in virtual time (seed %u).\n", seed);
+		customer_store_init(&store);
+		bank_stats_init(&st);
+		des_run_day(sc, seed, log_mode != EVLOG_OFF, &store, &met, &st,
+				trace);
+		metrics_print(&met);
+		bank_stats_print(&st);
+		store_report(&store);
+		customer_store_destroy(&store);
+	} else if (pooled) {
+		pooled_run_day(sc, seed, n_workers, lockfree, batch, log_mode,
+				log_out, trace, live_port);
+	} else {
+		threaded_run_day(sc, seed, lockfree, assign, batch, log_mode,
+				log_out, trace, live_port);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	printf("CON> Simulation took %ld us.\n",
+			(t1.tv_sec - t0.tv_sec) * 1000000
+					+ (t1.tv_nsec - t0.tv_nsec) / 1000);
+}
+
+/*
+ * Sets up the state of a day of the bank of scenario sc in wall-clock time,
+ * shared by the threaded and the pooled simulation: the lines, the customer
+ * store and draws, the tellers, the statistics pulse channel, and the event
+ * log, with n_rings rings. If live_port is not 0, the day's live metrics are
+ * served on it until the day is closed (see live.h). Errors are printed.
+ * Returns 0, or -1 on failure (with nothing left set up).
+ *
+ * The customers' arrivals and transaction times are drawn from stream 0 of
+ * the provided seed, and teller n draws its breaks from stream n. Tellers
+ * ship their measurements in batches of batch records, and work the shifts
+ * of the scenario's roster.
+ */
+static int bank_day_open(struct bank_day *day, const struct scenario *sc,
+		unsigned int seed, int lockfree, int batch, int log_mode,
+		FILE *log_out, int n_rings, struct trace *trace, int live_port)
+{
+	int n_tellers = sc->n_tellers;
+
+	day->sc = sc;
+	if (customer_q_init(&day->line) == -1) {
+		perror("CON> Error allocating the line");
+		return -1;
+	}
+	pthread_mutex_init(&day->queue_mutex, NULL);
+#ifdef LOCKSTAT
+	lockstat_init(&day->queue_stat, qsite_names,
+			sizeof(qsite_names) / sizeof(qsite_names[0]));
+#endif
+	day->lockfree = lockfree;
+	day->max_cust = scenario_max_customers(sc);
+	evcount_init(&day->line_ec);
+	customer_store_init(&day->store);
+	day->trace = trace;
+	day->live = NULL;
+	day->gen_cid = -1;
+	day->n_idle = 0;
+	day->assign = 0;
+	day->idle_top = -1;
+	day->n_handed = 0;
+	day->n_vcsw = 0;
+	day->n_ivcsw = 0;
+
+	if (customer_lfq_init(&day->lfq, day->max_cust) == -1) {
+		perror("CON> Error allocating the lock-free line");
+		goto fail_line;
+	}
+
+	/* One allocation holds the draws and the idle tellers */
+	day->arrive = malloc((2 * day->max_cust + n_tellers) * sizeof(int));
+	if (day->arrive == NULL) {
+		perror("CON> Error allocating customer draws");
+		goto fail_lfq;
+	}
+	day->transt = day->arrive + day->max_cust;
+	day->idle = day->transt + day->max_cust;
+	scenario_draw_day(sc, seed, day->arrive, day->transt);
+
+	/* The generator makes customers while tellers read the columns */
+	if (customer_store_reserve(&day->store, day->max_cust) == -1) {
+		perror("CON> Error allocating the customer store");
+		goto fail_store;
+	}
+
+	if (posix_memalign((void **) &day->tellers, METBUF_CACHE_LINE,
+			n_tellers * sizeof(struct teller_ctx))) {
+		perror("CON> Error allocating tellers");
+		goto fail_store;
+	}
+	memset(day->tellers, 0, n_tellers * sizeof(struct teller_ctx));
+	if (roster_init(&day->roster, sc) == -1) {
+		perror("CON> Error allocating the roster");
+		goto fail_roster;
+	}
+
+	int tid;
+	for (tid = 0; tid < n_tellers; tid++) {
+		struct teller_ctx *tc = &day->tellers[tid];
+		tc->day = day;
+		tc->tid = tid;
+		tc->state = TELLER_CLOCK_IN;
+		rng_seed(&tc->rng, seed, tid + 1);
+		if (metbuf_init(&tc->mb, batch) == -1) {
+			perror("CON> Error allocating measurement buffers");
+			goto fail_tellers;
+		}
+		roster_duty_init(sc, tid, &tc->duty);
+		evcount_init(&tc->bell);
+		tc->idle_at = -1;
+		tc->hand = HAND_BUSY;
+		tc->cid = -1;
+		tc->mailbox = -1;
+	}
+
+	if (chan_create(&day->chan, n_tellers) == -1) {
+		perror("CON> Error creating statistics channel");
+		goto fail_tellers;
+	}
 	printf("CON> Created statistics channel.\n");
-	chid = ChannelCreate(_NTO_CHF_DISCONNECT);
+
+	if (evlog_open(&day->log, n_rings, log_mode, log_out) == -1) {
+		perror("CON> Error opening event log");
+		goto fail_chan;
+	}
+
+	if (live_port != 0) {
+		day->live = malloc(sizeof(struct live));
+		if (day->live == NULL || live_init(day->live, n_tellers) == -1
+				|| live_serve(day->live, live_port) == -1) {
+			perror("CON> Error serving live metrics");
+			if (day->live != NULL) live_destroy(day->live);
+			free(day->live);
+			day->live = NULL;
+			goto fail_log;
+		}
+		printf("CON> Serving live metrics on "
+			"http://127.0.0.1:%d/metrics\n", live_port);
+	}
+
+	return 0;
+
+	/* Undo what was set up, latest first */
+fail_log:
+	evlog_close(&day->log);
+fail_chan:
+	chan_destroy(&day->chan);
+fail_tellers:
+	while (tid-- > 0) {
+		metbuf_destroy(&day->tellers[tid].mb);
+		evcount_destroy(&day->tellers[tid].bell);
+	}
+	roster_destroy(&day->roster);
+fail_roster:
+	free(day->tellers);
+fail_store:
+	customer_store_destroy(&day->store);
+	free(day->arrive);
+fail_lfq:
+	customer_lfq_destroy(&day->lfq);
+fail_line:
+	evcount_destroy(&day->line_ec);
+	customer_q_destroy(&day->line);
+	pthread_mutex_destroy(&day->queue_mutex);
+	return -1;
+}
+
+/*
+ * Frees the state of a day. Every thread of the day must have been joined.
+ */
+static void bank_day_close(struct bank_day *day)
+{
+	if (day->live != NULL) {
+		live_stop(day->live);
+		printf("CON> Served live metrics %ld times.\n",
+				day->live->n_scrapes);
+		live_destroy(day->live);
+		free(day->live);
+	}
+
+	chan_destroy(&day->chan);
+
+#ifdef LOCKSTAT
+	if (!day->lockfree) lockstat_print(&day->queue_stat, "queue_mutex");
+#endif
+
+	/* Free the mutex and eventcounts */
+	pthread_mutex_destroy(&day->queue_mutex);
+	evcount_destroy(&day->line_ec);
+
+	/* Free the lines, and all customers allocated through the simulation */
+	customer_q_destroy(&day->line);
+	customer_lfq_destroy(&day->lfq);
+	store_report(&day->store);
+	customer_store_destroy(&day->store);
+
+	if (day->sc->max_off > 0) {
+		printf("CON> The roster put off %ld breaks and lunches.\n",
+				day->roster.n_deferred);
+	}
+	roster_destroy(&day->roster);
+
+	int tid;
+	for (tid = 0; tid < day->sc->n_tellers; tid++) {
+		metbuf_destroy(&day->tellers[tid].mb);
+		evcount_destroy(&day->tellers[tid].bell);
+	}
+	free(day->tellers);
+	free(day->arrive);
+}
+
+/*
+ * Simulates one day of the bank of scenario sc in wall-clock time. Creates
+ * all the threads in the system, and joins on all spawned pthreads.
+ * Furthermore, the statistics pulse channel is allocated here.
+ *
+ * The day is seeded and set up as described at bank_day_open(). If
+ * lockfree is set, the tellers share the lock-free line. If assign is set,
+ * arrivals are handed straight to idle tellers instead. The event log is
+ * opened with log_mode, and written to log_out. If trace is not NULL,
+ * teller n records the day into the trace as its recording thread n.
+ */
+static void threaded_run_day(const struct scenario *sc, unsigned int seed,
+		int lockfree, int assign, int batch, int log_mode,
+		FILE *log_out, struct trace *trace, int live_port)
+{
+	sc = SCENARIO(sc);
+	int n_tellers = sc->n_tellers;
+
+	struct bank_day day;
+	if (bank_day_open(&day, sc, seed, lockfree, batch, log_mode, log_out,
+			LOG_THREADS(sc), trace, live_port) == -1) {
+		return;
+	}
+	day.assign = assign;
 
 	pthread_attr_t thd_attr;
 	pthread_attr_init(&thd_attr);
@@ -110,22 +807,20 @@ int main(int argc, char *argv[])
 	/* Create the stats muncher thread */
 	pthread_t stat_muncher_thd;
 	pthread_create(&stat_muncher_thd, &thd_attr, (void *) stat_muncher,
-			NULL);
+			&day);
 	printf("CON> stat_muncher_thd created.\n");
 
 	/* Create the customer generator thread */
 	pthread_t cust_gen_thd;
-	pthread_create(&cust_gen_thd, &thd_attr, (void *) cust_gen, NULL);
+	pthread_create(&cust_gen_thd, &thd_attr, (void *) cust_gen, &day);
 	printf("CON> cust_gen_thd created.\n");
 
 	/* Create the teller threads */
-	pthread_t teller_thd[NUM_TELLERS];
+	pthread_t *teller_thd = malloc(n_tellers * sizeof(pthread_t));
 	int tid;
-	int tids[NUM_TELLERS];
-	for (tid = 0; tid < NUM_TELLERS; tid++) {
-		tids[tid] = tid;
+	for (tid = 0; tid < n_tellers; tid++) {
 		pthread_create(&teller_thd[tid], &thd_attr, (void *) teller,
-				&tids[tid]);
+				&day.tellers[tid]);
 
 		printf("CON> teller_thd[%d] created.\n", tid);
 	}
@@ -134,197 +829,793 @@ int main(int argc, char *argv[])
 	pthread_join(cust_gen_thd, NULL);
 	printf("CON> cust_gen_thd joined.\n");
 
-	for (tid = 0; tid < NUM_TELLERS; tid++) {
+	for (tid = 0; tid < n_tellers; tid++) {
 		pthread_join(teller_thd[tid], NULL);
 		printf("CON> teller_thd[%d] joined.\n", tid);
 	}
+	free(teller_thd);
+
+	/* Nobody logs anymore, print the remaining SIM> lines */
+	evlog_close(&day.log);
 
 	pthread_join(stat_muncher_thd, NULL);
 	printf("CON> stat_muncher_thd joined.\n");
 
-	/* Free the condition variable and mutex */
-	pthread_cond_destroy(&queue_cond);
-	pthread_mutex_destroy(&queue_mutex);
+#ifdef RUSAGE_THREAD
+	printf("CON> The generator and tellers switched context %ld times "
+		"(%ld involuntarily).\n", day.n_vcsw + day.n_ivcsw,
+			day.n_ivcsw);
+#endif
+	if (assign) {
+		printf("CON> Handed %ld customers straight to a teller, lined "
+			"up %ld.\n", day.n_handed,
+				day.store.allocs - day.n_handed);
+	}
+	bank_day_close(&day);
+}
+
+/*
+ * Simulates one day of the bank of scenario sc in wall-clock time, as
+ * threaded_run_day() does, but with the generator and the tellers stepped as
+ * state machines by n_workers worker threads (see tsched.h). Only the
+ * stat_muncher (and the event log's drain) run on threads of their own.
+ *
+ * If trace is not NULL, worker n records the day into the trace as its
+ * recording thread n.
+ */
+static void pooled_run_day(const struct scenario *sc, unsigned int seed,
+		int n_workers, int lockfree, int batch, int log_mode,
+		FILE *log_out, struct trace *trace, int live_port)
+{
+	sc = SCENARIO(sc);
+	if (n_workers < 1) n_workers = 1;
 
-	/* Free all customers allocated through the simulation */
-	customer_free_all();
+	struct bank_day day;
+	if (bank_day_open(&day, sc, seed, lockfree, batch, log_mode, log_out,
+			n_workers, trace, live_port) == -1) {
+		return;
+	}
+	if (tsched_init(&day.ts, sc->n_tellers + 1, sc->sec_open, pooled_step,
+			&day) == -1) {
+		perror("CON> Error allocating the scheduler");
+		evlog_close(&day.log);
+		bank_day_close(&day);
+		return;
+	}
 
-	return EXIT_SUCCESS;
+	/* Create the stats muncher thread */
+	pthread_t stat_muncher_thd;
+	pthread_create(&stat_muncher_thd, NULL, (void *) stat_muncher, &day);
+	printf("CON> stat_muncher_thd created.\n");
+
+	/* The generator starts as the bank opens, a teller with its shift */
+	int tid;
+	for (tid = 0; tid < sc->n_tellers; tid++) {
+		tsched_at(&day.ts, tid, day.tellers[tid].duty.sec_in);
+	}
+	tsched_at(&day.ts, TASK_GEN(sc), sc->sec_open);
+
+	printf("CON> Stepping %d tellers on %d workers.\n", sc->n_tellers,
+			n_workers);
+	if (tsched_run(&day.ts, n_workers) == -1) {
+		perror("CON> Error starting a worker");
+	}
+	printf("CON> Took %ld steps, woke %ld parked tellers.\n",
+			day.ts.n_steps, day.ts.n_wakes);
+
+	/* Nobody logs anymore, print the remaining SIM> lines */
+	evlog_close(&day.log);
+
+	pthread_join(stat_muncher_thd, NULL);
+	printf("CON> stat_muncher_thd joined.\n");
+
+	tsched_destroy(&day.ts);
+	bank_day_close(&day);
+}
+
+/*
+ * Simulates a day of a region in virtual time, and prints what happened in
+ * each branch, and the region's metrics.
+ */
+static void region_report(const struct scenario *sc, uint64_t seed,
+		int n_workers)
+{
+	int n_branches = SCENARIO(sc)->n_branches;
+	struct des_counts *counts = malloc(n_branches * sizeof(*counts));
+	if (counts == NULL) {
+		perror("CON> Error allocating branches");
+		return;
+	}
+
+	struct bank_metrics met;
+	struct bank_stats st;
+	bank_stats_init(&st);
+
+	printf("CON> Simulating %d branches in virtual time on %d workers "
+		"(seed %u).\n", n_branches, min(n_workers, n_branches),
+			(unsigned int) seed);
+	region_run_day(sc, seed, n_workers, &met, &st, counts);
+
+	int b;
+	for (b = 0; b < n_branches; b++) {
+		printf("CON> Branch %d: served %ld (%ld from other lines), "
+			"sent %ld on, received %ld.\n", b + 1,
+				counts[b].served, counts[b].stolen,
+				counts[b].xfer_out, counts[b].xfer_in);
+	}
+	metrics_print(&met);
+	bank_stats_print(&st);
+	free(counts);
+}
+
+/*
+ * Prints a line of the exact distribution of the spans hi - lo of a day's
+ * served customers, read off the columns of the store.
+ */
+static void store_report_spans(const char *name, const int *hi,
+		const int *lo, const struct customer_store *cs)
+{
+	struct customer_spans sp;
+	customer_spans_reduce(hi, lo, cs->dequeue_sec, cs->n_cust, &sp);
+
+	printf("CON>\t%30s | %6d %6d %6d | %6d %8.1f\n", name,
+		customer_spans_quantile(hi, lo, cs->dequeue_sec, cs->n_cust,
+				&sp, 0.50),
+		customer_spans_quantile(hi, lo, cs->dequeue_sec, cs->n_cust,
+				&sp, 0.95),
+		customer_spans_quantile(hi, lo, cs->dequeue_sec, cs->n_cust,
+				&sp, 0.99),
+		sp.max, sp.n ? (double) sp.sum / sp.n : 0.0);
+}
+
+/*
+ * Prints the size of a day's customer store, and the exact distribution of
+ * its customers' queue and transaction times, as analysed from the store at
+ * the end of the day.
+ */
+static void store_report(const struct customer_store *cs)
+{
+	printf("CON> Customer store: %ld customers, %lu bytes reserved.\n",
+			cs->allocs, (unsigned long) cs->bytes_reserved);
+	printf("CON>\t%30s |    p50    p95    p99 |    max     mean\n",
+			"Exactly, from the store");
+	store_report_spans("Queue time (s)", cs->dequeue_sec,
+			cs->enqueue_sec, cs);
+	store_report_spans("Transaction time (s)", cs->time_with_teller,
+			NULL, cs);
+}
+
+/*
+ * Adds the context switches of the calling thread, which is done with the
+ * day, to the day's count. Only counted where the system counts them per
+ * thread.
+ */
+static void day_count_csw(struct bank_day *day)
+{
+#ifdef RUSAGE_THREAD
+	struct rusage ru;
+	if (getrusage(RUSAGE_THREAD, &ru) == -1) return;
+
+	__atomic_fetch_add(&day->n_vcsw, ru.ru_nvcsw, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&day->n_ivcsw, ru.ru_nivcsw, __ATOMIC_RELAXED);
+#endif
+}
+
+/*
+ * Registers a teller as idle on the mutex guarded line, such that the next
+ * arrival rings its bell. Called with queue_mutex held.
+ */
+static void teller_idle(struct teller_ctx *tc)
+{
+	struct bank_day *day = tc->day;
+
+	tc->idle_at = day->n_idle;
+	day->idle[day->n_idle++] = tc->tid;
+}
+
+/*
+ * Takes a teller off the idle tellers, if it is still one of them. Called
+ * with queue_mutex held.
+ */
+static void teller_unidle(struct teller_ctx *tc)
+{
+	struct bank_day *day = tc->day;
+	if (tc->idle_at == -1) return;
+
+	/* The last one idle fills the hole */
+	int last = day->idle[--day->n_idle];
+	day->idle[tc->idle_at] = last;
+	day->tellers[last].idle_at = tc->idle_at;
+	tc->idle_at = -1;
+}
+
+/*
+ * Picks the idle teller which an arrival wakes: the one which went idle
+ * last, as its thread is the likeliest to still be warm. Called with
+ * queue_mutex held; the teller's bell is best rung once it is released.
+ * Returns the teller, or NULL if every teller is busy.
+ */
+static struct teller_ctx *teller_pick_idle(struct bank_day *day)
+{
+	if (day->n_idle == 0) return NULL;
+
+	struct teller_ctx *tc = &day->tellers[day->idle[day->n_idle - 1]];
+	teller_unidle(tc);
+	return tc;
+}
+
+/*
+ * Pushes a teller onto the idle stack of the day. As only the generator pops
+ * the stack, a teller can't be popped and pushed back while the generator
+ * pops it (there is no ABA).
+ */
+static void hand_push(struct bank_day *day, struct teller_ctx *tc)
+{
+	int top = __atomic_load_n(&day->idle_top, __ATOMIC_RELAXED);
+	do {
+		tc->idle_next = top;
+	} while (!__atomic_compare_exchange_n(&day->idle_top, &top, tc->tid,
+			1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+ * Pops the teller on top of the idle stack. Only called by the generator.
+ * Returns the teller, or NULL if the stack is empty.
+ */
+static struct teller_ctx *hand_pop(struct bank_day *day)
+{
+	int top = __atomic_load_n(&day->idle_top, __ATOMIC_ACQUIRE);
+	while (top != -1 && !__atomic_compare_exchange_n(&day->idle_top,
+			&top, day->tellers[top].idle_next, 1,
+			__ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+		/* A teller pushed itself meanwhile, pop that one */
+	}
+	return top == -1 ? NULL : &day->tellers[top];
+}
+
+/*
+ * Makes a teller wait on the idle stack, for the generator to hand it a
+ * customer. A teller which stopped waiting may still be on the stack, and
+ * waits again where it is. Called with queue_mutex held, after finding the
+ * line empty: the generator lines up a customer with the mutex held too,
+ * and only if it finds no teller waiting.
+ */
+static void hand_wait(struct bank_day *day, struct teller_ctx *tc)
+{
+	int gone = HAND_GONE;
+	if (__atomic_compare_exchange_n(&tc->hand, &gone, HAND_IDLE, 0,
+			__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+
+	/* The generator dropped the teller off the stack */
+	__atomic_store_n(&tc->hand, HAND_IDLE, __ATOMIC_RELAXED);
+	hand_push(day, tc);
+}
+
+/*
+ * Stops a teller waiting on the idle stack, unless the generator handed it
+ * a customer first. The teller stays on the stack, until the generator
+ * drops it or it waits again. Returns the customer, or -1.
+ */
+static int hand_leave(struct teller_ctx *tc)
+{
+	int idle = HAND_IDLE;
+	if (__atomic_compare_exchange_n(&tc->hand, &idle, HAND_GONE, 0,
+			__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return -1;
+	}
+
+	/* The customer was put in the mailbox before the hand-off */
+	int cid = tc->mailbox;
+	tc->mailbox = -1;
+	return cid;
+}
+
+/*
+ * Hands a customer over to the teller on top of the idle stack. Tellers
+ * which stopped waiting are dropped off the stack on the way. The teller's
+ * bell must be rung afterwards. Only called by the generator.
+ *
+ * Returns the teller, or NULL if no teller waits.
+ */
+static struct teller_ctx *hand_over(struct bank_day *day, int cid)
+{
+	struct teller_ctx *tc;
+	while ((tc = hand_pop(day)) != NULL) {
+		tc->mailbox = cid;
+		for (;;) {
+			int idle = HAND_IDLE;
+			if (__atomic_compare_exchange_n(&tc->hand, &idle,
+					HAND_BUSY, 0, __ATOMIC_ACQ_REL,
+					__ATOMIC_ACQUIRE)) {
+				return tc;
+			}
+
+			/* Unless the teller waits again meanwhile, drop it */
+			int gone = HAND_GONE;
+			if (__atomic_compare_exchange_n(&tc->hand, &gone,
+					HAND_BUSY, 0, __ATOMIC_ACQ_REL,
+					__ATOMIC_ACQUIRE)) {
+				break;
+			}
+		}
+		tc->mailbox = -1;
+	}
+	return NULL;
+}
+
+/*
+ * Hands an arrival at sim_sec straight to a waiting teller, if there is one,
+ * and wakes it. Returns 1 if the customer was handed over, or 0 if it must
+ * line up.
+ */
+static int gen_hand_over(struct bank_day *day, int cid, int sim_sec)
+{
+	day->store.enqueue_sec[cid] = sim_sec;
+	struct teller_ctx *tc = hand_over(day, cid);
+	if (tc == NULL) return 0;
+
+	/* The line is empty, while a teller waits */
+	day->n_handed++;
+	if (day->live) live_arrival(day->live, sim_sec, 0);
+	evlog_put(&day->log, LOG_GEN, EVL_CUST_HAND, sim_sec, tc->tid, cid);
+
+	evcount_notify_one(&tc->bell);
+	return 1;
 }
 
 /*
  * The cust_gen function backs the customer generator thread. Between the time
  * of bank open and close, it continually tries to add more customers to the
  * queue. It does this every 1 to 4 minutes. Whenever a new customer is pushed
- * to the queue, this thread must notify the tellers such that they wake up.
+ * to the queue, this thread must notify a teller such that it wakes up. Only
+ * one idle teller is woken per customer: on the mutex guarded line, the one
+ * which went idle last, and on the lock-free line, any of them. With -a, a
+ * customer finding an idle teller doesn't line up at all, but is handed to
+ * the teller directly.
  *
  * At the end of the day, this thread is responsible for waking the tellers up
  * one more time. Otherwise, the tellers will get stuck waiting (when no more
  * customers will show up).
  */
-static void cust_gen()
+static void cust_gen(struct bank_day *day)
 {
-	unsigned int thd_seed; /* thread storage for sim_choice() */
+	const struct scenario *sc = SCENARIO(day->sc);
 	struct timespec thd_stamp; /* thread storage for sim_elaps... */
-	char thd_buf[40]; /* thread storage for sim_fmt_time() */
+	struct evlog *log = &day->log;
 
-	int sim_sec = SEC_AT_BANK_OPEN; /* current second of the simulation */
+	int sim_sec = sc->sec_open; /* current second of the simulation */
 
-	sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-	printf("%s bank opens.\n", thd_buf);
+	evlog_put(log, LOG_GEN, EVL_BANK_OPEN, sim_sec, -1, -1);
 
 	int cur_cid = 0;
 	int sec_til_close;
-	while ((sec_til_close = SEC_AT_BANK_CLOSE - sim_sec) > 0) {
+	while ((sec_til_close = sc->sec_close - sim_sec) > 0
+			&& cur_cid < day->max_cust) {
 		/* Wait for the next customer to arrive */
-		int arrival = sim_choose(&thd_seed, ARRIVE_LO, ARRIVE_HI);
+		int arrival = day->arrive[cur_cid];
 		sim_sleep(arrival, &sim_sec);
 
-		struct customer *next = customer_make(cur_cid++);
+		int next = customer_store_make(&day->store, cur_cid++);
+		day->store.time_with_teller[next] = day->transt[next];
 
-		sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-		printf("%s customer %03d enters the bank.\n", thd_buf,
-				next->cid);
+		evlog_put(log, LOG_GEN, EVL_CUST_ENTER, sim_sec, -1, next);
+
+		if (day->lockfree) {
+			day->store.enqueue_sec[next] = sim_sec;
+			if (day->live) {
+				live_arrival(day->live, sim_sec,
+						customer_lfq_depth(&day->lfq));
+			}
+			while (customer_lfq_push(&day->lfq, next) == -1) {
+				sched_yield(); /* Line is full, tellers poll */
+			}
+
+			evlog_put(log, LOG_GEN, EVL_CUST_LINE, sim_sec, -1,
+					next);
+
+			evcount_notify_one(&day->line_ec); /* Wake one */
+			continue;
+		}
+
+		/* Skip the line if a teller is waiting */
+		if (day->assign && gen_hand_over(day, next, sim_sec)) continue;
 
 		/* Gain access to the queue and push the newly arrived cust */
 		sim_elaps_init(&thd_stamp);
-		pthread_mutex_lock(&queue_mutex); /* Get lock */
+		LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+				QSITE_GEN_PUSH); /* Get lock */
 		sim_elaps_calc(&thd_stamp, &sim_sec);
 
+		/* A teller may have started waiting before the lock was got */
+		if (day->assign && gen_hand_over(day, next, sim_sec)) {
+			LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+			continue;
+		}
+
 		/* Do mutually exclusive work - enqueue the customer */
-		next->enqueue_sec = sim_sec;
-		customer_q_push(next);
+		day->store.enqueue_sec[next] = sim_sec;
+		if (day->live) {
+			live_arrival(day->live, sim_sec,
+					customer_q_depth(&day->line));
+		}
+		if (customer_q_push(&day->line, next) == -1) {
+			/* The customer is turned away, never to be served */
+			LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+			perror("CON> Error growing the line");
+			continue;
+		}
+
+		evlog_put(log, LOG_GEN, EVL_CUST_LINE, sim_sec, -1, next);
 
-		sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-		printf("%s customer %03d enters the teller line.\n", thd_buf,
-				next->cid);
+		struct teller_ctx *tc = teller_pick_idle(day);
+		LOCKSTAT_UNLOCK(&day->queue_stat,
+				&day->queue_mutex); /* Release lock */
 
-		pthread_cond_broadcast(&queue_cond); /* Broadcast */
-		pthread_mutex_unlock(&queue_mutex); /* Release lock */
+		if (tc != NULL) evcount_notify_one(&tc->bell); /* Wake one */
 	}
 
 	/*
 	 * The bank is about to close. Plug the queue and notify tellers such
 	 * that blocked tellers don't wait forever!
 	 */
-	pthread_mutex_lock(&queue_mutex);
-	customer_q_plug();
-	pthread_cond_broadcast(&queue_cond);
-	pthread_mutex_unlock(&queue_mutex);
+	if (day->lockfree) {
+		customer_lfq_plug(&day->lfq);
+		evcount_notify_all(&day->line_ec);
+	} else {
+		LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+				QSITE_GEN_PLUG);
+		customer_q_plug(&day->line);
+
+		struct teller_ctx *tc;
+		while ((tc = teller_pick_idle(day)) != NULL) {
+			evcount_notify_one(&tc->bell);
+		}
 
-	sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-	printf("%s bank closes.\n", thd_buf);
+		/* Tellers waiting on the idle stack see the plug once woken */
+		int tid;
+		for (tid = 0; day->assign && tid < sc->n_tellers; tid++) {
+			evcount_notify_one(&day->tellers[tid].bell);
+		}
+		LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+	}
+
+	evlog_put(log, LOG_GEN, EVL_BANK_CLOSE, sim_sec, -1, -1);
+	day_count_csw(day);
 }
 
 /*
- * The teller function backs each of the the teller threads. Between the time
- * of bank open and close, it continually tries to pull customers off the queue.
- * After obtaining a customer, the teller will perform the transaction (by
- * sleeping). While doing all this, the teller will communicate with the stats
- * muncher thread, updating its accounting of measurements.
- *
- * Params: tid_ptr - A pointer to this threads' id
+ * Stamps the second a customer left the line, by the teller's clock. The
+ * generator stamped its arrival by its own clock, which the teller's may lag
+ * by a little: a customer never leaves before it arrived.
  */
-static void teller(int *tid_ptr)
+static void teller_dequeue(struct bank_day *day, int cid, int sim_sec)
 {
-	int tid = *tid_ptr + 1; /* Print out a tid indexed at 1 */
+	int *enqueue_sec = day->store.enqueue_sec;
+	day->store.dequeue_sec[cid] = sim_sec < enqueue_sec[cid]
+			? enqueue_sec[cid] : sim_sec;
+}
 
-	/* Attach to the stat_muncher's channel */
-	int coid = ConnectAttach(0, (pid_t) 0, chid, 0 | _NTO_SIDE_CHANNEL, 0);
+/*
+ * Ships the measurements a teller still holds back, before it sleeps: an
+ * idle teller adds none, and would otherwise hold them until it works again.
+ */
+static void teller_ship(struct teller_ctx *tc)
+{
+	metbuf_flush(&tc->mb, &tc->day->chan, tc->coid, tc->tid);
+}
+
+/*
+ * Computes the absolute (CLOCK_REALTIME) time at which a waiting teller must
+ * wake up again: after wake_after simulated seconds. The nanoseconds are
+ * summed in 64 bits, as a wait of hours overflows a 32-bit long.
+ */
+static void teller_deadline(struct timespec *wake_after_ts, int wake_after)
+{
+	clock_gettime(CLOCK_REALTIME, wake_after_ts);
 
-	unsigned int thd_seed; /* thread storage for sim_choice() */
+	int64_t nanos = wake_after_ts->tv_nsec
+			+ (int64_t) wake_after * NSC_PER_SIM_SEC;
+	wake_after_ts->tv_sec += (time_t) (nanos / 1000000000);
+	wake_after_ts->tv_nsec = (long) (nanos % 1000000000);
+}
+
+/*
+ * Waits on the mutex guarded line until a customer can be polled, the bank
+ * is empty and closed, or the second until, when the roster wants the
+ * teller (see roster_due()). The time spent waiting is accounted to sim_sec.
+ *
+ * The teller sleeps on its own bell, with the mutex released, which only an
+ * arrival picking it, the plug, or the second until wakes.
+ *
+ * Params: tc      - the waiting teller
+ *         sim_sec - the teller's simulation accounting
+ *         until   - the second at which the teller stops waiting
+ *         cid     - storage for the polled customer, if any
+ * Return: EAVAIL - a customer was polled into cid
+ *         EEMPTY - the line is empty and no more customers will be added
+ *         ENOCUS - the line is empty, and the second until has come
+ */
+static int teller_wait_locked(struct teller_ctx *tc, int *sim_sec,
+		int until, int *cid)
+{
+	struct bank_day *day = tc->day;
 	struct timespec thd_stamp; /* thread storage for sim_elaps... */
-	char thd_buf[40]; /* thread storage for sim_fmt_time() */
+	int wake_after; /* If blocked, wake after this to stop waiting */
 
-	int sim_sec = SEC_AT_BANK_OPEN; /* current second of the simulation */
+	sim_elaps_init(&thd_stamp);
+	LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+			QSITE_TELLER); /* Get lock */
+	sim_elaps_calc(&thd_stamp, sim_sec);
 
-	sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-	printf("%s teller %d clocks in.\n", thd_buf, tid);
+	int poll_code;
+	while (((poll_code = customer_q_can_poll(&day->line)) == ENOCUS)
+			&& (wake_after = until - *sim_sec) > 0) {
 
-	/* Schedule first break */
-	int next_break = sim_sec + sim_choose(&thd_seed, TBREAK_LO, TBREAK_HI);
-	/* If blocked, wake after this number of seconds to take a break */
-	int wake_after = 0;
+		sim_elaps_init(&thd_stamp);
 
-	int sec_til_close;
-	while ((sec_til_close = SEC_AT_BANK_CLOSE - sim_sec) > 0) {
+		/* Be rung by the next arrival, before letting the line go */
+		teller_idle(tc);
+		unsigned int key = evcount_prepare(&tc->bell);
+		LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+		teller_ship(tc);
+
+		/* Keep sleeping until the roster wants the teller */
+		struct timespec wake_after_ts;
+		teller_deadline(&wake_after_ts, wake_after);
+		int rc = evcount_wait(&tc->bell, key, &wake_after_ts);
+
+		LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+				QSITE_TELLER);
+		teller_unidle(tc); /* Nobody rang before the time was up */
+		LOCKSTAT_WOKEN(&day->queue_stat, rc == ETIMEDOUT);
+		if (rc == 0) {
+			/* Woken, but did somebody else take the customer? */
+			LOCKSTAT_FUTILE(&day->queue_stat,
+					customer_q_can_poll(&day->line)
+							== ENOCUS);
+		}
 
-		/* See if it is time for break */
-		take_break: if (sim_sec >= next_break) {
-			/* Schedule next break now (at start of break now) */
-			next_break = sim_sec + sim_choose(&thd_seed, TBREAK_LO,
-					TBREAK_HI);
+		sim_elaps_calc(&thd_stamp, sim_sec);
+	}
+	/* Break-forcing happens after the lock is released */
 
-			sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-			printf("%s teller %d went on break.\n", thd_buf, tid);
+	/* Do mutually exclusive work - poll the queue */
 
-			/* Nap for the duration of the break */
-			int nap = sim_choose(&thd_seed, LBREAK_LO, LBREAK_HI);
-			sim_sleep(nap, &sim_sec);
+	/*
+	 * The condition will unblock for EAVAIL and EEMPTY. If customers are
+	 * available (EAVAIL), then we can poll. However, It is possible for
+	 * the bank to close while the teller is waiting (EEMPTY). In this
+	 * case, we unblock - but we don't poll.
+	 */
+	if (poll_code == EAVAIL) {
+		*cid = customer_q_poll(&day->line);
+		teller_dequeue(day, *cid, *sim_sec);
+	}
+	LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex); /* Release */
 
-			sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-			printf("%s teller %d is back at work.\n", thd_buf, tid);
-		}
+	return poll_code;
+}
 
-		int twait_t0 = sim_sec; /* Start waiting for the customer */
+/*
+ * Waits as teller_wait_locked() does, but on the idle stack (see -a): the
+ * generator hands the teller an arrival directly, while it waits, and the
+ * teller only polls the line between waits.
+ *
+ * Params: see teller_wait_locked()
+ * Return: see teller_wait_locked()
+ */
+static int teller_wait_assign(struct teller_ctx *tc, int *sim_sec,
+		int until, int *cid)
+{
+	struct bank_day *day = tc->day;
+	struct timespec thd_stamp; /* thread storage for sim_elaps... */
+	int wake_after; /* If blocked, wake after this to stop waiting */
+
+	sim_elaps_init(&thd_stamp);
+	LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+			QSITE_TELLER); /* Get lock */
+	sim_elaps_calc(&thd_stamp, sim_sec);
+
+	int poll_code;
+	while (((poll_code = customer_q_can_poll(&day->line)) == ENOCUS)
+			&& (wake_after = until - *sim_sec) > 0) {
 
 		sim_elaps_init(&thd_stamp);
-		pthread_mutex_lock(&queue_mutex); /* Get lock */
-		sim_elaps_calc(&thd_stamp, &sim_sec);
 
-		int poll_code;
-		while (((poll_code = customer_q_can_poll()) == ENOCUS)
-				&& (wake_after = next_break - sim_sec) > 0) {
+		/* Be handed the next arrival, before letting the line go */
+		unsigned int key = evcount_prepare(&tc->bell);
+		hand_wait(day, tc);
+		LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+		teller_ship(tc);
+
+		/* Keep sleeping until the roster wants the teller */
+		struct timespec wake_after_ts;
+		teller_deadline(&wake_after_ts, wake_after);
+		int rc = evcount_wait(&tc->bell, key, &wake_after_ts);
+
+		*cid = hand_leave(tc);
+		if (*cid != -1) {
+			sim_elaps_calc(&thd_stamp, sim_sec);
+
+			/* Handed over on arrival, it never stood in line */
+			day->store.dequeue_sec[*cid]
+					= day->store.enqueue_sec[*cid];
+			return EAVAIL;
+		}
 
-			sim_elaps_init(&thd_stamp);
+		LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+				QSITE_TELLER);
+		LOCKSTAT_WOKEN(&day->queue_stat, rc == ETIMEDOUT);
+		if (rc == 0) {
+			/* Woken, but by the late ring of an old hand-off? */
+			LOCKSTAT_FUTILE(&day->queue_stat,
+					customer_q_can_poll(&day->line)
+							== ENOCUS);
+		}
+		sim_elaps_calc(&thd_stamp, sim_sec);
+	}
+
+	if (poll_code == EAVAIL) {
+		*cid = customer_q_poll(&day->line);
+		teller_dequeue(day, *cid, *sim_sec);
+	}
+	LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex); /* Release */
 
-			/* Keep sleeping unless we need to break */
-			struct timespec wake_after_ts;
-			clock_gettime(CLOCK_REALTIME, &wake_after_ts);
+	return poll_code;
+}
 
-			long my_nanos = SIM_SEC_TO_NSC(min(wake_after, 300));
-			long rt_nanos = wake_after_ts.tv_nsec;
+/*
+ * Waits on the lock-free line until a customer can be polled, the bank is
+ * empty and closed, or the second until has come. The time spent waiting is
+ * accounted to sim_sec.
+ *
+ * The teller parks on the line's eventcount, which only wakes it for its
+ * share of the arrivals (or the plug) rather than for every arrival.
+ *
+ * Params: see teller_wait_locked()
+ * Return: see teller_wait_locked()
+ */
+static int teller_wait_lockfree(struct teller_ctx *tc, int *sim_sec,
+		int until, int *cid)
+{
+	struct bank_day *day = tc->day;
+	struct timespec thd_stamp; /* thread storage for sim_elaps... */
+	int wake_after; /* If blocked, wake after this to stop waiting */
 
-			/* Manage overflow */
-			if (rt_nanos + my_nanos > 1000000000) {
-				wake_after_ts.tv_nsec = (rt_nanos + my_nanos)
-						- 1000000000;
-				wake_after_ts.tv_sec++;
-			} else {
-				wake_after_ts.tv_nsec += my_nanos;
-			}
+	int poll_code;
+	while (((poll_code = customer_lfq_poll(&day->lfq, cid)) == ENOCUS)
+			&& (wake_after = until - *sim_sec) > 0) {
 
-			/* Wake at least every 5 minutes to check for a break */
-			pthread_cond_timedwait(&queue_cond, &queue_mutex,
-					&wake_after_ts);
+		sim_elaps_init(&thd_stamp);
 
-			sim_elaps_calc(&thd_stamp, &sim_sec);
+		/* Register as a waiter, then make sure the line is empty */
+		unsigned int key = evcount_prepare(&day->line_ec);
+		poll_code = customer_lfq_poll(&day->lfq, cid);
+		if (poll_code != ENOCUS) {
+			evcount_cancel(&day->line_ec);
+			sim_elaps_calc(&thd_stamp, sim_sec);
+			break;
 		}
-		/* Break-forcing happens after the lock is released */
+		teller_ship(tc);
 
-		int twait_t1 = sim_sec; /* End of time waiting for a customer */
+		/* Keep sleeping until the roster wants the teller */
+		struct timespec wake_after_ts;
+		teller_deadline(&wake_after_ts, wake_after);
+		evcount_wait(&day->line_ec, key, &wake_after_ts);
 
-		/* Do mutually exclusive work - poll the queue */
+		sim_elaps_calc(&thd_stamp, sim_sec);
+	}
 
-		/*
-		 * The condition will unblock for EAVAIL and EEMPTY. If
-		 * customers are available (EAVAIL), then we can poll. However,
-		 * It is possible for the bank to close while the teller is
-		 * waiting (EEMPTY). In this case, we unblock - but we don't
-		 * poll.
-		 */
-		struct customer *cust = NULL;
-		if (poll_code == EAVAIL) {
-			cust = customer_q_poll();
-			cust->dequeue_sec = sim_sec;
+	if (poll_code == EAVAIL) teller_dequeue(day, *cid, *sim_sec);
+
+	return poll_code;
+}
+
+/*
+ * Lets a teller thread off the counter for a break or lunch at sim_sec, if
+ * the roster allows, and naps until the teller is back.
+ */
+static void teller_off(struct teller_ctx *tc, int lt, int *sim_sec)
+{
+	struct bank_day *day = tc->day;
+	struct evlog *log = &day->log;
+	int tid = tc->tid;
+
+	int back = roster_leave(&day->roster, &tc->duty, &tc->rng, tid,
+			*sim_sec, &tc->lunch);
+	if (back == -1) return; /* Nobody to cover, work on */
+
+	evlog_put(log, lt, tc->lunch ? EVL_LUNCH_START : EVL_BREAK_START,
+			*sim_sec, tid, -1);
+
+	/* Nap for the duration of the break */
+	int break_t0 = *sim_sec;
+	teller_ship(tc);
+	sim_sleep(back - *sim_sec, sim_sec);
+	roster_return(&day->roster, tid);
+	trace_break(day->trace, tid, tid, break_t0, *sim_sec);
+
+	evlog_put(log, lt, tc->lunch ? EVL_LUNCH_END : EVL_BREAK_END,
+			*sim_sec, tid, -1);
+}
+
+/*
+ * The teller function backs each of the the teller threads. Between the start
+ * and end of its shift (by default, bank open and close), it continually tries
+ * to pull customers off the queue. After obtaining a customer, the teller will
+ * perform the transaction (by sleeping). While doing all this, the teller will
+ * communicate with the stats muncher thread, updating its accounting of
+ * measurements.
+ *
+ * A waiting teller sleeps until a customer shows up, or until the roster
+ * wants it (for a break, lunch, or the end of its shift) - it never wakes
+ * just to look at the clock.
+ *
+ * Params: tc - This thread's teller state
+ */
+static void teller(struct teller_ctx *tc)
+{
+	struct bank_day *day = tc->day;
+	const struct scenario *sc = SCENARIO(day->sc);
+	struct evlog *log = &day->log;
+	struct customer_store *cs = &day->store;
+	int tid = tc->tid;
+	int lt = LOG_TELLER(tid); /* The teller's ring of the event log */
+	struct roster_duty *duty = &tc->duty;
+
+	/* Attach to the stat_muncher's channel */
+	int coid = chan_attach(&day->chan);
+	tc->coid = coid;
+
+	int sim_sec = sc->sec_open; /* current second of the simulation */
+
+	/* Wait for the shift to start */
+	if (duty->sec_in - sim_sec > 0) {
+		sim_sleep(duty->sec_in - sim_sec, &sim_sec);
+	}
+
+	evlog_put(log, lt, EVL_TELLER_IN, sim_sec, tid, -1);
+
+	/* Schedule first break */
+	roster_clock_in(sc, duty, &tc->rng, sim_sec);
+
+	int sec_til_out;
+	while ((sec_til_out = duty->sec_out - sim_sec) > 0) {
+
+		/* See if it is time for break (or lunch) */
+		if (sim_sec >= roster_next_off(duty)) {
+			teller_off(tc, lt, &sim_sec);
+		}
+
+		int twait_t0 = sim_sec; /* Start waiting for the customer */
+
+		int cid = -1;
+		int poll_code;
+		int until = roster_due(sc, duty);
+		if (day->lockfree) {
+			poll_code = teller_wait_lockfree(tc, &sim_sec, until,
+					&cid);
+		} else if (day->assign) {
+			poll_code = teller_wait_assign(tc, &sim_sec, until,
+					&cid);
+		} else {
+			poll_code = teller_wait_locked(tc, &sim_sec, until,
+					&cid);
 		}
-		pthread_mutex_unlock(&queue_mutex); /* Release lock */
+
+		int twait_t1 = sim_sec; /* End of time waiting for a customer */
 
 		/* Take a break if no customer was polled and it's scheduled */
-		if (poll_code != EAVAIL && sim_sec >= next_break) {
-			goto take_break;
+		if (poll_code != EAVAIL && sim_sec >= roster_next_off(duty)) {
+			teller_off(tc, lt, &sim_sec);
+			continue;
 		}
 
+		/* The shift is over, though customers may still come */
+		if (poll_code == ENOCUS) continue;
+
 		/*
 		 * Send measurements to the statistics engine - only if there
 		 * was a customer polled
@@ -332,134 +1623,388 @@ static void teller(int *tid_ptr)
 		if (poll_code == EAVAIL) {
 			int elaps;
 			/* Time customer spent waiting in the queue */
-			elaps = cust->dequeue_sec - cust->enqueue_sec;
-			MsgSendPulse(coid, -1, MET_CUST_Q_ELAPSED, elaps);
+			elaps = cs->dequeue_sec[cid] - cs->enqueue_sec[cid];
+			metbuf_add(&tc->mb, &day->chan, coid, tc->tid,
+					MET_CUST_Q_ELAPSED, elaps, sim_sec);
 
 			/* Time teller spent waiting for a new customer */
 			elaps = twait_t1 - twait_t0;
-			MsgSendPulse(coid, -1, MET_TELL_C_ELAPSED, elaps);
+			metbuf_add(&tc->mb, &day->chan, coid, tc->tid,
+					MET_TELL_C_ELAPSED, elaps, sim_sec);
 		}
 
-		sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
 		if (poll_code == EAVAIL) {
-			printf("%s teller %d initiates transaction with "
-				"customer %03d.\n", thd_buf, tid, cust->cid);
+			evlog_put(log, lt, EVL_TRANS_START, sim_sec, tid, cid);
 		} else {
-			printf("%s teller %d realizes there are no customers "
-				"left to help.\n", thd_buf, tid);
+			evlog_put(log, lt, EVL_NO_CUSTS, sim_sec, tid, -1);
 
 			break; /* Clock out now if there are no more custs */
 		}
 
 		/*
 		 * Each customer requires between 30 seconds and 6 minutes
-		 * for their transaction with the teller.
+		 * (in the bank of the assignment) for their transaction with
+		 * the teller. It was drawn when the customer arrived.
 		 */
-		int transt = sim_choose(&thd_seed, TRANST_LO, TRANST_HI);
+		int transt = cs->time_with_teller[cid];
 		sim_sleep(transt, &sim_sec);
 
 		/* Time customer and teller spent in the transaction */
-		cust->time_with_teller = transt;
-		MsgSendPulse(coid, -1, MET_CUST_T_ELAPSED, transt);
+		trace_customer(day->trace, tid, cs, cid, tid,
+				twait_t1 - twait_t0);
+		metbuf_add(&tc->mb, &day->chan, coid, tc->tid,
+				MET_CUST_T_ELAPSED, transt, sim_sec);
+
+		evlog_put(log, lt, EVL_TRANS_END, sim_sec, tid, cid);
 
-		sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-		printf("%s teller %d completes transaction with "
-			"customer %03d.\n", thd_buf, tid, cust->cid);
 	}
 
-	sim_fmt_time(thd_buf, sizeof(thd_buf), sim_sec);
-	printf("%s teller %d clocks out.\n", thd_buf, tid);
+	evlog_put(log, lt, EVL_TELLER_OUT, sim_sec, tid, -1);
 
 	/*
-	 * Disconnect from the stat_muncher's channel. When all tellers have
-	 * disconnected, the stat_muncher will complete.
+	 * Ship the last measurements, and disconnect from the stat_muncher's
+	 * channel. When all tellers have disconnected, the stat_muncher will
+	 * complete.
 	 */
-	ConnectDetach(coid);
+	metbuf_flush(&tc->mb, &day->chan, coid, tc->tid);
+	chan_detach(&day->chan, coid);
+	day_count_csw(day);
+}
+
+/*
+ * Polls a customer off the day's line without waiting.
+ *
+ * Return: see customer_q_can_poll()
+ */
+static int pooled_poll(struct bank_day *day, int *cid)
+{
+	if (day->lockfree) return customer_lfq_poll(&day->lfq, cid);
+
+	LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex, QSITE_POOL_POLL);
+	int poll_code = customer_q_can_poll(&day->line);
+	if (poll_code == EAVAIL) *cid = customer_q_poll(&day->line);
+	LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+
+	return poll_code;
+}
+
+/*
+ * Sends a teller on break (or to lunch) at second now, if the roster allows.
+ * Returns the second the break ends, or -1 if the teller has to stay.
+ */
+static int pooled_teller_break(struct teller_ctx *tc, int worker, int now)
+{
+	struct bank_day *day = tc->day;
+
+	int back = roster_leave(&day->roster, &tc->duty, &tc->rng, tc->tid,
+			now, &tc->lunch);
+	if (back == -1) return -1;
+
+	evlog_put(&day->log, worker,
+			tc->lunch ? EVL_LUNCH_START : EVL_BREAK_START, now,
+			tc->tid, -1);
+
+	tc->break_t0 = now;
+	tc->state = TELLER_BREAK;
+	teller_ship(tc);
+	return back;
+}
+
+/*
+ * Clocks a teller out at second now: ships its last measurements, and
+ * disconnects from the stat_muncher's channel.
+ */
+static int pooled_teller_out(struct teller_ctx *tc, int worker, int now)
+{
+	struct bank_day *day = tc->day;
+
+	evlog_put(&day->log, worker, EVL_TELLER_OUT, now, tc->tid, -1);
+
+	metbuf_flush(&tc->mb, &day->chan, tc->coid, tc->tid);
+	chan_detach(&day->chan, tc->coid);
+	return TSCHED_DONE;
+}
+
+/*
+ * Looks for a customer at second now, for a teller which is waiting since
+ * twait_t0. Starts the transaction, or parks the teller until the roster
+ * wants it (see roster_due()). Returns the second the teller is stepped
+ * next.
+ */
+static int pooled_teller_poll(struct teller_ctx *tc, int worker, int now,
+		int *park)
+{
+	struct bank_day *day = tc->day;
+	int tid = tc->tid;
+
+	struct customer_store *cs = &day->store;
+	int cid = -1;
+	int poll_code = pooled_poll(day, &cid);
+	if (poll_code == EEMPTY) {
+		evlog_put(&day->log, worker, EVL_NO_CUSTS, now, tid, -1);
+		return pooled_teller_out(tc, worker, now);
+	}
+	if (poll_code == ENOCUS) {
+		/* Take a break if it's scheduled, otherwise wait until then */
+		int back = -1;
+		if (now >= roster_next_off(&tc->duty)) {
+			back = pooled_teller_break(tc, worker, now);
+		}
+		if (back != -1) return back;
+
+		/* The shift is over, though customers may still come */
+		int due = roster_due(day->sc, &tc->duty);
+		if (now >= due) return pooled_teller_out(tc, worker, now);
+
+		tc->state = TELLER_WAITING;
+		*park = 1;
+		teller_ship(tc);
+		return due;
+	}
+
+	cs->dequeue_sec[cid] = now;
+	tc->twait = now - tc->twait_t0;
+
+	/* Time customer spent waiting in the queue */
+	metbuf_add(&tc->mb, &day->chan, tc->coid, tid, MET_CUST_Q_ELAPSED,
+			cs->dequeue_sec[cid] - cs->enqueue_sec[cid], now);
+
+	/* Time teller spent waiting for a new customer */
+	metbuf_add(&tc->mb, &day->chan, tc->coid, tid, MET_TELL_C_ELAPSED,
+			tc->twait, now);
+
+	evlog_put(&day->log, worker, EVL_TRANS_START, now, tid, cid);
+
+	tc->cid = cid;
+	tc->state = TELLER_SERVING;
+	return now + cs->time_with_teller[cid];
+}
+
+/*
+ * Steps a teller's state machine, as teller() would go on at second now:
+ * finish what the teller was doing, then clock out, take a break, or go
+ * look for the next customer.
+ */
+static int pooled_teller_step(struct bank_day *day, int tid, int worker,
+		int now, int *park)
+{
+	const struct scenario *sc = SCENARIO(day->sc);
+	struct teller_ctx *tc = &day->tellers[tid];
+	struct evlog *log = &day->log;
+	struct customer_store *cs = &day->store;
+	int cid = tc->cid;
+
+	switch (tc->state)
+	{
+	case TELLER_CLOCK_IN:
+		tc->coid = chan_attach(&day->chan);
+		evlog_put(log, worker, EVL_TELLER_IN, now, tid, -1);
+
+		/* Schedule first break */
+		roster_clock_in(sc, &tc->duty, &tc->rng, now);
+		break;
+	case TELLER_WAITING:
+		/* Woken by a customer, the bank closing, or the roster */
+		return pooled_teller_poll(tc, worker, now, park);
+	case TELLER_SERVING:
+		/* Time customer and teller spent in the transaction */
+		trace_customer(day->trace, worker, cs, cid, tid, tc->twait);
+		metbuf_add(&tc->mb, &day->chan, tc->coid, tid,
+				MET_CUST_T_ELAPSED, cs->time_with_teller[cid],
+				now);
+
+		evlog_put(log, worker, EVL_TRANS_END, now, tid, cid);
+		tc->cid = -1;
+		break;
+	case TELLER_BREAK:
+		roster_return(&day->roster, tid);
+		trace_break(day->trace, worker, tid, tc->break_t0, now);
+		evlog_put(log, worker,
+				tc->lunch ? EVL_LUNCH_END : EVL_BREAK_END, now,
+				tid, -1);
+		break;
+	}
+
+	if (tc->duty.sec_out - now <= 0) {
+		return pooled_teller_out(tc, worker, now);
+	}
+	if (now >= roster_next_off(&tc->duty)) {
+		int back = pooled_teller_break(tc, worker, now);
+		if (back != -1) return back;
+	}
+
+	tc->twait_t0 = now; /* Start waiting for the customer */
+	return pooled_teller_poll(tc, worker, now, park);
+}
+
+/*
+ * Steps the generator at second now, as cust_gen() would go on: the first
+ * step opens the bank, every other one lets the next customer in and wakes
+ * a parked teller. Returns the second of the next arrival, or closes the
+ * bank.
+ */
+static int pooled_gen_step(struct bank_day *day, int worker, int now)
+{
+	const struct scenario *sc = SCENARIO(day->sc);
+	struct evlog *log = &day->log;
+
+	if (day->gen_cid == -1) {
+		evlog_put(log, worker, EVL_BANK_OPEN, now, -1, -1);
+		day->gen_cid = 0;
+	} else {
+		int next = customer_store_make(&day->store, day->gen_cid++);
+		day->store.time_with_teller[next] = day->transt[next];
+
+		evlog_put(log, worker, EVL_CUST_ENTER, now, -1, next);
+
+		day->store.enqueue_sec[next] = now;
+		int lined = 1;
+		if (day->lockfree) {
+			if (day->live) {
+				live_arrival(day->live, now,
+						customer_lfq_depth(&day->lfq));
+			}
+			while (customer_lfq_push(&day->lfq, next) == -1) {
+				sched_yield(); /* Line is full, tellers poll */
+			}
+		} else {
+			LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+					QSITE_POOL_PUSH);
+			if (day->live) {
+				live_arrival(day->live, now,
+						customer_q_depth(&day->line));
+			}
+			lined = customer_q_push(&day->line, next) == 0;
+			LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+		}
+
+		if (lined) {
+			evlog_put(log, worker, EVL_CUST_LINE, now, -1, next);
+			tsched_wake_one(&day->ts, now);
+		} else {
+			/* The customer is turned away, never to be served */
+			perror("CON> Error growing the line");
+		}
+	}
+
+	if (sc->sec_close - now > 0 && day->gen_cid < day->max_cust) {
+		return now + day->arrive[day->gen_cid];
+	}
+
+	/* The bank closes. Plug the line, and wake every parked teller */
+	if (day->lockfree) {
+		customer_lfq_plug(&day->lfq);
+	} else {
+		LOCKSTAT_LOCK(&day->queue_stat, &day->queue_mutex,
+				QSITE_POOL_PLUG);
+		customer_q_plug(&day->line);
+		LOCKSTAT_UNLOCK(&day->queue_stat, &day->queue_mutex);
+	}
+	tsched_wake_all(&day->ts, now);
+
+	evlog_put(log, worker, EVL_BANK_CLOSE, now, -1, -1);
+	return TSCHED_DONE;
+}
+
+/*
+ * Steps a task of the pooled simulation (see tsched.h): the generator, or
+ * a teller.
+ */
+static int pooled_step(void *arg, int task, int worker, int now, int *park)
+{
+	struct bank_day *day = arg;
+
+	if (task == TASK_GEN(SCENARIO(day->sc))) {
+		return pooled_gen_step(day, worker, now);
+	}
+	return pooled_teller_step(day, task, worker, now, park);
 }
 
-#define MET_MAX_DATA_POINTS 500 /* The max number of data points for metrics */
+/*
+ * Folds one measurement into the day's statistics.
+ */
+static void stat_record(struct bank_stats *st, int code, int value)
+{
+	switch (code)
+	{
+	case MET_CUST_Q_ELAPSED:
+		stats_add(&st->q, value);
+		break;
+	case MET_CUST_T_ELAPSED:
+		stats_add(&st->t, value);
+		break;
+	case MET_TELL_C_ELAPSED:
+		stats_add(&st->c, value);
+		break;
+	}
+}
 
 /*
  * The stat_muncher function backs the statistics engine thread. It spins up
  * a channel for communication of new statistics measurements. This occurs over
- * various pulse messages.
+ * various pulse messages. A MET_BATCH pulse from a teller says that a batch
+ * of its measurements is waiting in its metric buffer.
  *
- * Once all threads connected to the channel have disconnected, this function
- * will calculate each statistic and print the report out.
+ * Every measurement is folded into a streaming accumulator as it arrives, so
+ * the engine needs no storage per customer. With live metrics, every teller
+ * has accumulators of its own, which are merged for the report. Once all
+ * tellers have disconnected from the channel, this function will print the
+ * report out.
  */
-static void stat_muncher()
+static void stat_muncher(struct bank_day *day)
 {
-	int acc_c = 0; /* Counts the number of customers encountered */
+	int n_tellers = SCENARIO(day->sc)->n_tellers;
 	int max_depth = 0; /* Maximum depth of the customer queue */
+	int n_dcon = 0; /* Counts the tellers which have disconnected */
 
-	/* Holds elapsed times customers spent waiting in the queue */
-	int cust_q_waits[MET_MAX_DATA_POINTS];
-	int ind_q = 0;
-	/* Holds elapsed times customers spent in transaction with a teller */
-	int cust_t_waits[MET_MAX_DATA_POINTS];
-	int ind_t = 0;
-	/* Holds elapsed times tellers spent waiting for a new customer */
-	int tell_c_waits[MET_MAX_DATA_POINTS];
-	int ind_c = 0;
-
-	struct _pulse pul;
-	int res;
-	while (1) {
-		res = MsgReceivePulse(chid, &pul, sizeof(struct _pulse), NULL);
-		if (res == -1) {
+	struct bank_stats st;
+	bank_stats_init(&st);
+
+	struct bank_stats *tst; /* Where a teller's batch goes */
+	struct chan_pulse pul;
+	struct met_record rec;
+	while (n_dcon < n_tellers) {
+		if (chan_receive_pulse(&day->chan, &pul) == -1) {
 			printf("CON> Error receiving pulse!\n");
 			perror(NULL);
+			continue;
 		}
 
 		switch (pul.code)
 		{
-		case _PULSE_CODE_DISCONNECT:
-			goto dcon;
-			/* When all tellers have disconnected */
-		case MET_CUST_Q_ELAPSED:
-			cust_q_waits[ind_q++] = pul.value.sival_int;
-			acc_c++;
+		case CHAN_PULSE_DISCONNECT:
+			n_dcon++; /* Done once all tellers have disconnected */
 			break;
-		case MET_CUST_T_ELAPSED:
-			cust_t_waits[ind_t++] = pul.value.sival_int;
+		case MET_BATCH:
+			tst = &st;
+			if (day->live) tst = live_begin(day->live, pul.value);
+			while (metbuf_take(&day->tellers[pul.value].mb, &rec)) {
+				stat_record(tst, rec.code, rec.value);
+			}
+			if (day->live) live_end(day->live, pul.value);
 			break;
-		case MET_TELL_C_ELAPSED:
-			tell_c_waits[ind_c++] = pul.value.sival_int;
+		default:
+			stat_record(&st, pul.code, pul.value);
 			break;
 		}
 	}
 
-	dcon: ChannelDestroy(chid);
-
-	/* Hack: no mutual exclusion to the customer. All other threads done. */
-	max_depth = customer_q_max_depth();
-
-	/* Calculate the average of each array */
+	if (day->live) live_merge(day->live, &st);
 
-	int i;
-	int avg_q = 0;
-	int max_q = 0;
-	for (i = 0; i < ind_q; i++) {
-		avg_q += cust_q_waits[i];
-		if (cust_q_waits[i] > max_q) max_q = cust_q_waits[i];
-	}
-	avg_q /= ind_q + 1;
-
-	int avg_t = 0;
-	int max_t = 0;
-	for (i = 0; i < ind_t; i++) {
-		avg_t += cust_t_waits[i];
-		if (cust_t_waits[i] > max_t) max_t = cust_t_waits[i];
+	/* Every teller is done with its buffer */
+	long n_records = 0, n_pulses = 0;
+	int tid;
+	for (tid = 0; tid < n_tellers; tid++) {
+		n_records += day->tellers[tid].mb.n_records;
+		n_pulses += day->tellers[tid].mb.n_pulses;
 	}
-	avg_t /= ind_t + 1;
 
-	int avg_c = 0;
-	int max_c = 0;
-	for (i = 0; i < ind_c; i++) {
-		avg_c += tell_c_waits[i];
-		if (tell_c_waits[i] > max_c) max_c = tell_c_waits[i];
+	/* Hack: no mutual exclusion to the customer. All other threads done. */
+	if (day->lockfree) {
+		max_depth = customer_lfq_max_depth(&day->lfq);
+	} else {
+		max_depth = customer_q_max_depth(&day->line);
 	}
-	avg_c /= ind_c + 1;
 
 	/* Sleep 1s before printing out the result metrics */
 	struct timespec sleep;
@@ -467,18 +2012,11 @@ static void stat_muncher()
 	sleep.tv_nsec = 0;
 	clock_nanosleep(CLOCK_REALTIME, 0, &sleep, NULL);
 
-	puts("");
-	printf("MET> The list of buisness metrics follow:\n");
-	printf("MET>\t1 | %25s     | %d\n", "Total customers serviced", acc_c);
-
-	printf("MET>\t2 | %25s (s) | %d\n", "Average queue time", avg_q);
-	printf("MET>\t3 | %25s (s) | %d\n", "Average transaction time", avg_t);
-	printf("MET>\t4 | %25s (s) | %d\n", "Average teller wait time", avg_c);
-
-	printf("MET>\t5 | %25s (s) | %d\n", "Maximum queue time", max_q);
-	printf("MET>\t6 | %25s (s) | %d\n", "Maximum teller wait time", max_c);
-	printf("MET>\t7 | %25s (s) | %d\n", "Maximum transaction time", max_t);
+	struct bank_metrics met;
+	metrics_from_stats(&st, max_depth, &met);
+	metrics_print(&met);
+	bank_stats_print(&st);
 
-	printf("MET>\t8 | %25s     | %d\n", "Maximum queue depth", max_depth);
-	puts("");
+	printf("CON> Tellers shipped %ld measurements in %ld pulses.\n",
+			n_records, n_pulses);
 }
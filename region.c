@@ -0,0 +1,285 @@
+/*
+ * Proj: 4
+ * File: region.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in region.h. Branch b is
+ * simulated by worker b % n_workers, the calling thread being worker 0. Each
+ * window has two phases, separated by barriers:
+ *
+ *  1. every worker advances its branches to the end of the window; customers
+ *     who give up on their line are pushed onto the ring to the next branch,
+ *  2. every worker drains the rings into its branches, and tells whether its
+ *     branches have anything left to simulate.
+ *
+ * The region is done after the first window in which no branch had anything
+ * left. A ring only carries the transfers of one window, which are at most
+ * one per second (arrivals are at least a second apart, and transferred
+ * customers are never transferred again).
+ *
+ * The workers wait at a gate until the calling thread has started them all.
+ * A worker whose thread fails to start is left out: the branches are dealt
+ * to the workers which did start.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include "region.h"
+
+#define REGION_CACHE_LINE 64 /* Size of a cache line in bytes */
+
+/*
+ * A customer on the way to the next branch.
+ */
+struct region_xfer
+{
+	int sec; /* The second the customer arrives there */
+	int transt; /* The length of the customer's transaction */
+};
+
+/*
+ * The ring carrying a branch's transfers to the next branch.
+ */
+struct region_link
+{
+	struct region_xfer *ring; /* The customers on their way */
+	unsigned int mask; /* Slots in ring - 1 */
+
+	/* The sender's and receiver's positions never share a cache line */
+	volatile unsigned int tail __attribute__((aligned(REGION_CACHE_LINE)));
+	volatile unsigned int head __attribute__((aligned(REGION_CACHE_LINE)));
+};
+
+struct region_branch
+{
+	struct des_day *day; /* The branch's day */
+	struct region_link out; /* To the next branch */
+	int busy; /* Set while the day has events left */
+	struct bank_metrics met; /* The branch's metrics, once closed */
+	struct bank_stats stats; /* The branch's measurements, once closed */
+	struct des_counts counts; /* What happened to the branch's customers */
+} __attribute__((aligned(REGION_CACHE_LINE)));
+
+struct region
+{
+	const struct scenario *sc; /* The bank of every branch */
+	struct region_branch *branches; /* One per branch */
+	int n_branches; /* The scenario's n_branches */
+	int n_workers; /* Threads simulating the branches */
+	int window; /* Seconds simulated between exchanges */
+	pthread_barrier_t barrier; /* Separates the phases of a window */
+	pthread_mutex_t gate; /* Held until every worker has started */
+	int busy[2]; /* Workers with busy branches, by window parity */
+};
+
+struct region_worker
+{
+	struct region *r;
+	int id;
+	pthread_t thd;
+};
+
+/*
+ * Sends a customer on to the next branch (see des_transfer_fn). Only the
+ * branch's worker sends on the ring.
+ */
+static int region_send(void *arg, int sec, int transt)
+{
+	struct region_link *link = arg;
+	unsigned int tail = link->tail; /* Only this sender moves the tail */
+
+	if (tail - __atomic_load_n(&link->head, __ATOMIC_ACQUIRE)
+			> link->mask) {
+		return 0; /* Full, the customer stays */
+	}
+
+	link->ring[tail & link->mask].sec = sec;
+	link->ring[tail & link->mask].transt = transt;
+	__atomic_store_n(&link->tail, tail + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/*
+ * Injects the customers on the ring into branch b. Returns 1 if there were
+ * any.
+ */
+static int region_drain(struct region *r, int b)
+{
+	int from = (b + r->n_branches - 1) % r->n_branches;
+	struct region_link *link = &r->branches[from].out;
+	unsigned int head = link->head; /* Only we move the head */
+	unsigned int tail = __atomic_load_n(&link->tail, __ATOMIC_ACQUIRE);
+	if (head == tail) return 0;
+
+	for (; head != tail; head++) {
+		struct region_xfer *x = &link->ring[head & link->mask];
+		des_day_inject(r->branches[b].day, x->sec, x->transt);
+	}
+	__atomic_store_n(&link->head, head, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/*
+ * Backs each worker: simulates its branches window by window, until no
+ * branch of the region has anything left to simulate.
+ */
+static void *region_worker_main(void *ptr)
+{
+	struct region_worker *w = ptr;
+	struct region *r = w->r;
+
+	/* n_workers and the barrier are only known once the gate opens */
+	pthread_mutex_lock(&r->gate);
+	pthread_mutex_unlock(&r->gate);
+
+	int start = SCENARIO(r->sc)->sec_open;
+	int round, b;
+
+	for (round = 0; ; round++) {
+		int parity = round & 1;
+		int until = r->window > INT_MAX - start ? INT_MAX
+				: start + r->window;
+
+		for (b = w->id; b < r->n_branches; b += r->n_workers) {
+			struct region_branch *br = &r->branches[b];
+			br->busy = des_day_advance(br->day, until);
+		}
+		pthread_barrier_wait(&r->barrier);
+
+		int busy = 0;
+		for (b = w->id; b < r->n_branches; b += r->n_workers) {
+			busy |= region_drain(r, b) | r->branches[b].busy;
+		}
+		if (busy) {
+			__atomic_add_fetch(&r->busy[parity], 1,
+					__ATOMIC_RELAXED);
+		}
+		pthread_barrier_wait(&r->barrier);
+
+		if (__atomic_load_n(&r->busy[parity], __ATOMIC_RELAXED) == 0) {
+			break;
+		}
+		/* Nobody counts the next window before the barrier */
+		if (w->id == 0) r->busy[!parity] = 0;
+		start = until;
+	}
+	return NULL;
+}
+
+/**
+ * Simulates one day of a region of branches in virtual time, on n_workers
+ * threads (the calling thread being one of them). Branch 0 draws its day from
+ * the provided seed as des_run_day() would, and every other branch from a
+ * seed of its own. The measurements of all branches are merged into the
+ * region's metrics.
+ *
+ * Params: sc        - the bank of every branch, and the region's topology
+ *         seed      - the seed for the day's random choices
+ *         n_workers - the number of threads to simulate on
+ *         met       - storage for the region's business metrics
+ *         pool      - if not NULL, the day's measurements are merged into it
+ *         counts    - if not NULL, storage for n_branches counts, what
+ *                     happened to the customers of each branch
+ * Return: void
+ */
+void region_run_day(const struct scenario *sc, uint64_t seed, int n_workers,
+		struct bank_metrics *met, struct bank_stats *pool,
+		struct des_counts *counts)
+{
+	sc = SCENARIO(sc);
+
+	struct region r;
+	r.sc = sc;
+	r.n_branches = sc->n_branches;
+	r.n_workers = min(n_workers, r.n_branches);
+	if (r.n_workers < 1) r.n_workers = 1;
+	r.window = sc->transfer_at > 0 ? sc->transfer_sec : INT_MAX;
+	r.busy[0] = r.busy[1] = 0;
+
+	struct bank_stats all;
+	bank_stats_init(&all);
+	int max_depth = 0;
+
+	/* A ring holds a window's worth of transfers */
+	unsigned int len = 1;
+	while (len < (unsigned int) sc->transfer_sec + 1) len *= 2;
+
+	int b, ok = 1;
+	if (posix_memalign((void **) &r.branches, REGION_CACHE_LINE,
+			r.n_branches * sizeof(struct region_branch))) {
+		metrics_from_stats(&all, 0, met);
+		return;
+	}
+	for (b = 0; b < r.n_branches; b++) {
+		struct region_branch *br = &r.branches[b];
+		uint64_t bseed = seed ^ (0x9e3779b97f4a7c15ull * (uint64_t) b);
+
+		br->day = des_day_open(sc, bseed, 0, NULL, NULL);
+		br->out.ring = malloc(len * sizeof(struct region_xfer));
+		br->out.mask = len - 1;
+		br->out.head = br->out.tail = 0;
+		if (br->day == NULL || br->out.ring == NULL) ok = 0;
+	}
+
+	/* Without every branch, the region is not simulated at all */
+	for (b = 0; b < r.n_branches && ok; b++) {
+		des_day_transfer(r.branches[b].day, region_send,
+				&r.branches[b].out);
+	}
+
+	struct region_worker *w = malloc(r.n_workers * sizeof(*w));
+	if (ok && w != NULL) {
+		pthread_mutex_init(&r.gate, NULL);
+		pthread_mutex_lock(&r.gate);
+
+		/* The calling thread acts as worker 0 */
+		int i;
+		for (i = 0; i < r.n_workers; i++) {
+			w[i].r = &r;
+			w[i].id = i;
+		}
+		for (i = 1; i < r.n_workers; i++) {
+			if (pthread_create(&w[i].thd, NULL, region_worker_main,
+					&w[i])) {
+				break;
+			}
+		}
+		r.n_workers = i;
+		pthread_barrier_init(&r.barrier, NULL, r.n_workers);
+		pthread_mutex_unlock(&r.gate);
+
+		region_worker_main(&w[0]);
+		for (i = 1; i < r.n_workers; i++) {
+			pthread_join(w[i].thd, NULL);
+		}
+
+		pthread_barrier_destroy(&r.barrier);
+		pthread_mutex_destroy(&r.gate);
+	}
+	free(w);
+
+	for (b = 0; b < r.n_branches; b++) {
+		struct region_branch *br = &r.branches[b];
+		struct des_counts none = { 0 };
+		br->counts = none;
+		bank_stats_init(&br->stats);
+		if (br->day != NULL) {
+			des_day_close(br->day, &br->met, &br->stats,
+					&br->counts);
+			if (br->met.max_depth > max_depth) {
+				max_depth = br->met.max_depth;
+			}
+		}
+
+		bank_stats_merge(&all, &br->stats);
+		if (counts) counts[b] = br->counts;
+		free(br->out.ring);
+	}
+
+	metrics_from_stats(&all, max_depth, met);
+	if (pool) bank_stats_merge(pool, &all);
+	free(r.branches);
+}
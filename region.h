@@ -0,0 +1,32 @@
+#ifndef REGION_H_
+#define REGION_H_
+
+/*
+ * Proj: 4
+ * File: region.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the region module. A region is
+ * a ring of identical branches (the scenario's n_branches), each simulated
+ * in virtual time as its own day (see des.h), and each on a thread of its own
+ * when there are enough workers. An arrival which finds its line transfer_at
+ * customers long goes on to the next branch of the ring, where it arrives
+ * transfer_sec seconds later.
+ *
+ * Branches hand customers to each other over lock-free single-producer
+ * single-consumer rings, and otherwise share nothing. They advance in
+ * windows of transfer_sec seconds: a customer sent within a window arrives
+ * after it, so every branch can simulate a window without hearing from the
+ * others, and all of them pick up their transfers between windows. The
+ * outcome therefore does not depend on the number of workers.
+ */
+
+#include "des.h"
+
+void region_run_day(const struct scenario *sc, uint64_t seed, int n_workers,
+		struct bank_metrics *met, struct bank_stats *pool,
+		struct des_counts *counts);
+
+#endif
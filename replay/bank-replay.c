@@ -0,0 +1,333 @@
+/*
+ * Proj: 4
+ * File: replay/bank-replay.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Recomputes the business metrics of a simulated day from its binary trace
+ * (see trace.h), without simulating the day again. The trace is mmap'ed, and
+ * the sums and maxima are reduced over one or two columns of each block, in
+ * the vectors of customer_store.h, so a trace is processed at about the speed
+ * memory can be read.
+ *
+ * The queue depth is not recorded, but follows from the columns: sorting the
+ * enqueue and dequeue seconds, and sweeping over both, yields the depth at
+ * every second. Arrivals count before polls of the same second, as on the
+ * line itself (a customer is pushed before a teller can poll it). In the
+ * wall-clock simulation every thread keeps its own simulated clock, so a
+ * customer may be polled a few seconds "before" it was enqueued.
+ *
+ * Usage: bank-replay [-p] [-t] [-F format] trace
+ *
+ *   -p        - also print the distribution (p50, p95, p99, stddev) of the
+ *               measurements
+ *   -t        - also print the metrics of every teller
+ *   -F format - print times as ampm (the default), iso or raw, as the
+ *               SIM> lines of qnx-banking -F
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+#include "customer_store.h"
+#include "metrics.h"
+#include "sim.h"
+
+/*
+ * The totals of one teller.
+ */
+struct replay_teller
+{
+	long served; /* Customers served */
+	long busy; /* Seconds spent in transaction */
+	long wait; /* Seconds spent waiting for a customer */
+	long breaks; /* Breaks taken */
+	long on_break; /* Seconds spent on break */
+};
+
+/*
+ * The columns of one block, pointing into the mapped trace.
+ */
+struct replay_block
+{
+	int kind;
+	int n_rows;
+	const int32_t *col[TRACE_CUST_COLS];
+};
+
+struct replay
+{
+	const char *base; /* The mapped trace */
+	size_t len;
+	const struct trace_header *hdr;
+	size_t off; /* Offset of the next block */
+	int blocks_left;
+};
+
+static int cmp_int32(const void *a, const void *b)
+{
+	int32_t x = *(const int32_t *) a, y = *(const int32_t *) b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * Maps a trace and checks its header. Returns 0, or -1 with a message
+ * printed.
+ */
+static int replay_open(struct replay *rp, const char *path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		perror(path);
+		return -1;
+	}
+
+	struct stat sb;
+	if (fstat(fd, &sb) == -1) {
+		perror(path);
+		close(fd);
+		return -1;
+	}
+	rp->len = (size_t) sb.st_size;
+
+	if (rp->len < sizeof(struct trace_header)) {
+		fprintf(stderr, "%s: not a trace\n", path);
+		close(fd);
+		return -1;
+	}
+
+	rp->base = mmap(NULL, rp->len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (rp->base == MAP_FAILED) {
+		perror(path);
+		return -1;
+	}
+
+	rp->hdr = (const struct trace_header *) rp->base;
+	if (memcmp(rp->hdr->magic, TRACE_MAGIC, sizeof(rp->hdr->magic)) != 0
+			|| rp->hdr->version != TRACE_VERSION) {
+		fprintf(stderr, "%s: not a version %d trace\n", path,
+				TRACE_VERSION);
+		munmap((void *) rp->base, rp->len);
+		return -1;
+	}
+
+	rp->off = sizeof(struct trace_header);
+	rp->blocks_left = rp->hdr->n_blocks;
+	return 0;
+}
+
+/*
+ * Points blk at the columns of the next block. Returns 1, or 0 once all
+ * blocks were visited (or the trace is truncated).
+ */
+static int replay_next(struct replay *rp, struct replay_block *blk)
+{
+	if (rp->blocks_left == 0) return 0;
+	if (rp->off + sizeof(struct trace_block) > rp->len) return 0;
+
+	const struct trace_block *tb =
+			(const struct trace_block *) (rp->base + rp->off);
+	int n_cols = tb->kind == TRACE_CUST ? TRACE_CUST_COLS
+			: TRACE_BREAK_COLS;
+	size_t size = sizeof(struct trace_block)
+			+ (size_t) n_cols * tb->n_rows * sizeof(int32_t);
+	if (tb->n_rows < 0 || rp->off + size > rp->len) return 0;
+
+	blk->kind = tb->kind;
+	blk->n_rows = tb->n_rows;
+	const int32_t *cols = (const int32_t *) (tb + 1);
+	int c;
+	for (c = 0; c < n_cols; c++) {
+		blk->col[c] = cols + (size_t) c * tb->n_rows;
+	}
+
+	rp->off += size;
+	rp->blocks_left--;
+	return 1;
+}
+
+/*
+ * The deepest the line got, from the (unsorted) enqueue and dequeue seconds
+ * of n customers, and the second it first got that deep. Sorts both arrays.
+ */
+static int replay_max_depth(int32_t *enq, int32_t *deq, long n, int *at)
+{
+	qsort(enq, n, sizeof(int32_t), cmp_int32);
+	qsort(deq, n, sizeof(int32_t), cmp_int32);
+
+	int depth = 0, max_depth = 0;
+	long i = 0, j = 0;
+	while (i < n) {
+		if (j == n || enq[i] <= deq[j]) {
+			depth++;
+			if (depth > max_depth) {
+				max_depth = depth;
+				*at = enq[i];
+			}
+			i++;
+		} else {
+			depth--;
+			j++;
+		}
+	}
+	return max_depth;
+}
+
+/*
+ * Adds the spans hi[i] - lo[i] (or hi[i], if lo is NULL) of a block's n
+ * customers to a sum, and raises a maximum to the longest of them. Every
+ * customer of a trace was served, so the dequeue column masks none out.
+ */
+static void replay_reduce(const int32_t *hi, const int32_t *lo,
+		const int32_t *deq, long n, long *sum, int *max)
+{
+	struct customer_spans sp;
+	customer_spans_reduce(hi, lo, deq, n, &sp);
+	*sum += sp.sum;
+	if (sp.n > 0 && sp.max > *max) *max = sp.max;
+}
+
+int main(int argc, char *argv[])
+{
+	int dist = 0, per_teller = 0, time_fmt = SIM_TIME_AMPM;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "ptF:")) != -1) {
+		switch (opt)
+		{
+		case 'p':
+			dist = 1;
+			break;
+		case 't':
+			per_teller = 1;
+			break;
+		case 'F':
+			if ((time_fmt = sim_time_fmt(optarg)) != -1) break;
+			/* Fall through */
+		default:
+			fprintf(stderr, "usage: %s [-p] [-t] [-F format] "
+				"trace\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind != argc - 1) {
+		fprintf(stderr, "usage: %s [-p] [-t] [-F format] trace\n",
+				argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	struct replay rp;
+	if (replay_open(&rp, argv[optind]) == -1) return EXIT_FAILURE;
+
+	long n_cust = rp.hdr->n_cust;
+	int n_tellers = rp.hdr->n_tellers;
+	printf("REP> Trace of seed %u: %ld customers, %d breaks, "
+		"%d tellers.\n", rp.hdr->seed, n_cust, rp.hdr->n_breaks,
+			n_tellers);
+
+	int32_t *enq = malloc((n_cust + 1) * sizeof(int32_t));
+	int32_t *deq = malloc((n_cust + 1) * sizeof(int32_t));
+	struct replay_teller *tellers = calloc(n_tellers,
+			sizeof(struct replay_teller));
+
+	struct bank_stats st;
+	bank_stats_init(&st);
+
+	long served = 0;
+	long sum_q = 0, sum_t = 0, sum_c = 0;
+	int max_q = 0, max_t = 0, max_c = 0;
+
+	struct replay_block blk;
+	while (replay_next(&rp, &blk)) {
+		long n = blk.n_rows, i;
+
+		if (blk.kind == TRACE_BREAK) {
+			for (i = 0; i < n; i++) {
+				int tid = blk.col[TB_TID][i];
+				if (tid < 0 || tid >= n_tellers) continue;
+				tellers[tid].breaks++;
+				tellers[tid].on_break += blk.col[TB_END][i]
+						- blk.col[TB_START][i];
+			}
+			continue;
+		}
+		if (blk.kind != TRACE_CUST || served + n > n_cust) continue;
+
+		const int32_t *e = blk.col[TC_ENQUEUE];
+		const int32_t *d = blk.col[TC_DEQUEUE];
+		const int32_t *t = blk.col[TC_TRANST];
+		const int32_t *c = blk.col[TC_TWAIT];
+
+		replay_reduce(d, e, d, n, &sum_q, &max_q);
+		replay_reduce(t, NULL, d, n, &sum_t, &max_t);
+		replay_reduce(c, NULL, d, n, &sum_c, &max_c);
+
+		memcpy(enq + served, e, n * sizeof(int32_t));
+		memcpy(deq + served, d, n * sizeof(int32_t));
+		served += n;
+
+		if (dist) {
+			for (i = 0; i < n; i++) {
+				stats_add(&st.q, d[i] - e[i]);
+				stats_add(&st.t, t[i]);
+				stats_add(&st.c, c[i]);
+			}
+		}
+
+		if (per_teller) {
+			for (i = 0; i < n; i++) {
+				int tid = blk.col[TC_TID][i];
+				if (tid < 0 || tid >= n_tellers) continue;
+				tellers[tid].served++;
+				tellers[tid].busy += t[i];
+				tellers[tid].wait += c[i];
+			}
+		}
+	}
+
+	struct bank_metrics met;
+	met.served = (int) served;
+	met.avg_q = served ? (int) (sum_q / served) : 0;
+	met.avg_t = served ? (int) (sum_t / served) : 0;
+	met.avg_c = served ? (int) (sum_c / served) : 0;
+	met.max_q = max_q;
+	met.max_t = max_t;
+	met.max_c = max_c;
+	int deepest_at = 0;
+	met.max_depth = replay_max_depth(enq, deq, served, &deepest_at);
+	metrics_print(&met);
+
+	if (served > 0) {
+		char when[SIM_TIME_LEN];
+		sim_put_time(when, deepest_at, time_fmt);
+		printf("REP> The line was first %d deep at %s.\n",
+				met.max_depth, when);
+	}
+
+	if (dist) bank_stats_print(&st);
+
+	if (per_teller) {
+		printf("REP>\tteller | served | busy (s) | wait (s) | breaks "
+			"| on break (s)\n");
+		int tid;
+		for (tid = 0; tid < n_tellers; tid++) {
+			struct replay_teller *rt = &tellers[tid];
+			printf("REP>\t%6d | %6ld | %8ld | %8ld | %6ld "
+				"| %12ld\n", tid + 1, rt->served, rt->busy,
+					rt->wait, rt->breaks, rt->on_break);
+		}
+	}
+
+	free(tellers);
+	free(deq);
+	free(enq);
+	munmap((void *) rp.base, rp.len);
+	return EXIT_SUCCESS;
+}
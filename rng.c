@@ -0,0 +1,121 @@
+/*
+ * Proj: 4
+ * File: rng.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in rng.h. The bulk generator
+ * steps all of its lanes at once: with 8 lanes, one step is a single AVX2
+ * (or two SSE2) instructions per operation, and yields 8 draws.
+ */
+
+#include <string.h>
+#include "rng.h"
+
+/*
+ * rng_rotl() for every lane of a vector.
+ */
+#define RNG_ROTL_LANES(X, K) (((X) << (K)) | ((X) >> (32 - (K))))
+
+/*
+ * Advances a splitmix64 state, and returns its next output.
+ */
+static uint64_t rng_splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Seeds a generator. Generators seeded with the same seed and stream draw
+ * the same sequence; changing either yields an unrelated sequence.
+ *
+ * Params: r      - the generator to seed
+ *         seed   - the seed, e.g. of a run or of a replication
+ *         stream - the stream, e.g. the number of the drawing thread
+ * Return: void
+ */
+void rng_seed(struct rng *r, uint64_t seed, uint64_t stream)
+{
+	uint64_t x = seed;
+	uint64_t y = rng_splitmix64(&x) ^ stream;
+	uint64_t a = rng_splitmix64(&y);
+	uint64_t b = rng_splitmix64(&y);
+
+	r->s[0] = (uint32_t) a;
+	r->s[1] = (uint32_t) (a >> 32);
+	r->s[2] = (uint32_t) b;
+	r->s[3] = (uint32_t) (b >> 32);
+
+	/* The all-zero state is the one state xoshiro never leaves */
+	if ((a | b) == 0) r->s[0] = 1;
+}
+
+/**
+ * Seeds a bulk generator. Each lane (and the spare generator) is seeded
+ * from a stream of its own, derived from the given one.
+ *
+ * Params: b      - the bulk generator to seed
+ *         seed   - see rng_seed()
+ *         stream - see rng_seed()
+ * Return: void
+ */
+void rng_bulk_seed(struct rng_bulk *b, uint64_t seed, uint64_t stream)
+{
+	int l, w;
+	for (l = 0; l < RNG_LANES; l++) {
+		struct rng lane;
+		rng_seed(&lane, seed, stream * (RNG_LANES + 1) + l + 1);
+		for (w = 0; w < 4; w++) {
+			b->s[w][l] = lane.s[w];
+		}
+	}
+	rng_seed(&b->spare, seed, stream * (RNG_LANES + 1));
+}
+
+/**
+ * Fills an array with random bits. n needs not be a multiple of RNG_LANES;
+ * the draws of the last step which don't fit are dropped.
+ *
+ * Params: b   - the bulk generator
+ *         out - storage for n draws
+ *         n   - the number of draws
+ * Return: void
+ */
+void rng_bulk_fill(struct rng_bulk *b, uint32_t *out, size_t n)
+{
+	rng_lanes s0 = b->s[0], s1 = b->s[1], s2 = b->s[2], s3 = b->s[3];
+	rng_lanes res;
+
+/* One step of every lane: res gets the next draws */
+#define RNG_BULK_STEP() do { \
+	rng_lanes t = s1 << 9; \
+	res = RNG_ROTL_LANES(s1 * 5, 7) * 9; \
+	s2 ^= s0; \
+	s3 ^= s1; \
+	s1 ^= s2; \
+	s0 ^= s3; \
+	s2 ^= t; \
+	s3 = RNG_ROTL_LANES(s3, 11); \
+} while (0)
+
+	size_t i;
+	for (i = 0; i + RNG_LANES <= n; i += RNG_LANES) {
+		RNG_BULK_STEP();
+		memcpy(out + i, &res, sizeof(res));
+	}
+	if (i < n) {
+		RNG_BULK_STEP();
+		memcpy(out + i, &res, (n - i) * sizeof(uint32_t));
+	}
+
+#undef RNG_BULK_STEP
+
+	b->s[0] = s0;
+	b->s[1] = s1;
+	b->s[2] = s2;
+	b->s[3] = s3;
+}
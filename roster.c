@@ -0,0 +1,240 @@
+/*
+ * Proj: 4
+ * File: roster.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in roster.h. Only a scenario
+ * which limits the tellers off at once keeps track of them; every other
+ * roster decides alone from a teller's duty, and takes no lock.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include "sim.h"
+#include "roster.h"
+
+/**
+ * Initializes the roster of a day of a scenario.
+ *
+ * Params: r  - the roster to initialize
+ *         sc - the bank of the day
+ * Return: 0 on success, -1 if the roster could not be allocated
+ */
+int roster_init(struct roster *r, const struct scenario *sc)
+{
+	sc = SCENARIO(sc);
+	r->sc = sc;
+	r->n_off = 0;
+	r->off_tid = NULL;
+	r->off_back = NULL;
+	r->n_deferred = 0;
+
+	if (sc->max_off > 0) {
+		r->off_tid = malloc(2 * sc->max_off * sizeof(int));
+		if (r->off_tid == NULL) return -1;
+		r->off_back = r->off_tid + sc->max_off;
+	}
+	pthread_mutex_init(&r->mutex, NULL);
+	return 0;
+}
+
+/**
+ * Destroys a roster.
+ *
+ * Params: r - the roster to destroy
+ * Return: void
+ */
+void roster_destroy(struct roster *r)
+{
+	pthread_mutex_destroy(&r->mutex);
+	free(r->off_tid);
+}
+
+/**
+ * Sets up the duty of a teller before the day starts: its shift, and when
+ * its lunch is due. No break is due until the teller clocks in.
+ *
+ * Params: sc  - the bank of the day
+ *         tid - the teller's id, indexed at 0
+ *         d   - storage for the teller's duty
+ * Return: void
+ */
+void roster_duty_init(const struct scenario *sc, int tid,
+		struct roster_duty *d)
+{
+	sc = SCENARIO(sc);
+	d->sec_in = sc->sec_open;
+	d->sec_out = sc->sec_close;
+	if (sc->n_shifts > 0) {
+		d->sec_in = sc->shifts[tid % sc->n_shifts].sec_in;
+		d->sec_out = sc->shifts[tid % sc->n_shifts].sec_out;
+	}
+	d->lunch_at = INT_MAX;
+	d->next_break = INT_MAX;
+	if (sc->lunch_len == 0) return;
+
+	/* Stagger the lunches over the part of the window on shift */
+	int lo = sc->lunch.sec_in > d->sec_in ? sc->lunch.sec_in : d->sec_in;
+	int hi = min(sc->lunch.sec_out, d->sec_out);
+	int span = hi - lo - sc->lunch_len;
+	if (span >= 0) {
+		d->lunch_at = lo + (int) ((long long) span * tid
+				/ sc->n_tellers);
+	}
+}
+
+/**
+ * Clocks a teller in: its first break is drawn from second now on.
+ *
+ * Params: sc  - the bank of the day
+ *         d   - the teller's duty
+ *         rng - the teller's stream
+ *         now - the second the teller clocks in
+ * Return: void
+ */
+void roster_clock_in(const struct scenario *sc, struct roster_duty *d,
+		struct rng *rng, int now)
+{
+	sc = SCENARIO(sc);
+	d->next_break = now + sim_draw(rng, &sc->tbreak);
+}
+
+/**
+ * The second at which a teller wants to leave the counter next, for a break
+ * or for lunch.
+ *
+ * Params: d - the teller's duty
+ * Return: the second
+ */
+int roster_next_off(const struct roster_duty *d)
+{
+	return min(d->next_break, d->lunch_at);
+}
+
+/**
+ * The second at which a teller waiting for a customer must stop waiting:
+ * when it wants to leave the counter, or when its shift ends before the
+ * bank closes. (At closing time, the plugged line sends every teller home.)
+ *
+ * Params: sc - the bank of the day
+ *         d  - the teller's duty
+ * Return: the second
+ */
+int roster_due(const struct scenario *sc, const struct roster_duty *d)
+{
+	sc = SCENARIO(sc);
+	int due = roster_next_off(d);
+	if (d->sec_out < sc->sec_close && d->sec_out < due) {
+		due = d->sec_out;
+	}
+	return due;
+}
+
+/**
+ * Lets a teller, whose break or lunch fell due, leave the counter at second
+ * now, if the roster allows. Lunch goes first if both are due. A break draws
+ * the teller's next break and its own length, as breaks always did.
+ *
+ * If max_off tellers are off already, the teller stays at the counter: what
+ * fell due falls due again once the first of them is back.
+ *
+ * Params: r     - the roster of the day
+ *         d     - the teller's duty
+ *         rng   - the teller's stream
+ *         tid   - the teller's id
+ *         now   - the current second
+ *         lunch - set if the teller goes to lunch, cleared for a break
+ * Return: the second the teller is back, or -1 if it has to stay
+ */
+int roster_leave(struct roster *r, struct roster_duty *d, struct rng *rng,
+		int tid, int now, int *lunch)
+{
+	const struct scenario *sc = r->sc;
+	int i;
+
+	if (sc->max_off > 0) {
+		pthread_mutex_lock(&r->mutex);
+		if (r->n_off == sc->max_off) {
+			/* Try again once the first one is back */
+			int retry = r->off_back[0];
+			for (i = 1; i < r->n_off; i++) {
+				retry = min(retry, r->off_back[i]);
+			}
+			if (retry <= now) retry = now + 1;
+
+			if (now >= d->lunch_at) d->lunch_at = retry;
+			if (now >= d->next_break) d->next_break = retry;
+			r->n_deferred++;
+			pthread_mutex_unlock(&r->mutex);
+			return -1;
+		}
+	}
+
+	int back;
+	*lunch = now >= d->lunch_at;
+	if (*lunch) {
+		back = now + sc->lunch_len;
+		d->lunch_at = INT_MAX;
+
+		/* Breaks are counted at the counter */
+		if (d->next_break != INT_MAX) d->next_break += sc->lunch_len;
+	} else {
+		/* Schedule next break now (at start of break now) */
+		d->next_break = now + sim_draw(rng, &sc->tbreak);
+		back = now + sim_draw(rng, &sc->lbreak);
+	}
+
+	if (sc->max_off > 0) {
+		r->off_tid[r->n_off] = tid;
+		r->off_back[r->n_off++] = back;
+		pthread_mutex_unlock(&r->mutex);
+	}
+	return back;
+}
+
+/**
+ * Takes a teller back at the counter, after roster_leave() let it go.
+ *
+ * Params: r   - the roster of the day
+ *         tid - the teller's id
+ * Return: void
+ */
+void roster_return(struct roster *r, int tid)
+{
+	if (r->sc->max_off == 0) return;
+
+	pthread_mutex_lock(&r->mutex);
+	int i;
+	for (i = 0; i < r->n_off; i++) {
+		if (r->off_tid[i] != tid) continue;
+
+		r->n_off--;
+		r->off_tid[i] = r->off_tid[r->n_off];
+		r->off_back[i] = r->off_back[r->n_off];
+		break;
+	}
+	pthread_mutex_unlock(&r->mutex);
+}
+
+/**
+ * The hours the tellers of a branch of the scenario are on shift, less
+ * their lunches. Breaks are not accounted.
+ *
+ * Params: sc - the scenario
+ * Return: the hours
+ */
+double roster_hours(const struct scenario *sc)
+{
+	sc = SCENARIO(sc);
+	long secs = 0;
+	int tid;
+	for (tid = 0; tid < sc->n_tellers; tid++) {
+		struct roster_duty d;
+		roster_duty_init(sc, tid, &d);
+		secs += d.sec_out - d.sec_in;
+		if (d.lunch_at != INT_MAX) secs -= sc->lunch_len;
+	}
+	return secs / 3600.0;
+}
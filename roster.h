@@ -0,0 +1,80 @@
+#ifndef ROSTER_H_
+#define ROSTER_H_
+
+/*
+ * Proj: 4
+ * File: roster.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the roster of a day: when each
+ * teller is on duty, and when a teller may leave the counter. A scenario
+ * (see scenario.h) may give the tellers shifts, a lunch, and a limit on the
+ * tellers off at once:
+ *
+ *  - Teller t works shift t % n_shifts, and clocks in and out at its ends.
+ *    Without shifts, every teller works the bank's opening hours.
+ *  - Every teller takes one lunch of lunch_len seconds in the lunch window.
+ *    The lunches are staggered over the window by teller id, such that the
+ *    tellers don't all leave at once. A teller whose shift doesn't cover
+ *    enough of the window has no lunch.
+ *  - A break or lunch which falls due while max_off tellers are off already
+ *    is put off until the first of them is back. Time between breaks is
+ *    counted at the counter, so a lunch moves the next break back.
+ *
+ * Every simulation keeps a teller's duty (struct roster_duty) next to its
+ * state, and asks roster_due() for the second its wait for a customer must
+ * end. A waiting teller is thus woken for its break, its lunch or the end of
+ * its shift exactly when it falls due, and never to look at the clock.
+ *
+ * A scenario without a roster behaves as the bank of the assignment did:
+ * the tellers work opening hours and break whenever a break falls due, with
+ * the same draws.
+ */
+
+#include <pthread.h>
+#include "scenario.h"
+#include "rng.h"
+
+struct roster_duty
+{
+	int sec_in; /* The second the teller clocks in */
+	int sec_out; /* The second the teller clocks out */
+	int lunch_at; /* The second lunch is due, INT_MAX if taken or none */
+	int next_break; /* The second the next break is due */
+};
+
+struct roster
+{
+	const struct scenario *sc; /* The bank of the day */
+
+	/*
+	 * The tellers off at once, with the second each one is back, kept
+	 * only if the scenario limits them. The mutex guards them, as teller
+	 * threads come and go concurrently.
+	 */
+	pthread_mutex_t mutex;
+	int n_off; /* Tellers off */
+	int *off_tid; /* The tellers off, max_off of them at most */
+	int *off_back; /* The second each of them is back */
+	long n_deferred; /* Breaks and lunches put off, for want of cover */
+};
+
+int roster_init(struct roster *r, const struct scenario *sc);
+void roster_destroy(struct roster *r);
+
+void roster_duty_init(const struct scenario *sc, int tid,
+		struct roster_duty *d);
+void roster_clock_in(const struct scenario *sc, struct roster_duty *d,
+		struct rng *rng, int now);
+int roster_next_off(const struct roster_duty *d);
+int roster_due(const struct scenario *sc, const struct roster_duty *d);
+
+int roster_leave(struct roster *r, struct roster_duty *d, struct rng *rng,
+		int tid, int now, int *lunch);
+void roster_return(struct roster *r, int tid);
+
+double roster_hours(const struct scenario *sc);
+
+#endif
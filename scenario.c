@@ -0,0 +1,683 @@
+/*
+ * Proj: 4
+ * File: scenario.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in scenario.h. A scenario is
+ * written as "key = value" assignments, one per line in a file (where '#'
+ * starts a comment), or separated by commas on the command line. The keys
+ * are:
+ *
+ *   open, close          - opening hours, as HH:MM (24 hour clock)
+ *   tellers              - the number of tellers
+ *   arrive, transt       - the distribution of the time between arrivals,
+ *                          and of the length of a transaction: "uniform"
+ *                          (the default), "exp", "lognormal", "empirical",
+ *                          or "piecewise" (arrivals only)
+ *   arrive_lo, arrive_hi - the bounds of a uniform time between arrivals
+ *   arrive_mean          - the mean of an exp or lognormal distribution
+ *   arrive_sd            - the standard deviation of a lognormal one
+ *   arrive_hist          - the histogram of an empirical distribution, as
+ *                          "value@weight" pairs separated by spaces
+ *   arrive_rate          - the arrivals per hour of a piecewise one, as
+ *                          "HH:MM@rate" pairs (the rate from then on)
+ *   transt_lo, ...       - the same, for the length of a transaction
+ *   tbreak_lo, tbreak_hi - the bounds of the time between teller breaks
+ *   lbreak_lo, lbreak_hi - the bounds of the length of a teller break
+ *   branches             - the number of branches of the region (each with
+ *                          the tellers above)
+ *   queues               - the number of lines of a branch
+ *   route                - how an arrival picks its line: "mix" (by its
+ *                          kind, the default), "jsq" (the shortest line), or
+ *                          "p2c" (the shorter of two random lines)
+ *   queue_mix            - the weight of each kind of customer (i.e. of
+ *                          each line), separated by spaces
+ *   steal                - 1 if idle tellers serve the other lines too
+ *   transfer_at          - the line length at which an arrival moves on to
+ *                          the next branch (0, the default, never)
+ *   transfer_sec         - the time a transfer takes
+ *   shifts               - the shifts of the tellers, as "HH:MM-HH:MM"
+ *                          windows separated by spaces: teller t works
+ *                          shift t % (the number of shifts)
+ *   lunch                - the window lunches are taken in, as HH:MM-HH:MM
+ *   lunch_len            - the length of a lunch (0, the default, for none)
+ *   max_off              - the most tellers on break or at lunch at once
+ *                          (0, the default, for any number)
+ *
+ * Times are in seconds, or in minutes when suffixed with 'm' (e.g. "4m").
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <stddef.h>
+#include "scenario.h"
+
+#define SK_TIME 0 /* A time of day */
+#define SK_COUNT 1 /* A plain number */
+#define SK_LO 2 /* The lower bound of a range */
+#define SK_HI 3 /* The upper bound of a range */
+#define SK_DIST 4 /* The kind of a distribution */
+#define SK_MEAN 5 /* The mean of a distribution */
+#define SK_SD 6 /* The standard deviation of a distribution */
+#define SK_HIST 7 /* The histogram of an empirical distribution */
+#define SK_RATE 8 /* The rates of a piecewise distribution */
+#define SK_SECS 9 /* A number of seconds */
+#define SK_ROUTE 10 /* A routing policy */
+#define SK_MIX 11 /* The weights of the lines */
+#define SK_SHIFTS 12 /* The shifts of a roster */
+#define SK_WINDOW 13 /* A window of the day */
+
+struct scenario_key
+{
+	const char *name;
+	int kind; /* One of the SK_ kinds above */
+	size_t off; /* Where the value lives in a struct scenario */
+};
+
+static const struct scenario_key scenario_keys[] = {
+	{ "open", SK_TIME, offsetof(struct scenario, sec_open) },
+	{ "close", SK_TIME, offsetof(struct scenario, sec_close) },
+	{ "tellers", SK_COUNT, offsetof(struct scenario, n_tellers) },
+	{ "arrive", SK_DIST, offsetof(struct scenario, arrive) },
+	{ "arrive_lo", SK_LO, offsetof(struct scenario, arrive.range) },
+	{ "arrive_hi", SK_HI, offsetof(struct scenario, arrive.range) },
+	{ "arrive_mean", SK_MEAN, offsetof(struct scenario, arrive) },
+	{ "arrive_sd", SK_SD, offsetof(struct scenario, arrive) },
+	{ "arrive_hist", SK_HIST, offsetof(struct scenario, arrive) },
+	{ "arrive_rate", SK_RATE, offsetof(struct scenario, arrive) },
+	{ "tbreak_lo", SK_LO, offsetof(struct scenario, tbreak) },
+	{ "tbreak_hi", SK_HI, offsetof(struct scenario, tbreak) },
+	{ "lbreak_lo", SK_LO, offsetof(struct scenario, lbreak) },
+	{ "lbreak_hi", SK_HI, offsetof(struct scenario, lbreak) },
+	{ "transt", SK_DIST, offsetof(struct scenario, transt) },
+	{ "transt_lo", SK_LO, offsetof(struct scenario, transt.range) },
+	{ "transt_hi", SK_HI, offsetof(struct scenario, transt.range) },
+	{ "transt_mean", SK_MEAN, offsetof(struct scenario, transt) },
+	{ "transt_sd", SK_SD, offsetof(struct scenario, transt) },
+	{ "transt_hist", SK_HIST, offsetof(struct scenario, transt) },
+	{ "transt_rate", SK_RATE, offsetof(struct scenario, transt) },
+	{ "branches", SK_COUNT, offsetof(struct scenario, n_branches) },
+	{ "queues", SK_COUNT, offsetof(struct scenario, n_queues) },
+	{ "route", SK_ROUTE, offsetof(struct scenario, route) },
+	{ "queue_mix", SK_MIX, offsetof(struct scenario, queue_mix) },
+	{ "steal", SK_COUNT, offsetof(struct scenario, steal) },
+	{ "transfer_at", SK_COUNT, offsetof(struct scenario, transfer_at) },
+	{ "transfer_sec", SK_SECS, offsetof(struct scenario, transfer_sec) },
+	{ "shifts", SK_SHIFTS, offsetof(struct scenario, n_shifts) },
+	{ "lunch", SK_WINDOW, offsetof(struct scenario, lunch) },
+	{ "lunch_len", SK_SECS, offsetof(struct scenario, lunch_len) },
+	{ "max_off", SK_COUNT, offsetof(struct scenario, max_off) },
+	{ NULL, 0, 0 }
+};
+
+/*
+ * Parses the value of a key of the given kind. Returns 0, or -1 if the value
+ * is malformed.
+ */
+static int scenario_parse_value(int kind, const char *str, int *value)
+{
+	char *end;
+	long v = strtol(str, &end, 10);
+	if (end == str || v < 0) return -1;
+
+	if (kind == SK_TIME) {
+		if (*end != ':') return -1;
+		const char *mi_str = end + 1;
+		long mi = strtol(mi_str, &end, 10);
+		if (end == mi_str || v > 24 || mi < 0 || mi > 59) return -1;
+		v = SIM_MIL_TO_SEC(v, mi);
+	} else if (kind != SK_COUNT && *end == 'm') {
+		if (v > 1000000) return -1;
+		v = MIN_TO_SEC(v);
+		end++;
+	}
+
+	while (isspace((unsigned char) *end)) end++;
+	if (*end != '\0' || v > 100000000) return -1;
+
+	*value = (int) v;
+	return 0;
+}
+
+/*
+ * Strips leading and trailing white space off str, in place.
+ */
+static char *scenario_trim(char *str)
+{
+	while (isspace((unsigned char) *str)) str++;
+
+	char *end = str + strlen(str);
+	while (end > str && isspace((unsigned char) end[-1])) end--;
+	*end = '\0';
+
+	return str;
+}
+
+/*
+ * Parses the "value@weight" pairs of a histogram (SK_HIST), or the
+ * "HH:MM@rate" pairs of a piecewise rate (SK_RATE), into a distribution.
+ * Returns 0, or -1 if the pairs are malformed.
+ */
+static int scenario_parse_pairs(int kind, const char *str, struct dist *d)
+{
+	char *copy = strdup(str);
+	if (copy == NULL) return -1;
+
+	int n = 0;
+	int rc = 0;
+	char *save;
+	char *pair = strtok_r(copy, " \t", &save);
+	while (rc == 0 && pair != NULL) {
+		char *at = strchr(pair, '@');
+		if (at == NULL || n == DIST_MAX_BINS) {
+			rc = -1;
+			break;
+		}
+		*at = '\0';
+
+		char *end;
+		double weight = strtod(at + 1, &end);
+		if (end == at + 1 || *end != '\0') rc = -1;
+		if (scenario_parse_value(kind == SK_RATE ? SK_TIME : SK_LO,
+				pair, &d->bin_value[n]) == -1) {
+			rc = -1;
+		}
+		d->bin_weight[n++] = weight;
+
+		pair = strtok_r(NULL, " \t", &save);
+	}
+
+	free(copy);
+	if (n == 0) rc = -1;
+	if (rc == 0) d->n_bins = n;
+	return rc;
+}
+
+/*
+ * Parses the weights of the lines (SK_MIX), separated by spaces. Lines
+ * without a weight get none. Returns 0, or -1 if the weights are malformed.
+ */
+static int scenario_parse_mix(const char *str, double *mix)
+{
+	double w[SCENARIO_MAX_QUEUES] = { 0 };
+	int n = 0;
+	const char *p = str;
+	while (*p != '\0') {
+		char *end;
+		if (n == SCENARIO_MAX_QUEUES) return -1;
+		w[n] = strtod(p, &end);
+		if (end == p || w[n] < 0) return -1;
+		n++;
+		p = end;
+		while (isspace((unsigned char) *p)) p++;
+	}
+	if (n == 0) return -1;
+
+	memcpy(mix, w, sizeof(w));
+	return 0;
+}
+
+/*
+ * Parses a window of the day (SK_WINDOW), as "HH:MM-HH:MM", in place.
+ * Returns 0, or -1 if the window is malformed or ends before it starts.
+ */
+static int scenario_parse_window(char *str, struct scenario_shift *w)
+{
+	char *dash = strchr(str, '-');
+	if (dash == NULL) return -1;
+	*dash = '\0';
+
+	if (scenario_parse_value(SK_TIME, str, &w->sec_in) == -1
+			|| scenario_parse_value(SK_TIME, dash + 1,
+					&w->sec_out) == -1) {
+		return -1;
+	}
+	return w->sec_in < w->sec_out ? 0 : -1;
+}
+
+/**
+ * Parses the shifts of a roster (SK_SHIFTS), "HH:MM-HH:MM" windows separated
+ * by spaces, into the scenario's shifts. Whether they lie within opening
+ * hours is left to the caller.
+ *
+ * Params: str - the shifts
+ *         sc  - the scenario to store the shifts in
+ * Return: 0 on success, -1 if the shifts are malformed
+ */
+int scenario_parse_shifts(const char *str, struct scenario *sc)
+{
+	char *copy = strdup(str);
+	if (copy == NULL) return -1;
+
+	int n = 0;
+	int rc = 0;
+	char *save;
+	char *shift = strtok_r(copy, " \t", &save);
+	while (rc == 0 && shift != NULL) {
+		if (n == SCENARIO_MAX_SHIFTS
+				|| scenario_parse_window(shift,
+						&sc->shifts[n++]) == -1) {
+			rc = -1;
+		}
+		shift = strtok_r(NULL, " \t", &save);
+	}
+
+	free(copy);
+	if (n == 0) rc = -1;
+	if (rc == 0) sc->n_shifts = n;
+	return rc;
+}
+
+/*
+ * Looks up a routing policy by name. Returns one of the ROUTE_ policies, or
+ * -1 if there is no such policy.
+ */
+static int scenario_route(const char *name)
+{
+	if (strcmp(name, "mix") == 0) return ROUTE_MIX;
+	if (strcmp(name, "jsq") == 0) return ROUTE_JSQ;
+	if (strcmp(name, "p2c") == 0) return ROUTE_P2C;
+	return -1;
+}
+
+/*
+ * Applies one "key = value" assignment to the scenario. Blank assignments
+ * are ignored. Errors are reported against where.
+ */
+static int scenario_assign(struct scenario *sc, char *assignment,
+		const char *where)
+{
+	char *key = scenario_trim(assignment);
+	if (*key == '\0') return 0;
+
+	char *eq = strchr(key, '=');
+	if (eq == NULL) {
+		fprintf(stderr, "%s: expected key = value\n", where);
+		return -1;
+	}
+	*eq = '\0';
+	key = scenario_trim(key);
+	char *value = scenario_trim(eq + 1);
+
+	const struct scenario_key *k;
+	for (k = scenario_keys; k->name != NULL; k++) {
+		if (strcmp(k->name, key) == 0) break;
+	}
+	if (k->name == NULL) {
+		fprintf(stderr, "%s: unknown key '%s'\n", where, key);
+		return -1;
+	}
+
+	char *field = (char *) sc + k->off;
+	int v = 0;
+	int rc;
+	switch (k->kind)
+	{
+	case SK_DIST:
+		rc = v = dist_kind(value);
+		break;
+	case SK_ROUTE:
+		rc = v = scenario_route(value);
+		break;
+	case SK_MIX:
+		rc = scenario_parse_mix(value, (double *) field);
+		break;
+	case SK_SHIFTS:
+		rc = scenario_parse_shifts(value, sc);
+		break;
+	case SK_WINDOW:
+		rc = scenario_parse_window(value,
+				(struct scenario_shift *) field);
+		break;
+	case SK_HIST:
+	case SK_RATE:
+		rc = scenario_parse_pairs(k->kind, value,
+				(struct dist *) field);
+		break;
+	default:
+		rc = scenario_parse_value(k->kind, value, &v);
+		break;
+	}
+	if (rc == -1) {
+		fprintf(stderr, "%s: bad value '%s' for %s\n", where, value,
+				key);
+		return -1;
+	}
+
+	switch (k->kind)
+	{
+	case SK_TIME:
+	case SK_COUNT:
+	case SK_SECS:
+	case SK_ROUTE:
+		*(int *) field = v;
+		break;
+	case SK_LO:
+		((struct sim_range *) field)->lo = (unsigned int) v;
+		break;
+	case SK_HI:
+		((struct sim_range *) field)->hi = (unsigned int) v;
+		break;
+	case SK_DIST:
+		((struct dist *) field)->kind = v;
+		break;
+	case SK_MEAN:
+		((struct dist *) field)->mean = v;
+		break;
+	case SK_SD:
+		((struct dist *) field)->sd = v;
+		break;
+	}
+	return 0;
+}
+
+/*
+ * Reads a scenario file, one assignment per line.
+ */
+static int scenario_load_file(struct scenario *sc, const char *path)
+{
+	FILE *in = fopen(path, "r");
+	if (in == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	char line[256];
+	char where[256];
+	int lineno = 0;
+	int rc = 0;
+	while (rc == 0 && fgets(line, sizeof(line), in) != NULL) {
+		lineno++;
+		char *hash = strchr(line, '#');
+		if (hash != NULL) *hash = '\0';
+
+		snprintf(where, sizeof(where), "%s:%d", path, lineno);
+		rc = scenario_assign(sc, line, where);
+	}
+
+	fclose(in);
+	return rc;
+}
+
+/*
+ * Reads a comma separated list of assignments.
+ */
+static int scenario_load_list(struct scenario *sc, const char *list)
+{
+	char *copy = strdup(list);
+	if (copy == NULL) {
+		perror(list);
+		return -1;
+	}
+
+	int rc = 0;
+	char *save;
+	char *item = strtok_r(copy, ",", &save);
+	while (rc == 0 && item != NULL) {
+		rc = scenario_assign(sc, item, list);
+		item = strtok_r(NULL, ",", &save);
+	}
+
+	free(copy);
+	return rc;
+}
+
+/*
+ * Checks that the scenario describes a bank which can be simulated, and
+ * precomputes its ranges and sampling tables. Returns NULL, or what is
+ * wrong with the scenario.
+ */
+static const char *scenario_finish(struct scenario *sc)
+{
+	if (sc->sec_open >= sc->sec_close) return "the bank never opens";
+	if (sc->n_tellers < 1 || sc->n_tellers > SCENARIO_MAX_TELLERS) {
+		return "tellers must be between 1 and 4096";
+	}
+	if (sc->n_branches < 1 || sc->n_branches > SCENARIO_MAX_BRANCHES) {
+		return "branches must be between 1 and 256";
+	}
+	if (sc->n_queues < 1 || sc->n_queues > SCENARIO_MAX_QUEUES) {
+		return "queues must be between 1 and 16";
+	}
+	if (sc->n_queues > sc->n_tellers) {
+		return "every queue needs a teller";
+	}
+	if (sc->steal > 1) return "steal must be 0 or 1";
+	if (sc->transfer_sec < 1) {
+		return "transfer_sec must be at least 1 second";
+	}
+
+	/* Tellers only work while the bank is open */
+	int s;
+	for (s = 0; s < sc->n_shifts; s++) {
+		if (sc->shifts[s].sec_in < sc->sec_open
+				|| sc->shifts[s].sec_out > sc->sec_close) {
+			return "shifts must lie within opening hours";
+		}
+	}
+	if (sc->lunch_len > 0 && sc->lunch_len > sc->lunch.sec_out
+			- sc->lunch.sec_in) {
+		return "lunch_len must fit into the lunch window";
+	}
+
+	struct sim_range *ranges[] = { &sc->tbreak, &sc->lbreak };
+	unsigned int i;
+	for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+		struct sim_range *r = ranges[i];
+		if (r->lo + SIM_CHOOSE_HI_EXCLUSIVE > r->hi) {
+			return "a lower bound exceeds its upper bound";
+		}
+		/* A teller must not go on break without time passing */
+		if (r->lo < 1) {
+			return "tbreak_lo and lbreak_lo must be at least 1 "
+					"second";
+		}
+		sim_range_init(r, r->lo, r->hi);
+	}
+
+	const char *err;
+	if ((err = dist_build(&sc->arrive)) != NULL) return err;
+	if ((err = dist_build(&sc->transt)) != NULL) return err;
+
+	/* A transaction has no time of day to vary its rate with */
+	if (sc->transt.kind == DIST_PIECEWISE) {
+		return "transactions can't be piecewise";
+	}
+
+	/* Customers must not arrive without time passing */
+	if (sc->arrive.kind == DIST_UNIFORM && sc->arrive.range.lo < 1) {
+		return "arrive_lo must be at least 1 second";
+	}
+	if (sc->arrive.kind == DIST_EMPIRICAL) {
+		for (i = 0; i < (unsigned int) sc->arrive.n_bins; i++) {
+			if (sc->arrive.bin_value[i] < 1) {
+				return "arrive_hist values must be at least "
+						"1 second";
+			}
+		}
+	}
+
+	/* Cut the draws of ROUTE_MIX by the lines' weights */
+	double total = 0;
+	for (i = 0; i < (unsigned int) sc->n_queues; i++) {
+		total += sc->queue_mix[i];
+	}
+	double cum = 0;
+	for (i = 0; i < (unsigned int) sc->n_queues; i++) {
+		/* With no weights given, the kinds are equally likely */
+		cum += total > 0 ? sc->queue_mix[i] / total
+				: 1.0 / sc->n_queues;
+		sc->mix_cut[i] = cum >= 1 ? UINT32_MAX
+				: (uint32_t) (cum * 4294967296.0);
+	}
+
+	return NULL;
+}
+
+/**
+ * Initializes a scenario to the bank of the assignment (see bank.h).
+ *
+ * Params: sc - the scenario to initialize
+ * Return: void
+ */
+void scenario_init(struct scenario *sc)
+{
+	static const struct scenario bank = BANK_SCENARIO;
+	*sc = bank;
+}
+
+/**
+ * Loads a scenario. If spec contains a '=', it is a comma separated list of
+ * assignments (e.g. "tellers=4,arrive_hi=3m"). Otherwise, it is the path of
+ * a scenario file. Keys which are not assigned keep the value of the bank of
+ * the assignment. Errors are printed to stderr.
+ *
+ * Params: sc   - storage for the scenario
+ *         spec - the assignments, or the path of the scenario file
+ * Return: 0 on success, -1 if the scenario could not be loaded
+ */
+int scenario_load(struct scenario *sc, const char *spec)
+{
+	scenario_init(sc);
+
+#ifdef SCENARIO_FIXED
+	fprintf(stderr, "%s: built with SCENARIO_FIXED, the scenario can't "
+		"be changed\n", spec);
+	return -1;
+#endif
+
+	int rc;
+	if (strchr(spec, '=') != NULL) {
+		rc = scenario_load_list(sc, spec);
+	} else {
+		rc = scenario_load_file(sc, spec);
+	}
+	if (rc == -1) return -1;
+
+	const char *err = scenario_finish(sc);
+	if (err != NULL) {
+		fprintf(stderr, "%s: %s\n", spec, err);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Parses a number of seconds, or of minutes with an 'm' suffix (e.g. "4m"),
+ * as the values of a scenario's keys are written.
+ *
+ * Params: str  - the number
+ *         secs - storage for the seconds
+ * Return: 0 on success, -1 if str is not a number of seconds
+ */
+int scenario_parse_secs(const char *str, int *secs)
+{
+	return scenario_parse_value(SK_SECS, str, secs);
+}
+
+/**
+ * The most customers which can enter the bank in a day of the scenario (see
+ * dist_max_count()). The arrivals of a day end early if they are used up.
+ *
+ * Params: sc - the scenario
+ * Return: the number of customers
+ */
+int scenario_max_customers(const struct scenario *sc)
+{
+	return dist_max_count(&sc->arrive, sc->sec_open, sc->sec_close);
+}
+
+/**
+ * Draws the arrivals and transaction times of a day's customers up front,
+ * in bulk: customer n enters the bank arrive[n] seconds after customer
+ * n - 1 did (or after the bank opened), and its transaction lasts transt[n]
+ * seconds. The customer draws come from stream 0 of the day's seed, such
+ * that tellers can draw their breaks from streams 1 and up.
+ *
+ * Params: sc     - the scenario
+ *         seed   - the seed of the day
+ *         arrive - storage for scenario_max_customers() arrivals
+ *         transt - storage for scenario_max_customers() transaction times
+ * Return: void
+ */
+void scenario_draw_day(const struct scenario *sc, uint64_t seed,
+		int *arrive, int *transt)
+{
+	size_t n = (size_t) scenario_max_customers(sc);
+	struct rng_bulk b;
+
+	rng_bulk_seed(&b, seed, 0);
+	dist_fill(&sc->arrive, &b, arrive, n, sc->sec_open);
+	dist_fill(&sc->transt, &b, transt, n, 0);
+}
+
+/*
+ * Prints a scenario's roster on a CON> line.
+ */
+static void scenario_print_roster(const struct scenario *sc)
+{
+	printf("CON> Roster:");
+	if (sc->n_shifts > 0) printf(" shifts");
+
+	int s;
+	for (s = 0; s < sc->n_shifts; s++) {
+		const struct scenario_shift *w = &sc->shifts[s];
+		printf(" %02d:%02d-%02d:%02d", w->sec_in / 3600,
+				w->sec_in / 60 % 60, w->sec_out / 3600,
+				w->sec_out / 60 % 60);
+	}
+	if (sc->lunch_len > 0) {
+		printf("%s lunch %d s in %02d:%02d-%02d:%02d",
+				sc->n_shifts > 0 ? "," : "", sc->lunch_len,
+				sc->lunch.sec_in / 3600,
+				sc->lunch.sec_in / 60 % 60,
+				sc->lunch.sec_out / 3600,
+				sc->lunch.sec_out / 60 % 60);
+	}
+	if (sc->max_off > 0) {
+		printf("%s at most %d off at once",
+				sc->n_shifts > 0 || sc->lunch_len > 0 ? ","
+						: "", sc->max_off);
+	}
+	printf(".\n");
+}
+
+/**
+ * Prints a scenario's parameters on a CON> line.
+ *
+ * Params: sc - the scenario to print
+ * Return: void
+ */
+void scenario_print(const struct scenario *sc)
+{
+	char arrive[64], transt[64];
+	dist_describe(&sc->arrive, arrive, sizeof(arrive));
+	dist_describe(&sc->transt, transt, sizeof(transt));
+
+	printf("CON> Scenario: %d tellers, open %02d:%02d-%02d:%02d, arrivals "
+		"%s, transactions %s, breaks every %u-%u s for %u-%u s.\n",
+			sc->n_tellers, sc->sec_open / 3600,
+			sc->sec_open / 60 % 60, sc->sec_close / 3600,
+			sc->sec_close / 60 % 60, arrive, transt,
+			sc->tbreak.lo, sc->tbreak.hi, sc->lbreak.lo,
+			sc->lbreak.hi);
+
+	if (sc->n_shifts > 0 || sc->lunch_len > 0 || sc->max_off > 0) {
+		scenario_print_roster(sc);
+	}
+	if (sc->n_branches == 1 && sc->n_queues == 1) return;
+
+	static const char *routes[] = { "mix", "jsq", "p2c" };
+	printf("CON> Topology: branches %d, lines %d, routed by %s%s",
+			sc->n_branches, sc->n_queues, routes[sc->route],
+			sc->steal ? ", with stealing" : "");
+	if (sc->transfer_at > 0) {
+		printf(", transfers at %d in line (%d s)", sc->transfer_at,
+				sc->transfer_sec);
+	}
+	printf(".\n");
+}
@@ -0,0 +1,104 @@
+#ifndef SCENARIO_H_
+#define SCENARIO_H_
+
+/*
+ * Proj: 4
+ * File: scenario.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to scenarios. A scenario holds
+ * every parameter of the bank model: opening hours, the number of tellers,
+ * the distributions arrivals and transactions are drawn from (see dist.h),
+ * and the ranges breaks are drawn from. The ranges and the distributions'
+ * sampling tables are precomputed once, when the scenario is set up.
+ *
+ * A scenario may also describe a region: a number of identical branches,
+ * each with a number of lines (queues) and their tellers. Arrivals are
+ * routed to a line of their branch by a routing policy, and may be
+ * transferred to the next branch when their line is too long (see
+ * region.h).
+ *
+ * A scenario may also give the tellers a roster: shifts, a lunch, and a
+ * limit on the tellers off at once (see roster.h).
+ *
+ * Scenarios are loaded at run time, from a file of "key = value" lines or
+ * from a list of "key=value" assignments, such that parameter sweeps need no
+ * rebuild (see scenario_load()). Keys not given keep the value of the bank
+ * of the assignment (see bank.h).
+ *
+ * Simulation code reaches its scenario through SCENARIO(). A build with
+ * SCENARIO_FIXED defined ignores the run time scenario, and SCENARIO()
+ * yields a compile time constant instead, such that every parameter folds
+ * into the code as the plain constants of the assignment did.
+ */
+
+#include "sim.h"
+#include "dist.h"
+#include "bank.h"
+
+#define SCENARIO_MAX_TELLERS 4096 /* The most tellers a scenario can have */
+#define SCENARIO_MAX_BRANCHES 256 /* The most branches of a region */
+#define SCENARIO_MAX_QUEUES 16 /* The most lines of a branch */
+#define SCENARIO_MAX_SHIFTS 16 /* The most shifts of a roster */
+
+#define ROUTE_MIX 0 /* To the line of the customer's kind (see queue_mix) */
+#define ROUTE_JSQ 1 /* To the shortest line */
+#define ROUTE_P2C 2 /* To the shorter of two lines picked at random */
+
+/*
+ * A window of the day, such as a shift.
+ */
+struct scenario_shift
+{
+	int sec_in; /* The second the window starts */
+	int sec_out; /* The second the window ends */
+};
+
+struct scenario
+{
+	int sec_open; /* The second at which the bank opens */
+	int sec_close; /* The second at which the bank closes */
+	int n_tellers; /* The number of tellers in the system (per branch) */
+	struct dist arrive; /* Seconds between customer arrivals */
+	struct sim_range tbreak; /* Seconds between teller breaks */
+	struct sim_range lbreak; /* Seconds a teller break lasts */
+	struct dist transt; /* Seconds a transaction lasts */
+
+	/* The topology of a region, see region.h */
+	int n_branches; /* The number of branches */
+	int n_queues; /* Lines per branch, teller t serves line t % n_queues */
+	int route; /* How arrivals pick a line, one of the ROUTE_ policies */
+	double queue_mix[SCENARIO_MAX_QUEUES]; /* The weight of each kind */
+	uint32_t mix_cut[SCENARIO_MAX_QUEUES]; /* Draws below go to the kind */
+	int steal; /* If set, idle tellers serve the other lines too */
+	int transfer_at; /* Arrivals finding this many in line move on */
+	int transfer_sec; /* Seconds a transfer to the next branch takes */
+
+	/* The roster of the tellers, see roster.h */
+	int n_shifts; /* The shifts, 0 if every teller works opening hours */
+	struct scenario_shift shifts[SCENARIO_MAX_SHIFTS]; /* Of t % n_shifts */
+	struct scenario_shift lunch; /* The window lunches are taken in */
+	int lunch_len; /* Seconds a lunch lasts, 0 for no lunch */
+	int max_off; /* The most tellers off at once, 0 for any number */
+};
+
+#ifdef SCENARIO_FIXED
+static const struct scenario scenario_fixed = BANK_SCENARIO;
+#define SCENARIO(SC) (&scenario_fixed)
+#else
+#define SCENARIO(SC) (SC)
+#endif
+
+void scenario_init(struct scenario *sc);
+int scenario_load(struct scenario *sc, const char *spec);
+
+int scenario_parse_secs(const char *str, int *secs);
+int scenario_parse_shifts(const char *str, struct scenario *sc);
+int scenario_max_customers(const struct scenario *sc);
+void scenario_draw_day(const struct scenario *sc, uint64_t seed,
+		int *arrive, int *transt);
+void scenario_print(const struct scenario *sc);
+
+#endif
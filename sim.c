@@ -1,6 +1,6 @@
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
-#include <stdlib.h> /* For random call */
 #include <time.h>
 #include "sim.h"
 
@@ -23,47 +23,95 @@
  * the way up through hi. Otherwise, numbers will be returned all the way
  * up through hi - 1.
  *
- * Each thread using sim_choose needs to maintain its own seed such that the
- * random numbers emitted are not corrupted across calls to this method.
+ * Each thread using sim_choose needs to maintain its own generator such that
+ * the random numbers emitted are not corrupted across calls to this method.
+ * Ranges drawn from repeatedly are better set up once, and drawn from with
+ * sim_draw().
  *
- * Params: seed - a thread-local unit of storage
- *         lo   - the lower bound of random numbers returned
- *         hi   - the upper bound of random numbers returned
+ * Params: rng - the calling thread's generator
+ *         lo  - the lower bound of random numbers returned
+ *         hi  - the upper bound of random numbers returned
  * Return: The randomized number within the specified range
  */
-int sim_choose(unsigned int *seed, unsigned int lo, unsigned int hi)
+int sim_choose(struct rng *rng, unsigned int lo, unsigned int hi)
 {
-#if SIM_CHOOSE_HI_EXCLUSIVE
-	hi--;
-#endif
-	/*
-	 * The chosen random second is 'y' in the following linear function,
-	 * where 'x' is a random unsigned integer produced by the QNX system.
-	 *
-	 * The implementation actually multiplies x by the numerator such that
-	 * the final division results in a number with a whole part.
-	 *
-	 *                  /        hi - lo        \
-	 * 	y = f(x) =  | --------------------- | x + lo
-	 *                  \  RAND_MAX - 0         /
-	 *
-	 * The QNX call random() returns a long. The cast to an unsigned int
-	 * as performed below is not portable!
-	 *
-	 * Furthermore, the random number must be downscaled to the UINT16
-	 * range for the function above to work. QNX just can't avoid overflow
-	 * when working with huge numbers.
-	 */
-	unsigned int x = ((unsigned int) rand_r(seed));
-	unsigned int y = ((x * (hi - lo)) / (RAND_MAX)) + lo;
-
-	return (int) y;
+	struct sim_range r;
+	sim_range_init(&r, lo, hi);
+	return sim_draw(rng, &r);
+}
+
+/**
+ * Initializes a range to draw from with sim_draw(), the same range
+ * sim_choose() would draw from for lo and hi.
+ *
+ * Params: r  - the range to initialize
+ *         lo - the lower bound of random numbers drawn
+ *         hi - the upper bound of random numbers drawn
+ * Return: void
+ */
+void sim_range_init(struct sim_range *r, unsigned int lo, unsigned int hi)
+{
+	r->lo = lo;
+	r->hi = hi;
+	r->span = SIM_SPAN(lo, hi);
+	r->thresh = (0u - r->span) % r->span;
+}
+
+#define SIM_DRAW_CHUNK 256 /* Draws sim_draw_n() scales at once */
+
+/**
+ * Fills an array with draws from a range, as sim_draw() would draw them one
+ * at a time. The random bits are generated in bulk, and scaled into the
+ * range by a loop the compiler vectorizes (it always scales a whole chunk,
+ * such that the loop's trip count is known at compile time). Rejections
+ * are rare enough (for the ranges of a bank, less than one in a million
+ * draws) that they are redrawn one at a time, after the fact.
+ *
+ * Params: b   - the bulk generator to draw with
+ *         r   - the range to draw from
+ *         out - storage for n draws
+ *         n   - the number of draws
+ * Return: void
+ */
+void sim_draw_n(struct rng_bulk *b, const struct sim_range *r, int *out,
+		size_t n)
+{
+	uint32_t x[SIM_DRAW_CHUNK];
+	int y[SIM_DRAW_CHUNK];
+	uint32_t lo = r->lo, span = r->span, thresh = r->thresh;
+
+	size_t i;
+	for (i = 0; i < n; i += SIM_DRAW_CHUNK) {
+		rng_bulk_fill(b, x, SIM_DRAW_CHUNK);
+
+		uint32_t rejected = 0;
+		int j;
+		for (j = 0; j < SIM_DRAW_CHUNK; j++) {
+			uint64_t m = (uint64_t) x[j] * span;
+			rejected |= (uint32_t) m < thresh;
+			y[j] = (int) (lo + (uint32_t) (m >> 32));
+		}
+
+		if (rejected) {
+			for (j = 0; j < SIM_DRAW_CHUNK; j++) {
+				uint64_t m = (uint64_t) x[j] * span;
+				if ((uint32_t) m < thresh) {
+					y[j] = sim_draw(&b->spare, r);
+				}
+			}
+		}
+
+		size_t len = min(n - i, (size_t) SIM_DRAW_CHUNK);
+		memcpy(out + i, y, len * sizeof(int));
+	}
 }
 
 /**
  * Sleeps the calling thread for the number of simulated seconds provided,
  * and updates the calling thread's simulation accounting (via the pointer
- * to sim_sec).
+ * to sim_sec). Sleeps of 10 simulated minutes and more (a second of wall
+ * time, such as a lunch or the wait for a late shift) are split into whole
+ * seconds and nanoseconds, as nanosleep refuses 10^9 nanoseconds or more.
  *
  * Params: sim_seconds - the number of simulated seconds to sleep for
  *         sim_sec     - a pointer to the calling threads simulation accounting
@@ -71,9 +119,11 @@ int sim_choose(unsigned int *seed, unsigned int lo, unsigned int hi)
  */
 void sim_sleep(int sim_seconds, int *sim_sec)
 {
+	int64_t nanos = (int64_t) sim_seconds * NSC_PER_SIM_SEC;
+
 	struct timespec rqtp;
-	rqtp.tv_sec = 0;
-	rqtp.tv_nsec = SIM_SEC_TO_NSC(sim_seconds);
+	rqtp.tv_sec = (time_t) (nanos / 1000000000);
+	rqtp.tv_nsec = (long) (nanos % 1000000000);
 
 	clock_nanosleep(CLOCK_REALTIME, 0, &rqtp, NULL);
 
@@ -152,9 +202,101 @@ void sim_elaps_calc(struct timespec *t0, int *sim_sec)
 
 	*sim_sec += inter;
 }
+
+/*
+ * The two digits of every number from 0 to 99, such that times are written
+ * two digits at a time, by table lookup.
+ */
+static const char sim_digits[200] =
+	"00010203040506070809" "10111213141516171819"
+	"20212223242526272829" "30313233343536373839"
+	"40414243444546474849" "50515253545556575859"
+	"60616263646566676869" "70717273747576777879"
+	"80818283848586878889" "90919293949596979899";
+
+static int sim_fmt = SIM_TIME_AMPM; /* The format of sim_fmt_time() */
+
+/*
+ * Writes the two digits of x (0 to 99) to buf.
+ */
+static inline void sim_put2(char *buf, int x)
+{
+	memcpy(buf, &sim_digits[2 * x], 2);
+}
+
+/**
+ * Looks up a time format by name: "ampm", "iso" or "raw".
+ *
+ * Params: name - the name of the format
+ * Return: the format (a SIM_TIME_ constant), or -1 if there is none by name
+ */
+int sim_time_fmt(const char *name)
+{
+	if (strcmp(name, "ampm") == 0) return SIM_TIME_AMPM;
+	if (strcmp(name, "iso") == 0) return SIM_TIME_ISO;
+	if (strcmp(name, "raw") == 0) return SIM_TIME_RAW;
+	return -1;
+}
+
+/**
+ * Sets the format of the times sim_fmt_time() writes, for the whole process.
+ * It must be set before any simulation thread formats a time.
+ *
+ * Params: fmt - the format, a SIM_TIME_ constant
+ * Return: void
+ */
+void sim_set_time_fmt(int fmt)
+{
+	sim_fmt = fmt;
+}
+
+/**
+ * Writes the provided number of seconds as a time of day, without going
+ * through printf (the simulation logs a time with every SIM> line). Times
+ * of 100 hours or more, or before midnight, are only written raw.
+ *
+ * Params: buf   - storage for at least SIM_TIME_LEN characters
+ *         sim_s - the number of seconds sim_s == 0 => t = 12:00:00 AM
+ *         fmt   - the format, a SIM_TIME_ constant
+ * Return: the length of the time written, not counting the NUL
+ */
+int sim_put_time(char *buf, int sim_s, int fmt)
+{
+	int mil_h = sim_s / 3600;
+	if (sim_s < 0) return snprintf(buf, SIM_TIME_LEN, "%d", sim_s);
+	if (fmt == SIM_TIME_RAW || mil_h > 99) {
+		char rev[10];
+		int len = 0, i;
+		do {
+			rev[len++] = '0' + sim_s % 10;
+			sim_s /= 10;
+		} while (sim_s > 0);
+		for (i = 0; i < len; i++) buf[i] = rev[len - 1 - i];
+		buf[len] = '\0';
+		return len;
+	}
+
+	const char *xm = mil_h >= 12 ? " PM" : " AM";
+	if (fmt == SIM_TIME_AMPM && mil_h > 12) mil_h -= 12;
+
+	sim_put2(buf, mil_h);
+	buf[2] = ':';
+	sim_put2(buf + 3, sim_s / 60 % 60);
+	buf[5] = ':';
+	sim_put2(buf + 6, sim_s % 60);
+	if (fmt == SIM_TIME_ISO) {
+		buf[8] = '\0';
+		return 8;
+	}
+
+	memcpy(buf + 8, xm, 4);
+	return 11;
+}
+
 /*
  * This function formats the provided number of seconds as a time string (in
- * AM/PM notation). The result is stored in the provided buffer
+ * AM/PM notation, unless sim_set_time_fmt() chose another format). The result
+ * is stored in the provided buffer
  *
  * Params: thd_buf - allocated memory to store formatted string in
  *         count   - num chars in thd_buf
@@ -163,22 +305,11 @@ void sim_elaps_calc(struct timespec *t0, int *sim_sec)
  */
 void sim_fmt_time(char* thd_buf, size_t count, int sim_s)
 {
-	int mil_h, mil_m, mil_s;
-	mil_m = sim_s / 60;
-	mil_s = sim_s % 60;
-	mil_h = mil_m / 60;
-	mil_m = mil_m % 60;
-
-	char *xm;
-	if (mil_h > 12) {
-		mil_h -= 12;
-		xm = "PM";
-	} else if (mil_h == 12) {
-		xm = "PM";
-	} else {
-		xm = "AM";
-	}
+	char buf[5 + SIM_TIME_LEN] = "SIM> ";
+	int len = 5 + sim_put_time(buf + 5, sim_s, sim_fmt);
 
-	snprintf(thd_buf, count, "SIM> %02d:%02d:%02d %s", mil_h, mil_m, mil_s,
-			xm);
+	if (count == 0) return;
+	if ((size_t) len >= count) len = count - 1;
+	memcpy(thd_buf, buf, len);
+	thd_buf[len] = '\0';
 }
@@ -15,6 +15,8 @@
  */
 
 #include <unistd.h> /* For size_t */
+#include <time.h> /* For struct timespec */
+#include "rng.h"
 
 /*
  * Number of nanoseconds per simulated second
@@ -52,14 +54,79 @@
  */
 #define MIN_TO_SEC(MI) (60 * MI)
 
+/*
+ * The smaller of two values. QNX's <stdlib.h> provides this, other C
+ * libraries don't.
+ */
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
 #define SIM_CHOOSE_HI_EXCLUSIVE 0
-int sim_choose(unsigned int *seed, unsigned int lo, unsigned int hi);
+
+/*
+ * A range sim_draw() draws from. The number of values in the range (span)
+ * and the rejection threshold of Lemire's method (thresh, 2^32 mod span)
+ * are precomputed, such that an unbiased draw takes one multiply. Initialize
+ * with SIM_RANGE() or sim_range_init().
+ */
+struct sim_range
+{
+	unsigned int lo; /* The lower bound */
+	unsigned int hi; /* The upper bound, as configured */
+	unsigned int span; /* The number of values drawn from */
+	unsigned int thresh; /* Products with a lower low half are redrawn */
+};
+
+#define SIM_SPAN(LO, HI) ((HI) - (LO) + 1 - SIM_CHOOSE_HI_EXCLUSIVE)
+#define SIM_RANGE(LO, HI) { (LO), (HI), SIM_SPAN(LO, HI), \
+		(0u - SIM_SPAN(LO, HI)) % SIM_SPAN(LO, HI) }
+
+int sim_choose(struct rng *rng, unsigned int lo, unsigned int hi);
+void sim_range_init(struct sim_range *r, unsigned int lo, unsigned int hi);
+void sim_draw_n(struct rng_bulk *b, const struct sim_range *r, int *out,
+		size_t n);
+
+/**
+ * Draws a pseudo-random number from a range, every value of the range
+ * being equally likely. Inlined, such that a range known at compile time
+ * folds into the draw.
+ *
+ * The 32 random bits x are scaled into the range as the high half of
+ * x * span (Lemire). The few x whose low half falls under the threshold
+ * would make some values more likely than others, and are redrawn.
+ *
+ * Params: rng - the drawing thread's generator
+ *         r   - the range to draw from
+ * Return: The randomized number within the range
+ */
+static inline int sim_draw(struct rng *rng, const struct sim_range *r)
+{
+	uint64_t m;
+	do {
+		m = (uint64_t) rng_next(rng) * r->span;
+	} while ((uint32_t) m < r->thresh);
+
+	return (int) (r->lo + (uint32_t) (m >> 32));
+}
 
 void sim_sleep(int sim_seconds, int *sim_sec);
 
 void sim_elaps_init(struct timespec *t0);
 void sim_elaps_calc(struct timespec *t0, int *sim_sec);
 
+/*
+ * The formats of a time of day, see sim_put_time().
+ */
+#define SIM_TIME_AMPM 0 /* 09:05:00 AM, as the assignment prints times */
+#define SIM_TIME_ISO 1 /* 09:05:00, an ISO 8601 time of day */
+#define SIM_TIME_RAW 2 /* 32700, the seconds since midnight */
+
+#define SIM_TIME_LEN 12 /* Storage for the longest time, with its NUL */
+
+int sim_time_fmt(const char *name);
+void sim_set_time_fmt(int fmt);
+int sim_put_time(char *buf, int sim_s, int fmt);
 void sim_fmt_time(char* thd_buf, size_t count, int sim_s);
 
 #endif
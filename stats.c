@@ -0,0 +1,178 @@
+/*
+ * Proj: 4
+ * File: stats.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in stats.h.
+ *
+ * A value v >= STATS_SUB_BUCKETS with its highest set bit at position e is
+ * counted in the bucket of its top STATS_SUB_BITS + 1 bits. The bucket spans
+ * 2^(e - STATS_SUB_BITS) values, which bounds the error of a quantile to
+ * about 1 / STATS_SUB_BUCKETS of its value.
+ */
+
+#include <string.h> /* For memset */
+#include "stats.h"
+
+/*
+ * Position of the highest set bit of v (v > 0).
+ */
+static int stats_msb(unsigned int v)
+{
+	return 31 - __builtin_clz(v);
+}
+
+/*
+ * Maps a non-negative value to its histogram bucket.
+ */
+static int stats_bucket(unsigned int v)
+{
+	if (v < STATS_SUB_BUCKETS) return v;
+
+	int shift = stats_msb(v) - STATS_SUB_BITS;
+	int mant = (v >> shift) - STATS_SUB_BUCKETS;
+
+	return STATS_SUB_BUCKETS * (shift + 1) + mant;
+}
+
+/*
+ * The lowest value counted in a bucket, and the number of values it spans.
+ */
+static void stats_bucket_range(int b, long *lo, long *width)
+{
+	if (b < STATS_SUB_BUCKETS) {
+		*lo = b;
+		*width = 1;
+		return;
+	}
+
+	int shift = b / STATS_SUB_BUCKETS - 1;
+	int mant = b % STATS_SUB_BUCKETS;
+
+	*lo = (long) (STATS_SUB_BUCKETS + mant) << shift;
+	*width = 1L << shift;
+}
+
+/**
+ * Initializes an accumulator without any samples.
+ *
+ * Params: acc - the accumulator to initialize
+ * Return: void
+ */
+void stats_init(struct stats_acc *acc)
+{
+	memset(acc, 0, sizeof(struct stats_acc));
+}
+
+/**
+ * Adds a sample to an accumulator. Negative samples are counted as 0 by the
+ * histogram, but keep their value in the mean, variance and minimum.
+ *
+ * Params: acc - the accumulator to add to
+ *         x   - the sample
+ * Return: void
+ */
+void stats_add(struct stats_acc *acc, int x)
+{
+	if (acc->n == 0 || x < acc->min) acc->min = x;
+	if (acc->n == 0 || x > acc->max) acc->max = x;
+
+	acc->n++;
+	double delta = x - acc->mean;
+	acc->mean += delta / acc->n;
+	acc->m2 += delta * (x - acc->mean);
+
+	acc->hist[stats_bucket(x > 0 ? (unsigned int) x : 0)]++;
+}
+
+/**
+ * Merges the samples of another accumulator into an accumulator.
+ *
+ * Params: acc   - the accumulator to merge into
+ *         other - the accumulator to merge from
+ * Return: void
+ */
+void stats_merge(struct stats_acc *acc, const struct stats_acc *other)
+{
+	if (other->n == 0) return;
+
+	if (acc->n == 0 || other->min < acc->min) acc->min = other->min;
+	if (acc->n == 0 || other->max > acc->max) acc->max = other->max;
+
+	long n = acc->n + other->n;
+	double delta = other->mean - acc->mean;
+	acc->mean += delta * other->n / n;
+	acc->m2 += other->m2 + delta * delta * acc->n * other->n / n;
+	acc->n = n;
+
+	int b;
+	for (b = 0; b < STATS_BUCKETS; b++) {
+		acc->hist[b] += other->hist[b];
+	}
+}
+
+/**
+ * Returns the sample variance of the samples.
+ *
+ * Params: acc - the accumulator
+ * Return: the sample variance, or 0 with fewer than two samples
+ */
+double stats_variance(const struct stats_acc *acc)
+{
+	return acc->n > 1 ? acc->m2 / (acc->n - 1) : 0;
+}
+
+/**
+ * Returns the q-quantile of the samples: the value at or below which a
+ * fraction q of the samples lie. The value is the middle of the histogram
+ * bucket holding that sample, clamped to the minimum and maximum sample.
+ *
+ * Params: acc - the accumulator
+ *         q   - the quantile, from 0 to 1 (e.g. 0.95 for p95)
+ * Return: the quantile, or 0 without samples
+ */
+int stats_quantile(const struct stats_acc *acc, double q)
+{
+	if (acc->n == 0) return 0;
+
+	unsigned long long rank = (unsigned long long) (q * acc->n + 0.5);
+	if (rank < 1) rank = 1;
+
+	unsigned long long seen = 0;
+	int b;
+	for (b = 0; b < STATS_BUCKETS - 1; b++) {
+		seen += acc->hist[b];
+		if (seen >= rank) break;
+	}
+
+	long lo, width;
+	stats_bucket_range(b, &lo, &width);
+	long v = lo + (width - 1) / 2;
+
+	if (v < acc->min) v = acc->min;
+	if (v > acc->max) v = acc->max;
+	return (int) v;
+}
+
+/**
+ * Returns the number of samples at or below a value, to the precision of the
+ * histogram: the samples of the bucket holding x all count as at or below
+ * it. Suits the cumulative buckets of a Prometheus histogram.
+ *
+ * Params: acc - the accumulator
+ *         x   - the value
+ * Return: the number of samples
+ */
+long stats_count_le(const struct stats_acc *acc, int x)
+{
+	if (x < 0) return 0;
+
+	long n = 0;
+	int b, last = stats_bucket((unsigned int) x);
+	for (b = 0; b <= last; b++) {
+		n += (long) acc->hist[b];
+	}
+	return n;
+}
@@ -0,0 +1,50 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+/*
+ * Proj: 4
+ * File: stats.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the streaming statistics
+ * module. An accumulator takes one sample at a time and keeps, in constant
+ * memory, the count, mean, variance, minimum and maximum of the samples, as
+ * well as a histogram from which quantiles (p50, p95, p99, ...) are read.
+ *
+ * The histogram is log-linear (as in HdrHistogram): values below
+ * STATS_SUB_BUCKETS are counted exactly, and larger values are counted in
+ * buckets no wider than 1/STATS_SUB_BUCKETS of their value. Accumulators
+ * can be merged, e.g. to pool the samples of many replications, without
+ * losing precision.
+ */
+
+#define STATS_SUB_BITS 5
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BITS) /* Buckets per power of 2 */
+
+/*
+ * Enough buckets for every non-negative int: STATS_SUB_BUCKETS exact
+ * buckets, then STATS_SUB_BUCKETS buckets per power of two up to 2^31.
+ */
+#define STATS_BUCKETS (STATS_SUB_BUCKETS * (32 - STATS_SUB_BITS))
+
+struct stats_acc
+{
+	long n; /* The number of samples */
+	double mean; /* Running mean (Welford) */
+	double m2; /* Running sum of squared deviations (Welford) */
+	int min; /* The smallest sample */
+	int max; /* The largest sample */
+	unsigned long long hist[STATS_BUCKETS]; /* Log-linear histogram */
+};
+
+void stats_init(struct stats_acc *acc);
+void stats_add(struct stats_acc *acc, int x);
+void stats_merge(struct stats_acc *acc, const struct stats_acc *other);
+
+double stats_variance(const struct stats_acc *acc);
+int stats_quantile(const struct stats_acc *acc, double q);
+long stats_count_le(const struct stats_acc *acc, int x);
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Proj: 4
+ * File: trace.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in trace.h.
+ *
+ * Every recording thread fills its own buffer, so recording a row takes no
+ * lock. Only writing a full block out takes the trace's mutex. The header is
+ * written as a placeholder when the trace is opened, and rewritten with the
+ * final counts when it is closed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+/*
+ * Writes a block of n_rows rows out of the given columns.
+ */
+static void trace_write_block(struct trace *tr, int kind, int n_cols,
+		int32_t (*cols)[TRACE_BLOCK_LEN], int n_rows)
+{
+	if (n_rows == 0) return;
+
+	struct trace_block blk;
+	blk.kind = kind;
+	blk.n_rows = n_rows;
+
+	pthread_mutex_lock(&tr->mutex);
+	fwrite(&blk, sizeof(struct trace_block), 1, tr->out);
+	int c;
+	for (c = 0; c < n_cols; c++) {
+		fwrite(cols[c], sizeof(int32_t), n_rows, tr->out);
+	}
+
+	tr->hdr.n_blocks++;
+	if (kind == TRACE_CUST) {
+		tr->hdr.n_cust += n_rows;
+	} else {
+		tr->hdr.n_breaks += n_rows;
+	}
+	pthread_mutex_unlock(&tr->mutex);
+}
+
+/**
+ * Creates a trace file, for n_bufs threads to record into.
+ *
+ * Params: tr        - the trace to open
+ *         path      - where to create the trace file
+ *         n_bufs    - the number of recording threads, numbered from 0
+ *         n_tellers - the number of tellers of the day
+ *         seed      - the seed of the day
+ * Return: 0 on success, -1 on failure (errno is set)
+ */
+int trace_open(struct trace *tr, const char *path, int n_bufs,
+		int n_tellers, unsigned int seed)
+{
+	if ((tr->out = fopen(path, "wb")) == NULL) return -1;
+
+	if ((tr->bufs = calloc(n_bufs, sizeof(struct trace_buf))) == NULL) {
+		fclose(tr->out);
+		return -1;
+	}
+	tr->n_bufs = n_bufs;
+	pthread_mutex_init(&tr->mutex, NULL);
+
+	memset(&tr->hdr, 0, sizeof(struct trace_header));
+	memcpy(tr->hdr.magic, TRACE_MAGIC, sizeof(tr->hdr.magic));
+	tr->hdr.version = TRACE_VERSION;
+	tr->hdr.n_tellers = n_tellers;
+	tr->hdr.seed = seed;
+	fwrite(&tr->hdr, sizeof(struct trace_header), 1, tr->out);
+
+	return 0;
+}
+
+/**
+ * Writes out every recorded row, completes the header and closes the trace
+ * file. No thread may record anymore.
+ *
+ * Params: tr - the trace to close
+ * Return: 0 on success, -1 if the trace could not be written completely
+ */
+int trace_close(struct trace *tr)
+{
+	int i;
+	for (i = 0; i < tr->n_bufs; i++) {
+		struct trace_buf *b = &tr->bufs[i];
+		trace_write_block(tr, TRACE_CUST, TRACE_CUST_COLS, b->cust,
+				b->n_cust);
+		trace_write_block(tr, TRACE_BREAK, TRACE_BREAK_COLS, b->breaks,
+				b->n_breaks);
+	}
+
+	int rc = 0;
+	if (fseek(tr->out, 0, SEEK_SET) != 0
+			|| fwrite(&tr->hdr, sizeof(struct trace_header), 1,
+					tr->out) != 1) {
+		rc = -1;
+	}
+	if (ferror(tr->out)) rc = -1;
+	if (fclose(tr->out) != 0) rc = -1;
+
+	pthread_mutex_destroy(&tr->mutex);
+	free(tr->bufs);
+	return rc;
+}
+
+/**
+ * Records a customer which a teller has polled and served. Does nothing if
+ * tr is NULL.
+ *
+ * Params: tr    - the trace to record into, or NULL
+ *         buf   - the recording thread's number
+ *         cs    - the store of the customer
+ *         cid   - the customer, with its transaction time set
+ *         tid   - the teller serving the customer
+ *         twait - seconds the teller waited for the customer
+ * Return: void
+ */
+void trace_customer(struct trace *tr, int buf,
+		const struct customer_store *cs, int cid, int tid, int twait)
+{
+	if (tr == NULL) return;
+
+	struct trace_buf *b = &tr->bufs[buf];
+	int row = b->n_cust++;
+	b->cust[TC_CID][row] = cid;
+	b->cust[TC_ENQUEUE][row] = cs->enqueue_sec[cid];
+	b->cust[TC_DEQUEUE][row] = cs->dequeue_sec[cid];
+	b->cust[TC_TRANST][row] = cs->time_with_teller[cid];
+	b->cust[TC_TWAIT][row] = twait;
+	b->cust[TC_TID][row] = tid;
+
+	if (b->n_cust == TRACE_BLOCK_LEN) {
+		trace_write_block(tr, TRACE_CUST, TRACE_CUST_COLS, b->cust,
+				b->n_cust);
+		b->n_cust = 0;
+	}
+}
+
+/**
+ * Records a teller break. Does nothing if tr is NULL.
+ *
+ * Params: tr    - the trace to record into, or NULL
+ *         buf   - the recording thread's number
+ *         tid   - the teller taking the break
+ *         start - the second the break started
+ *         end   - the second the break ended
+ * Return: void
+ */
+void trace_break(struct trace *tr, int buf, int tid, int start, int end)
+{
+	if (tr == NULL) return;
+
+	struct trace_buf *b = &tr->bufs[buf];
+	int row = b->n_breaks++;
+	b->breaks[TB_TID][row] = tid;
+	b->breaks[TB_START][row] = start;
+	b->breaks[TB_END][row] = end;
+
+	if (b->n_breaks == TRACE_BLOCK_LEN) {
+		trace_write_block(tr, TRACE_BREAK, TRACE_BREAK_COLS, b->breaks,
+				b->n_breaks);
+		b->n_breaks = 0;
+	}
+}
@@ -0,0 +1,97 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/*
+ * Proj: 4
+ * File: trace.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the binary trace format and the public interface to
+ * the trace writer. A trace records every customer's lifecycle and every
+ * teller break of a simulated day, such that the day can be analysed later
+ * (see replay/bank-replay) without simulating it again.
+ *
+ * The file is a trace_header, followed by blocks. Every block is a
+ * trace_block, followed by its columns: n_cols arrays of n_rows 32-bit
+ * integers each, one after the other. All fields are in the byte order of
+ * the machine that wrote the trace, and everything is 4-byte aligned, so a
+ * reader can mmap the file and loop over a column in place.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "customer_store.h"
+
+#define TRACE_MAGIC "BANKTRC1" /* The first 8 bytes of a trace */
+#define TRACE_VERSION 1
+
+#define TRACE_BLOCK_LEN 1024 /* The most rows in a block */
+
+/* Block kinds */
+#define TRACE_CUST 1 /* One row per served customer */
+#define TRACE_BREAK 2 /* One row per teller break */
+
+/* The columns of a TRACE_CUST block */
+#define TC_CID 0 /* The customer's id */
+#define TC_ENQUEUE 1 /* The second the customer entered the line */
+#define TC_DEQUEUE 2 /* The second a teller polled the customer */
+#define TC_TRANST 3 /* Seconds the transaction took */
+#define TC_TWAIT 4 /* Seconds the teller waited for this customer */
+#define TC_TID 5 /* The teller's id, indexed at 0 */
+#define TRACE_CUST_COLS 6
+
+/* The columns of a TRACE_BREAK block */
+#define TB_TID 0 /* The teller's id, indexed at 0 */
+#define TB_START 1 /* The second the break started */
+#define TB_END 2 /* The second the break ended */
+#define TRACE_BREAK_COLS 3
+
+struct trace_header
+{
+	char magic[8]; /* TRACE_MAGIC, without the terminating '\0' */
+	int32_t version; /* TRACE_VERSION */
+	int32_t n_tellers; /* The number of tellers of the day */
+	uint32_t seed; /* The seed of the day */
+	int32_t n_blocks; /* The number of blocks following the header */
+	int32_t n_cust; /* The number of TRACE_CUST rows */
+	int32_t n_breaks; /* The number of TRACE_BREAK rows */
+};
+
+struct trace_block
+{
+	int32_t kind; /* TRACE_CUST or TRACE_BREAK */
+	int32_t n_rows; /* The length of every column of the block */
+};
+
+/*
+ * The rows one thread has recorded but not yet written out.
+ */
+struct trace_buf
+{
+	int n_cust;
+	int32_t cust[TRACE_CUST_COLS][TRACE_BLOCK_LEN];
+	int n_breaks;
+	int32_t breaks[TRACE_BREAK_COLS][TRACE_BLOCK_LEN];
+};
+
+struct trace
+{
+	FILE *out; /* The trace file */
+	pthread_mutex_t mutex; /* Serializes writing blocks */
+	struct trace_header hdr;
+	int n_bufs; /* One buffer per recording thread */
+	struct trace_buf *bufs;
+};
+
+int trace_open(struct trace *tr, const char *path, int n_bufs,
+		int n_tellers, unsigned int seed);
+int trace_close(struct trace *tr);
+
+void trace_customer(struct trace *tr, int buf,
+		const struct customer_store *cs, int cid, int tid, int twait);
+void trace_break(struct trace *tr, int buf, int tid, int start, int end);
+
+#endif
@@ -0,0 +1,300 @@
+/*
+ * Proj: 4
+ * File: tsched.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in tsched.h.
+ *
+ * Every task which is not being stepped (and not done) has its timer set in
+ * a timer wheel (see twheel.h), to the second it is due, such that waking a
+ * parked task moves its timer in place. Workers sleep on a condition
+ * variable until the wall clock time of the earliest due second; a worker
+ * which takes a task while the next one is due as well passes the signal on,
+ * so a burst of due tasks spreads over the workers.
+ *
+ * A wake that finds no task parked is kept (as pending), and the next task
+ * to park is stepped again right away instead: it may have looked for work
+ * just before the waker made some. At worst this steps a task once for
+ * nothing.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "sim.h"
+#include "tsched.h"
+
+/*
+ * Makes a task due at sec: sets its timer, or moves it if it is set already.
+ * Signals a worker if the task became the earliest one.
+ */
+static void tsched_set_due(struct tsched *ts, int task, int sec)
+{
+	twheel_set(&ts->wheel, task, sec);
+	if (twheel_first(&ts->wheel) == task) pthread_cond_signal(&ts->cond);
+}
+
+/*
+ * Takes a task off the parked tasks.
+ */
+static void tsched_unpark(struct tsched *ts, int task)
+{
+	int i = ts->park_pos[task];
+	int last = ts->parked[--ts->n_parked];
+
+	ts->parked[i] = last;
+	ts->park_pos[last] = i;
+	ts->park_pos[task] = -1;
+}
+
+/*
+ * Computes the wall clock time (CLOCK_REALTIME) at which second sec of the
+ * simulation happens.
+ */
+static void tsched_wall(struct tsched *ts, int sec, struct timespec *ts_out)
+{
+	int64_t ns = (int64_t) (sec - ts->origin_sec) * NSC_PER_SIM_SEC
+			+ ts->origin.tv_nsec;
+
+	ts_out->tv_sec = ts->origin.tv_sec + (time_t) (ns / 1000000000);
+	ts_out->tv_nsec = (long) (ns % 1000000000);
+}
+
+/*
+ * Determines whether the wall clock has reached the given time.
+ */
+static int tsched_reached(const struct timespec *t)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	if (now.tv_sec != t->tv_sec) return now.tv_sec > t->tv_sec;
+	return now.tv_nsec >= t->tv_nsec;
+}
+
+/*
+ * Backs each worker: steps due tasks until every task is done.
+ */
+static void tsched_work(struct tsched *ts, int worker)
+{
+	pthread_mutex_lock(&ts->mutex);
+	while (ts->n_live > 0) {
+		int task = twheel_first(&ts->wheel);
+		if (task == -1) {
+			/* Everybody is being stepped, or parked for good */
+			pthread_cond_wait(&ts->cond, &ts->mutex);
+			continue;
+		}
+
+		struct timespec wake;
+		int now = ts->wheel.due[task];
+		tsched_wall(ts, now, &wake);
+		if (!tsched_reached(&wake)) {
+			pthread_cond_timedwait(&ts->cond, &ts->mutex, &wake);
+			continue;
+		}
+
+		twheel_cancel(&ts->wheel, task);
+		if (ts->park_pos[task] != -1) tsched_unpark(ts, task);
+		if (ts->wheel.n > 0) pthread_cond_signal(&ts->cond);
+		pthread_mutex_unlock(&ts->mutex);
+
+		int park = 0;
+		int next = ts->fn(ts->arg, task, worker, now, &park);
+
+		pthread_mutex_lock(&ts->mutex);
+		ts->n_steps++;
+		if (next == TSCHED_DONE) {
+			/* The last task lets every worker go */
+			if (--ts->n_live == 0) {
+				pthread_cond_broadcast(&ts->cond);
+			}
+			continue;
+		}
+
+		if (park && !ts->woken_all && ts->pending == 0) {
+			ts->park_pos[task] = ts->n_parked;
+			ts->parked[ts->n_parked++] = task;
+		} else if (park) {
+			/* Somebody woke the task while it was stepped */
+			if (!ts->woken_all) ts->pending--;
+			next = now;
+		}
+		tsched_set_due(ts, task, next);
+	}
+	pthread_mutex_unlock(&ts->mutex);
+}
+
+/*
+ * The thread of a worker other than the calling thread.
+ */
+struct tsched_worker
+{
+	struct tsched *ts;
+	int id;
+	pthread_t thd;
+};
+
+static void *tsched_worker_main(void *ptr)
+{
+	struct tsched_worker *w = ptr;
+	tsched_work(w->ts, w->id);
+	return NULL;
+}
+
+/**
+ * Initializes a scheduler of n_tasks tasks, numbered from 0. No task is due
+ * until it is given a second with tsched_at().
+ *
+ * Params: ts         - the scheduler to initialize
+ *         n_tasks    - the number of tasks
+ *         origin_sec - the simulated second at which tsched_run() starts
+ *         fn         - the function which steps a task
+ *         arg        - passed through to fn
+ * Return: 0 on success, -1 on failure
+ */
+int tsched_init(struct tsched *ts, int n_tasks, int origin_sec,
+		tsched_step_fn fn, void *arg)
+{
+	ts->fn = fn;
+	ts->arg = arg;
+	ts->n_tasks = n_tasks;
+	ts->n_live = n_tasks;
+	ts->origin_sec = origin_sec;
+	ts->n_parked = 0;
+	ts->pending = 0;
+	ts->woken_all = 0;
+	ts->n_steps = 0;
+	ts->n_wakes = 0;
+
+	/* One allocation holds the parked tasks and their positions */
+	ts->parked = malloc(2 * n_tasks * sizeof(int));
+	if (ts->parked == NULL) return -1;
+	ts->park_pos = ts->parked + n_tasks;
+	if (twheel_init(&ts->wheel, n_tasks, origin_sec) == -1) {
+		free(ts->parked);
+		return -1;
+	}
+
+	int task;
+	for (task = 0; task < n_tasks; task++) ts->park_pos[task] = -1;
+
+	pthread_mutex_init(&ts->mutex, NULL);
+	pthread_cond_init(&ts->cond, NULL);
+	return 0;
+}
+
+/**
+ * Destroys a scheduler.
+ *
+ * Params: ts - the scheduler to destroy
+ * Return: void
+ */
+void tsched_destroy(struct tsched *ts)
+{
+	pthread_cond_destroy(&ts->cond);
+	pthread_mutex_destroy(&ts->mutex);
+	twheel_destroy(&ts->wheel);
+	free(ts->parked);
+}
+
+/**
+ * Makes a task due at a second. Tasks are given their first second this way,
+ * before tsched_run().
+ *
+ * Params: ts   - the scheduler
+ *         task - the task
+ *         sec  - the simulated second at which to step the task
+ * Return: void
+ */
+void tsched_at(struct tsched *ts, int task, int sec)
+{
+	pthread_mutex_lock(&ts->mutex);
+	tsched_set_due(ts, task, sec);
+	pthread_mutex_unlock(&ts->mutex);
+}
+
+/**
+ * Steps the tasks on n_workers threads (the calling thread being one of
+ * them) as they fall due, and returns once every task is done. The
+ * simulated clock starts at origin_sec when this function is called.
+ *
+ * Params: ts        - the scheduler
+ *         n_workers - the number of worker threads
+ * Return: 0 on success, -1 if a worker could not be started
+ */
+int tsched_run(struct tsched *ts, int n_workers)
+{
+	if (n_workers < 1) n_workers = 1;
+
+	struct tsched_worker *w = malloc(n_workers * sizeof(*w));
+	if (w == NULL) return -1;
+
+	clock_gettime(CLOCK_REALTIME, &ts->origin);
+
+	/* The calling thread acts as worker 0 */
+	int i, rc = 0;
+	for (i = 1; i < n_workers; i++) {
+		w[i].ts = ts;
+		w[i].id = i;
+		if (pthread_create(&w[i].thd, NULL, tsched_worker_main,
+				&w[i])) {
+			rc = -1;
+			break;
+		}
+	}
+	int n_started = i;
+
+	tsched_work(ts, 0);
+	for (i = 1; i < n_started; i++) {
+		pthread_join(w[i].thd, NULL);
+	}
+
+	free(w);
+	return rc;
+}
+
+/**
+ * Wakes the most recently parked task, to be stepped at second sec. If no
+ * task is parked, the next task to park is stepped again right away.
+ *
+ * Params: ts  - the scheduler
+ *         sec - the simulated second of the wake
+ * Return: void
+ */
+void tsched_wake_one(struct tsched *ts, int sec)
+{
+	pthread_mutex_lock(&ts->mutex);
+	if (ts->n_parked > 0) {
+		int task = ts->parked[ts->n_parked - 1];
+		tsched_unpark(ts, task);
+		tsched_set_due(ts, task, sec);
+		ts->n_wakes++;
+	} else if (ts->pending < ts->n_tasks) {
+		ts->pending++;
+	}
+	pthread_mutex_unlock(&ts->mutex);
+}
+
+/**
+ * Wakes every parked task, to be stepped at second sec. From now on, tasks
+ * never park: they are stepped again right away instead.
+ *
+ * Params: ts  - the scheduler
+ *         sec - the simulated second of the wake
+ * Return: void
+ */
+void tsched_wake_all(struct tsched *ts, int sec)
+{
+	pthread_mutex_lock(&ts->mutex);
+	ts->woken_all = 1;
+	while (ts->n_parked > 0) {
+		int task = ts->parked[ts->n_parked - 1];
+		tsched_unpark(ts, task);
+		tsched_set_due(ts, task, sec);
+		ts->n_wakes++;
+	}
+	pthread_cond_broadcast(&ts->cond);
+	pthread_mutex_unlock(&ts->mutex);
+}
@@ -0,0 +1,78 @@
+#ifndef TSCHED_H_
+#define TSCHED_H_
+
+/*
+ * Proj: 4
+ * File: tsched.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the task scheduler of the
+ * pooled simulation. A task is a state machine (e.g. a teller) which the
+ * scheduler steps whenever it falls due: at the simulated second it asked
+ * for, or as soon as another task wakes it. The simulated clock runs against
+ * the wall clock as in the threaded simulation (see sim.h), but a fixed
+ * number of worker threads steps every task: a task costs a few words of
+ * state, instead of a thread and its stack.
+ *
+ * A step never blocks. A task which has to wait for something (e.g. for a
+ * customer) parks until a deadline instead, and the task which ends the wait
+ * wakes it with tsched_wake_one() or tsched_wake_all(). A task is never
+ * stepped by two workers at once, and all its steps are ordered by the
+ * scheduler's mutex, so its state needs no locking of its own.
+ */
+
+#include <pthread.h>
+#include <time.h>
+#include "twheel.h"
+
+#define TSCHED_DONE -1 /* Returned by a step: the task is done */
+
+/*
+ * Steps a task. It is passed the argument given to tsched_init(), the
+ * task's number, the number of the worker stepping it, and the simulated
+ * second it is stepped at. Returns the second at which the task wants to be
+ * stepped next, or TSCHED_DONE. If the task sets park, it is stepped at that
+ * second only if nobody wakes it before.
+ */
+typedef int (*tsched_step_fn)(void *arg, int task, int worker, int now,
+		int *park);
+
+struct tsched
+{
+	pthread_mutex_t mutex; /* Guards everything below */
+	pthread_cond_t cond; /* Where workers wait for the next due task */
+
+	tsched_step_fn fn; /* Steps the tasks */
+	void *arg; /* Passed to every step */
+	int n_tasks; /* The number of tasks */
+	int n_live; /* Tasks not done yet */
+
+	struct timespec origin; /* The wall clock time of second origin_sec */
+	int origin_sec; /* The simulated second the scheduler started at */
+
+	struct twheel wheel; /* Timed tasks, a timer per task */
+
+	/* Parked tasks (they are in the wheel as well, with their deadline) */
+	int *parked; /* The parked tasks, most recently parked last */
+	int n_parked; /* Tasks parked */
+	int *park_pos; /* Where a task sits in parked, or -1 */
+	int pending; /* Wakes which found no parked task */
+	int woken_all; /* Set once tsched_wake_all() was called */
+
+	long n_steps; /* Steps taken */
+	long n_wakes; /* Parked tasks woken before their deadline */
+};
+
+int tsched_init(struct tsched *ts, int n_tasks, int origin_sec,
+		tsched_step_fn fn, void *arg);
+void tsched_destroy(struct tsched *ts);
+
+void tsched_at(struct tsched *ts, int task, int sec);
+int tsched_run(struct tsched *ts, int n_workers);
+
+void tsched_wake_one(struct tsched *ts, int sec);
+void tsched_wake_all(struct tsched *ts, int sec);
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ * Proj: 4
+ * File: twheel.c
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * Implements the public interface contained in twheel.h.
+ *
+ * A timer set for a second before the wheel's now (it is late) hangs in the
+ * slot of now, which is searched first. The wheel's now only ever moves up
+ * to the earliest due timer, so a late timer is found before any other.
+ */
+
+#include <stdlib.h>
+#include "twheel.h"
+
+#define TWHEEL_MASK (TWHEEL_SLOTS - 1)
+
+/*
+ * Finds the first slot with a timer, at least dist slots after slot from
+ * and less than a turn after it. Returns its distance from slot from, or -1
+ * if every slot in between is empty.
+ */
+static int twheel_next_used(const struct twheel *w, int from, int dist)
+{
+	while (dist < TWHEEL_SLOTS) {
+		int s = (from + dist) & TWHEEL_MASK;
+		uint64_t bits = w->used[s / 64] >> (s % 64);
+		if (bits != 0) {
+			dist += __builtin_ctzll(bits);
+			return dist < TWHEEL_SLOTS ? dist : -1;
+		}
+		dist += 64 - s % 64;
+	}
+	return -1;
+}
+
+/**
+ * Initializes a wheel of n_timers timers, none of them set.
+ *
+ * Params: w        - the wheel to initialize
+ *         n_timers - the number of timers
+ *         now      - the earliest second a timer will be due
+ * Return: 0 on success, -1 on failure
+ */
+int twheel_init(struct twheel *w, int n_timers, int now)
+{
+	w->now = now;
+	w->n = 0;
+
+	/* One allocation holds every array */
+	w->due = malloc(4 * n_timers * sizeof(int));
+	if (w->due == NULL) return -1;
+	w->next = w->due + n_timers;
+	w->prev = w->next + n_timers;
+	w->slot = w->prev + n_timers;
+
+	int i;
+	for (i = 0; i < n_timers; i++) w->prev[i] = -2;
+	for (i = 0; i < TWHEEL_SLOTS; i++) w->head[i] = -1;
+	for (i = 0; i < TWHEEL_WORDS; i++) w->used[i] = 0;
+	return 0;
+}
+
+/**
+ * Destroys a wheel.
+ *
+ * Params: w - the wheel to destroy
+ * Return: void
+ */
+void twheel_destroy(struct twheel *w)
+{
+	free(w->due);
+}
+
+/**
+ * Sets a timer to fall due at a second, or moves it there if it is set.
+ *
+ * Params: w     - the wheel
+ *         timer - the timer
+ *         sec   - the second it falls due
+ * Return: void
+ */
+void twheel_set(struct twheel *w, int timer, int sec)
+{
+	if (twheel_is_set(w, timer)) twheel_cancel(w, timer);
+
+	int s = (sec < w->now ? w->now : sec) & TWHEEL_MASK;
+	w->due[timer] = sec;
+	w->slot[timer] = s;
+	w->prev[timer] = -1;
+	w->next[timer] = w->head[s];
+	if (w->head[s] != -1) w->prev[w->head[s]] = timer;
+	w->head[s] = timer;
+	w->used[s / 64] |= (uint64_t) 1 << (s % 64);
+	w->n++;
+}
+
+/**
+ * Cancels a timer which is set.
+ *
+ * Params: w     - the wheel
+ *         timer - the timer
+ * Return: void
+ */
+void twheel_cancel(struct twheel *w, int timer)
+{
+	int s = w->slot[timer];
+	int prev = w->prev[timer];
+	int next = w->next[timer];
+
+	if (prev == -1) {
+		w->head[s] = next;
+	} else {
+		w->next[prev] = next;
+	}
+	if (next != -1) w->prev[next] = prev;
+
+	if (w->head[s] == -1) w->used[s / 64] &= ~((uint64_t) 1 << (s % 64));
+	w->prev[timer] = -2;
+	w->n--;
+}
+
+/**
+ * Determines whether a timer is set.
+ *
+ * Params: w     - the wheel
+ *         timer - the timer
+ * Return: 1 if it is set, 0 if not
+ */
+int twheel_is_set(const struct twheel *w, int timer)
+{
+	return w->prev[timer] != -2;
+}
+
+/**
+ * Finds the timer which falls due first, of the timers set. It stays set.
+ * Timers due at the same second are found in no particular order.
+ *
+ * Params: w - the wheel
+ * Return: the timer, or -1 if no timer is set
+ */
+int twheel_first(struct twheel *w)
+{
+	if (w->n == 0) return -1;
+
+	int from = w->now & TWHEEL_MASK;
+	int dist = 0;
+	int t, best = -1;
+	while ((dist = twheel_next_used(w, from, dist)) != -1) {
+		/* Timers of this slot due in this turn, or late */
+		for (t = w->head[(from + dist) & TWHEEL_MASK]; t != -1;
+				t = w->next[t]) {
+			if (w->due[t] - w->now > dist) continue;
+			if (best == -1 || w->due[t] < w->due[best]) best = t;
+		}
+		if (best != -1) {
+			w->now += dist;
+			return best;
+		}
+		dist++;
+	}
+
+	/* Every timer is a turn or more away */
+	int s;
+	for (s = 0; s < TWHEEL_SLOTS; s++) {
+		for (t = w->head[s]; t != -1; t = w->next[t]) {
+			if (best == -1 || w->due[t] < w->due[best]) best = t;
+		}
+	}
+	w->now = w->due[best];
+	return best;
+}
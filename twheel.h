@@ -0,0 +1,49 @@
+#ifndef TWHEEL_H_
+#define TWHEEL_H_
+
+/*
+ * Proj: 4
+ * File: twheel.h
+ * Date: 16 October 2026
+ *
+ * Description:
+ *
+ * This file contains the public interface to the timer wheel. A wheel holds
+ * timers, numbered from 0, each due at a simulated second. The wheel has a
+ * slot per second of TWHEEL_SLOTS seconds; a timer hangs in the slot of its
+ * second, and a timer due a whole turn of the wheel or more later is simply
+ * passed over until its turn comes. Setting, moving and cancelling a timer
+ * takes a few stores, whatever the number of timers, and a bitmap of the
+ * occupied slots finds the earliest due timer in a few word compares.
+ *
+ * A roster makes many tellers due at once (at the start of a shift, or at
+ * the bank plug), and moves their timers about whenever a customer wakes
+ * one: the wheel costs the same, however many timers it holds.
+ */
+
+#include <stdint.h>
+
+#define TWHEEL_SLOTS 4096 /* Seconds of a turn, a power of two */
+#define TWHEEL_WORDS (TWHEEL_SLOTS / 64) /* Words of the slot bitmap */
+
+struct twheel
+{
+	int now; /* No timer is due before this second, but the late ones */
+	int n; /* Timers set */
+	int *due; /* The second a timer is due */
+	int *next; /* The next timer of its slot, or -1 */
+	int *prev; /* The previous timer of its slot, -1, or -2 if not set */
+	int *slot; /* The slot a timer hangs in */
+	int head[TWHEEL_SLOTS]; /* The first timer of each slot, or -1 */
+	uint64_t used[TWHEEL_WORDS]; /* A bit per slot with a timer */
+};
+
+int twheel_init(struct twheel *w, int n_timers, int now);
+void twheel_destroy(struct twheel *w);
+
+void twheel_set(struct twheel *w, int timer, int sec);
+void twheel_cancel(struct twheel *w, int timer);
+int twheel_is_set(const struct twheel *w, int timer);
+int twheel_first(struct twheel *w);
+
+#endif